@@ -0,0 +1,209 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include "TargetSystem.h"
+#include "TimerDriver.h"
+#include "benchAvr.h"
+
+/**
+ * \file benchAvr.c
+ *
+ * AVR firmware for the hot path benchmark
+ *
+ * Calls each of the driver's hot paths in turn on the trinket system, marking
+ * the start and end of each run for the simulator runner to time. Interrupts
+ * stay disabled throughout so that only the path itself is counted.
+ *
+ * Compare match dispatch is timed as the event to timer resolution alone: a
+ * table lookup by event, as the driver's callback does, against the linear
+ * scan the driver used to do. The event is read through a volatile on each
+ * call so that neither can be taken out of the loop.
+ *
+ * The ATtiny85 has a single timer, so the timers the old compare match
+ * dispatch scanned are emulated: it walks BENCH_AVR_NUM_TIMERS timer IDs,
+ * with the real timer last. The HAL resolves the others to
+ * SYSTEM_EVENT_INVALID, as it would for any timer it does not have.
+ */
+
+#ifndef BENCH_AVR_NUM_TIMERS
+/**
+ * Number of timers the linear scan dispatch walks
+ */
+#define BENCH_AVR_NUM_TIMERS 1
+#endif
+
+/**
+ * Cycle times the setter benchmark steps through, in milliseconds
+ */
+static const unsigned long int benchCycleTimes [] = { 1, 10, 100, 500, 1000, 5000 };
+
+#define BENCH_NUM_CYCLE_TIMES (sizeof(benchCycleTimes) / sizeof(benchCycleTimes[0]))
+
+/**
+ * IDs of the timers the linear scan dispatch walks, kept in RAM as the
+ * driver's timer instances kept them
+ */
+static System_TimerID benchTimerIDs [BENCH_AVR_NUM_TIMERS];
+
+/**
+ * Index into benchTimerIDs of the timer raising each event, indexed by event,
+ * as the driver keeps its timer instances
+ */
+static unsigned char benchEventTimers [SYSTEM_NUM_EVENTS];
+
+static volatile System_EventType benchEvent = SYSTEM_EVENT_INVALID;
+static volatile unsigned char benchSink = 0;
+
+/**
+ * Calls the given hot path on the given timer BENCH_AVR_NUM_ITERATIONS times
+ */
+static void RunPath(BenchAvrPath path, TimerInstance* timer);
+
+/**
+ * Resolves an event to the index of its timer the way the driver's callback
+ * does
+ */
+static unsigned char LookupDispatch(System_EventType event);
+
+/**
+ * Resolves an event to the index of its timer the way the driver used to
+ */
+static unsigned char LinearScanDispatch(System_EventType event);
+
+int main()
+{
+  InitTimers();
+
+  TimerInstance* timer = CreateTimer();
+  SetTimerCycleTimeMilliSec(timer, 500);
+
+  unsigned char timerIdx;
+  for(
+      timerIdx = 0;
+      timerIdx < BENCH_AVR_NUM_TIMERS;
+      timerIdx++
+     )
+  {
+    benchTimerIDs[timerIdx] = (System_TimerID)(GetTimerSystemID(timer) + (BENCH_AVR_NUM_TIMERS - 1) - timerIdx);
+
+    System_EventType event = System_GetTimerCallbackEvent(benchTimerIDs[timerIdx]);
+    if (event < SYSTEM_NUM_EVENTS)
+    {
+      benchEventTimers[event] = timerIdx;
+    }
+  }
+
+  BenchAvrPath path;
+  for(
+      path = BENCH_AVR_PATH_EMPTY;
+      path < BENCH_AVR_NUM_PATHS;
+      path++
+     )
+  {
+    // Compare matches are only taken while the timer runs
+    if (path == BENCH_AVR_PATH_COMPARE_MATCH)
+    {
+      StartTimer(timer);
+    }
+
+    RunPath(path, timer);
+
+    StopTimer(timer);
+  }
+
+  // Sleeping with interrupts disabled ends the simulation
+  cli();
+  sleep_cpu();
+
+  return 0;
+}
+
+void
+RunPath(
+    BenchAvrPath    path,
+    TimerInstance*  timer
+    )
+{
+  System_EventType event = System_GetTimerCallbackEvent(GetTimerSystemID(timer));
+  System_EventCallback callback = System_GetEventCallback(event);
+  unsigned char iter;
+
+  benchEvent = event;
+
+  GPIOR0 = path;
+
+  for(
+      iter = 0;
+      iter < BENCH_AVR_NUM_ITERATIONS;
+      iter++
+     )
+  {
+    switch (path)
+    {
+      case BENCH_AVR_PATH_COMPARE_MATCH:
+        (*callback)(event);
+        break;
+
+      case BENCH_AVR_PATH_START_STOP:
+        StartTimer(timer);
+        StopTimer(timer);
+        break;
+
+      case BENCH_AVR_PATH_SET_CYCLE_TIME:
+        SetTimerCycleTimeMilliSec(timer, benchCycleTimes[iter % BENCH_NUM_CYCLE_TIMES]);
+        break;
+
+      case BENCH_AVR_PATH_DISPATCH_LOOKUP:
+        benchSink = LookupDispatch(benchEvent);
+        break;
+
+      case BENCH_AVR_PATH_DISPATCH_SCAN:
+        benchSink = LinearScanDispatch(benchEvent);
+        break;
+
+      default:
+        // Keep the empty loop from being optimized away
+        __asm__ __volatile__ ("");
+        break;
+    };
+  }
+
+  GPIOR0 = BENCH_AVR_PATH_NONE;
+}
+
+unsigned char
+LookupDispatch(
+    System_EventType  event
+    )
+{
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return BENCH_AVR_NUM_TIMERS;
+  }
+
+  return benchEventTimers[event];
+}
+
+unsigned char
+LinearScanDispatch(
+    System_EventType  event
+    )
+{
+  unsigned char timerIdx;
+  for(
+      timerIdx = 0;
+      timerIdx < BENCH_AVR_NUM_TIMERS;
+      timerIdx++
+     )
+  {
+    if (System_GetTimerCallbackEvent(benchTimerIDs[timerIdx]) == event)
+    {
+      break;
+    }
+  }
+
+  return timerIdx;
+}
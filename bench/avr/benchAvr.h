@@ -0,0 +1,47 @@
+#ifndef BENCH_AVR
+#define BENCH_AVR
+
+/**
+ * \file benchAvr.h
+ *
+ * Protocol shared by the AVR benchmark firmware and its simulator runner
+ *
+ * The firmware writes the identifier of a hot path to the marker register just
+ * before calling it BENCH_AVR_NUM_ITERATIONS times, and writes
+ * BENCH_AVR_PATH_NONE just after. The runner counts the core cycles between
+ * the two writes.
+ *
+ * The firmware is also built once for each of several timer counts, to time
+ * the linear scan the driver used to resolve compare match events with next
+ * to the lookup by event the driver's callback does now.
+ */
+
+/**
+ * Number of times each hot path is called per measurement
+ */
+#define BENCH_AVR_NUM_ITERATIONS 100
+
+/**
+ * Data space address of the marker register (GPIOR0 on the ATtiny85)
+ */
+#define BENCH_AVR_MARKER_ADDRESS 0x31
+
+/**
+ * Enumeration of measured hot paths
+ *
+ * \note The empty path measures the loop alone, and is subtracted from the
+ * others
+ */
+typedef enum BenchAvrPath_enum
+{
+  BENCH_AVR_PATH_NONE,
+  BENCH_AVR_PATH_EMPTY,
+  BENCH_AVR_PATH_COMPARE_MATCH,
+  BENCH_AVR_PATH_START_STOP,
+  BENCH_AVR_PATH_SET_CYCLE_TIME,
+  BENCH_AVR_PATH_DISPATCH_LOOKUP,
+  BENCH_AVR_PATH_DISPATCH_SCAN,
+  BENCH_AVR_NUM_PATHS
+} BenchAvrPath;
+
+#endif /* BENCH_AVR */
@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+
+#include "benchAvr.h"
+
+/**
+ * \file benchAvrRunner.c
+ *
+ * Host runner for the AVR hot path benchmark
+ *
+ * Loads the benchmark firmware into simavr and counts the core cycles between
+ * the firmware's start and end markers for each hot path. Results are printed
+ * in the same key=value form as the host benchmarks, less the cost of the
+ * empty loop.
+ *
+ * Given the number of timers a dispatch build of the firmware was made for,
+ * only the lookup and linear scan dispatch are printed, as a single line for
+ * that number of timers.
+ */
+
+/**
+ * Names printed for each hot path
+ */
+static const char* benchPathNames [BENCH_AVR_NUM_PATHS] =
+{
+  "none",
+  "empty",
+  "compare_match",
+  "start_stop",
+  "set_cycle_time_ms",
+  "dispatch_lookup",
+  "dispatch_scan"
+};
+
+/**
+ * Core cycles spent in each hot path's run
+ */
+static avr_cycle_count_t pathCycles [BENCH_AVR_NUM_PATHS] = {0};
+
+/**
+ * Hot path currently running
+ */
+static BenchAvrPath currentPath = BENCH_AVR_PATH_NONE;
+
+/**
+ * Core cycle count when the current run started
+ */
+static avr_cycle_count_t pathStartCycle = 0;
+
+/**
+ * Records the core cycle count each time the firmware writes the marker
+ */
+static void
+MarkerWritten(
+    struct avr_t*   avr,
+    avr_io_addr_t   address,
+    uint8_t         value,
+    void*           param
+    )
+{
+  avr->data[address] = value;
+
+  if (currentPath != BENCH_AVR_PATH_NONE)
+  {
+    pathCycles[currentPath] += avr->cycle - pathStartCycle;
+  }
+
+  currentPath = (value < BENCH_AVR_NUM_PATHS) ? (BenchAvrPath)value : BENCH_AVR_PATH_NONE;
+  pathStartCycle = avr->cycle;
+}
+
+int main(
+    int   argc,
+    char* argv[]
+    )
+{
+  if (
+      (argc != 3) &&
+      (argc != 4)
+     )
+  {
+    fprintf(stderr, "usage: %s <mcu> <firmware.elf> [num_timers]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  elf_firmware_t firmware = {{0}};
+  if (elf_read_firmware(argv[2], &firmware) != 0)
+  {
+    fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[2]);
+    return EXIT_FAILURE;
+  }
+
+  avr_t* avr = avr_make_mcu_by_name(argv[1]);
+  if (avr == NULL)
+  {
+    fprintf(stderr, "%s: unknown mcu %s\n", argv[0], argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  avr_init(avr);
+  avr_load_firmware(avr, &firmware);
+  avr_register_io_write(avr, BENCH_AVR_MARKER_ADDRESS, MarkerWritten, NULL);
+
+  int state = cpu_Running;
+  while (
+      (state != cpu_Done) &&
+      (state != cpu_Crashed)
+      )
+  {
+    state = avr_run(avr);
+  }
+
+  if (state == cpu_Crashed)
+  {
+    fprintf(stderr, "%s: firmware crashed\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  double emptyCycles = (double)pathCycles[BENCH_AVR_PATH_EMPTY] / BENCH_AVR_NUM_ITERATIONS;
+
+  if (argc == 4)
+  {
+    printf(
+        "dispatch target=%s timers=%s iterations=%u lookup_cycles=%.2f linear_scan_cycles=%.2f\n",
+        argv[1],
+        argv[3],
+        BENCH_AVR_NUM_ITERATIONS,
+        ((double)pathCycles[BENCH_AVR_PATH_DISPATCH_LOOKUP] / BENCH_AVR_NUM_ITERATIONS) - emptyCycles,
+        ((double)pathCycles[BENCH_AVR_PATH_DISPATCH_SCAN] / BENCH_AVR_NUM_ITERATIONS) - emptyCycles
+        );
+
+    return EXIT_SUCCESS;
+  }
+
+  BenchAvrPath path;
+  for(
+      path = BENCH_AVR_PATH_COMPARE_MATCH;
+      path < BENCH_AVR_PATH_DISPATCH_LOOKUP;
+      path++
+     )
+  {
+    printf(
+        "hotpath target=%s path=%s iterations=%u cycles_per_call=%.2f\n",
+        argv[1],
+        benchPathNames[path],
+        BENCH_AVR_NUM_ITERATIONS,
+        ((double)pathCycles[path] / BENCH_AVR_NUM_ITERATIONS) - emptyCycles
+        );
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "TimerDriver.h"
+#include "TargetSystem.h"
+
+/**
+ * \file benchDispatch.c
+ *
+ * Host benchmark for compare match event dispatch
+ *
+ * Measures the cost of resolving a compare match event to its timer for each
+ * timer in the mock system, both through a table indexed by event as the
+ * driver's callback does and through a linear scan over
+ * System_GetTimerCallbackEvent() as the driver used to do. The linear scan
+ * grows with the timer's position, the lookup does not. The whole callback,
+ * lookup and cycle handling together, is timed alongside for scale.
+ *
+ * The event is read back through a volatile on each call, so that neither
+ * resolution can be taken out of the loop.
+ */
+
+#define BENCH_NUM_ITERATIONS 10000000UL
+
+static TimerInstance* benchTimers [SYSTEM_NUM_TIMERS];
+
+/**
+ * Timer raising each event, indexed by event, filled in as the driver fills
+ * its own
+ */
+static TimerInstance* benchEventTimers [SYSTEM_NUM_EVENTS];
+
+static volatile System_EventType benchEvent = SYSTEM_EVENT_INVALID;
+static TimerInstance* volatile benchSink = NULL;
+
+/**
+ * Resolves an event to its timer the way the driver's callback does
+ */
+static TimerInstance*
+LookupDispatch(
+    System_EventType  event
+    )
+{
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return NULL;
+  }
+
+  return benchEventTimers[event];
+}
+
+/**
+ * Resolves an event to its timer the way the driver used to
+ */
+static TimerInstance*
+LinearScanDispatch(
+    System_EventType  event
+    )
+{
+  unsigned int timerIdx;
+  for(
+      timerIdx = 0;
+      timerIdx < SYSTEM_NUM_TIMERS;
+      timerIdx++
+     )
+  {
+    if (System_GetTimerCallbackEvent(timerIdx) == event)
+    {
+      return benchTimers[timerIdx];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * Provides the current monotonic time in nanoseconds
+ */
+static double
+GetTimeNanoSec()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return ((double)now.tv_sec * 1e9) + (double)now.tv_nsec;
+}
+
+int main()
+{
+  InitTimers();
+
+  System_TimerID timerIdx;
+  for(
+      timerIdx = 0;
+      timerIdx < SYSTEM_NUM_TIMERS;
+      timerIdx++
+     )
+  {
+    System_SetMaxTimerValue(timerIdx, 256);
+    benchTimers[timerIdx] = CreateTimer();
+    SetTimerCycleTimeMilliSec(benchTimers[timerIdx], 500);
+    StartTimer(benchTimers[timerIdx]);
+
+    System_EventType event = System_GetTimerCallbackEvent(timerIdx);
+    if (event < SYSTEM_NUM_EVENTS)
+    {
+      benchEventTimers[event] = benchTimers[timerIdx];
+    }
+  }
+
+  for(
+      timerIdx = 0;
+      timerIdx < SYSTEM_NUM_TIMERS;
+      timerIdx++
+     )
+  {
+    System_EventType event = System_GetTimerCallbackEvent(timerIdx);
+    System_EventCallback callback = System_GetEventCallback(event);
+    unsigned long int iter;
+
+    benchEvent = event;
+
+    double startTime = GetTimeNanoSec();
+    for(
+        iter = 0;
+        iter < BENCH_NUM_ITERATIONS;
+        iter++
+       )
+    {
+      benchSink = LookupDispatch(benchEvent);
+    }
+    double lookupTime = (GetTimeNanoSec() - startTime) / BENCH_NUM_ITERATIONS;
+
+    startTime = GetTimeNanoSec();
+    for(
+        iter = 0;
+        iter < BENCH_NUM_ITERATIONS;
+        iter++
+       )
+    {
+      benchSink = LinearScanDispatch(benchEvent);
+    }
+    double scanTime = (GetTimeNanoSec() - startTime) / BENCH_NUM_ITERATIONS;
+
+    startTime = GetTimeNanoSec();
+    for(
+        iter = 0;
+        iter < BENCH_NUM_ITERATIONS;
+        iter++
+       )
+    {
+      (*callback)(benchEvent);
+    }
+    double callbackTime = (GetTimeNanoSec() - startTime) / BENCH_NUM_ITERATIONS;
+
+    // Both must find the same timer for the comparison to mean anything
+    if (LookupDispatch(event) != LinearScanDispatch(event))
+    {
+      fprintf(stderr, "dispatch timer=%u lookup and linear scan disagree\n", timerIdx);
+      return EXIT_FAILURE;
+    }
+
+    printf(
+        "dispatch timer=%u lookup_ns=%.2f linear_scan_ns=%.2f callback_ns=%.2f\n",
+        timerIdx,
+        lookupTime,
+        scanTime,
+        callbackTime
+        );
+  }
+
+  DestroyAllTimers();
+
+  return 0;
+}
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "TimerEvents.h"
+#include "TargetSystem.h"
+
+/**
+ * \file benchEvents.c
+ *
+ * Host benchmark for the main loop event pump
+ *
+ * Measures the cost of one idle pass of the main loop, with nothing pending,
+ * for ProcessTimerEvents() and for the flag array scan the samples used to
+ * do. The scan is measured over the mock's events and over the sixteen events
+ * a larger port could have, since it grows with the number of events while
+ * ProcessTimerEvents() does not. Times are in nanoseconds, and also in time
+ * stamp counter cycles on x86 hosts.
+ */
+
+#define BENCH_NUM_ITERATIONS 10000000UL
+
+#define BENCH_NUM_LARGE_PORT_EVENTS 16
+
+static volatile uint8_t benchEvents [BENCH_NUM_LARGE_PORT_EVENTS] = {FALSE};
+
+/**
+ * One pass of the main loop the samples used to run
+ */
+static void
+ScanEventFlags(
+    unsigned int  numEvents
+    )
+{
+  unsigned int eventIter;
+  for(
+      eventIter = 0;
+      eventIter < numEvents;
+      ++eventIter
+     )
+  {
+    if (benchEvents[eventIter] == FALSE)
+    {
+      continue;
+    }
+
+    System_EventCallback currentEventCallback = System_GetEventCallback(eventIter);
+
+    if (currentEventCallback != NULL)
+    {
+      (*currentEventCallback)(eventIter);
+    }
+
+    benchEvents[eventIter] = FALSE;
+  }
+}
+
+/**
+ * Provides the current monotonic time in nanoseconds
+ */
+static double
+GetTimeNanoSec()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return ((double)now.tv_sec * 1e9) + (double)now.tv_nsec;
+}
+
+/**
+ * Provides the current time stamp counter, or zero if there is none
+ */
+static unsigned long long int
+GetCycleCount()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Reports the cost of one idle pass of the main loop
+ */
+static void
+MeasureIdlePass(
+    const char*   name,     /**< Name to report the loop under */
+    unsigned int  numEvents /**< Number of event flags to scan, or zero to use ProcessTimerEvents() */
+    )
+{
+  unsigned long int iter;
+
+  double startTime = GetTimeNanoSec();
+  unsigned long long int startCycles = GetCycleCount();
+  for(
+      iter = 0;
+      iter < BENCH_NUM_ITERATIONS;
+      iter++
+     )
+  {
+    if (numEvents == 0)
+    {
+      ProcessTimerEvents();
+    }
+    else
+    {
+      ScanEventFlags(numEvents);
+    }
+  }
+  double passCycles = (double)(GetCycleCount() - startCycles) / BENCH_NUM_ITERATIONS;
+  double passTime = (GetTimeNanoSec() - startTime) / BENCH_NUM_ITERATIONS;
+
+  printf("events loop=%s num_events=%u idle_pass_ns=%.2f idle_pass_cycles=%.2f\n", name, (numEvents == 0) ? SYSTEM_NUM_EVENTS : numEvents, passTime, passCycles);
+}
+
+int main()
+{
+  InitTimerEvents();
+
+  MeasureIdlePass("process_timer_events", 0);
+  MeasureIdlePass("flag_scan", SYSTEM_NUM_EVENTS);
+  MeasureIdlePass("flag_scan", BENCH_NUM_LARGE_PORT_EVENTS);
+
+  return 0;
+}
@@ -0,0 +1,442 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "TargetSystem.h"
+
+/**
+ * \file benchHal.c
+ *
+ * Host benchmark for table-driven HAL register access
+ *
+ * Measures the per-call cost of setting a timer's clock source and compare
+ * output mode three ways, against Timer_A-like registers emulated in memory:
+ * through a switch on the timer and setting as the launchpad HAL used to,
+ * through the constant descriptor and lookup tables it uses now, and through
+ * each timer's System_TimerOps as the driver calls them when built with
+ * TIMER_HAL_OPS. All three make the same register accesses as the HAL. Timer, clock
+ * source and mode change on every call so that none of them can be folded
+ * away. Results are printed as space separated key=value
+ * pairs.
+ */
+
+#define BENCH_NUM_ITERATIONS 10000000UL
+
+#define BENCH_NUM_TIMERS 2
+#define BENCH_NUM_CLKSOURCES 5
+#define BENCH_NUM_OUTPUTS 2
+#define BENCH_NUM_OUTPUT_MODES 4
+
+/**
+ * Timer_A control register bits
+ */
+#define BENCH_TASSEL1 0x0200
+#define BENCH_TASSEL0 0x0100
+#define BENCH_ID1     0x0080
+#define BENCH_ID0     0x0040
+#define BENCH_MC1     0x0020
+#define BENCH_MC0     0x0010
+#define BENCH_TACLR   0x0004
+
+/**
+ * Timer_A capture/compare control register bits
+ */
+#define BENCH_OUTMOD2 0x0080
+#define BENCH_OUTMOD1 0x0040
+#define BENCH_OUTMOD0 0x0020
+#define BENCH_OUT     0x0004
+
+/**
+ * Emulated registers of each timer
+ */
+static volatile unsigned int benchTACTL [BENCH_NUM_TIMERS];
+static volatile unsigned int benchTACCTL0 [BENCH_NUM_TIMERS];
+static volatile unsigned int benchTACCTL2 [BENCH_NUM_TIMERS];
+
+/**
+ * Enumeration of measured variants
+ */
+typedef enum BenchVariant_enum
+{
+  BENCH_VARIANT_SWITCH,
+  BENCH_VARIANT_TABLE,
+  BENCH_VARIANT_OPS,
+  BENCH_NUM_VARIANTS
+} BenchVariant;
+
+static const char* benchVariantNames [BENCH_NUM_VARIANTS] =
+{
+  [BENCH_VARIANT_SWITCH]  = "switch",
+  [BENCH_VARIANT_TABLE]   = "table",
+  [BENCH_VARIANT_OPS]     = "ops"
+};
+
+/**
+ * Enumeration of measured operations
+ */
+typedef enum BenchOp_enum
+{
+  BENCH_OP_SET_CLOCK_SOURCE,
+  BENCH_OP_SET_OUTPUT_MODE,
+  BENCH_NUM_OPS
+} BenchOp;
+
+static const char* benchOpNames [BENCH_NUM_OPS] =
+{
+  [BENCH_OP_SET_CLOCK_SOURCE] = "set_clock_source",
+  [BENCH_OP_SET_OUTPUT_MODE]  = "set_output_mode"
+};
+
+/**
+ * Registers of a timer, as in the launchpad's System_TimerDescriptor
+ */
+typedef struct BenchTimerDescriptor_struct
+{
+  volatile unsigned int* TAxCTL;          /**< Control register */
+  volatile unsigned int* TAxCCTL [3];     /**< Capture/compare control registers */
+} BenchTimerDescriptor;
+
+static const BenchTimerDescriptor benchTimers [BENCH_NUM_TIMERS] =
+{
+  { &benchTACTL[0], { &benchTACCTL0[0], NULL, &benchTACCTL2[0] } },
+  { &benchTACTL[1], { &benchTACCTL0[1], NULL, &benchTACCTL2[1] } }
+};
+
+static const unsigned int benchClockSourceDividers [BENCH_NUM_CLKSOURCES] =
+{
+  0, (BENCH_ID0), (BENCH_ID1), (BENCH_ID1) | (BENCH_ID0), 0
+};
+
+static const unsigned int benchOutputModes [BENCH_NUM_OUTPUT_MODES] =
+{
+  0, (BENCH_OUTMOD0), (BENCH_OUTMOD2) | (BENCH_OUTMOD0), (BENCH_OUTMOD2)
+};
+
+static const unsigned char benchOutputBlocks [BENCH_NUM_OUTPUTS] = { 0, 2 };
+
+static volatile unsigned int benchSink = 0;
+
+/**
+ * Sets the clock source by switching on the timer and clock source
+ */
+static inline unsigned int
+SwitchSetClockSource(
+    unsigned int  timer,
+    unsigned int  clockSource
+    )
+{
+  unsigned int TACTL_copy = 0;
+
+  switch (clockSource)
+  {
+    case 0:
+      break;
+
+    case 1:
+      TACTL_copy |= (BENCH_ID0);
+      break;
+
+    case 2:
+      TACTL_copy |= (BENCH_ID1);
+      break;
+
+    case 3:
+      TACTL_copy |= (BENCH_ID1) | (BENCH_ID0);
+      break;
+
+    case 4:
+      break;
+
+    default:
+      return FALSE;
+      break;
+  };
+
+  unsigned int TACTL_MC_copy = 0;
+  switch (timer)
+  {
+    case 0:
+      TACTL_MC_copy = benchTACTL[0] & ((BENCH_MC1) | (BENCH_MC0));
+      benchTACTL[0] &= ~((BENCH_MC1) | (BENCH_MC0));
+      benchTACTL[0] &= ~((BENCH_TASSEL1) | (BENCH_TASSEL0));
+      benchTACTL[0] |= (BENCH_TASSEL1);
+      benchTACTL[0] &= ~((BENCH_ID1) | (BENCH_ID0));
+      benchTACTL[0] |= TACTL_copy;
+      benchTACTL[0] |= BENCH_TACLR;
+      benchTACTL[0] |= TACTL_MC_copy;
+      break;
+
+    case 1:
+      TACTL_MC_copy = benchTACTL[1] & ((BENCH_MC1) | (BENCH_MC0));
+      benchTACTL[1] &= ~((BENCH_MC1) | (BENCH_MC0));
+      benchTACTL[1] &= ~((BENCH_TASSEL1) | (BENCH_TASSEL0));
+      benchTACTL[1] |= (BENCH_TASSEL1);
+      benchTACTL[1] &= ~((BENCH_ID1) | (BENCH_ID0));
+      benchTACTL[1] |= TACTL_copy;
+      benchTACTL[1] |= BENCH_TACLR;
+      benchTACTL[1] |= TACTL_MC_copy;
+      break;
+
+    default:
+      return FALSE;
+      break;
+  };
+
+  return TRUE;
+}
+
+/**
+ * Sets the output mode by switching on the mode and timer
+ */
+static inline unsigned int
+SwitchSetOutputMode(
+    unsigned int  timer,
+    unsigned int  output,
+    unsigned int  outputMode
+    )
+{
+  if (output >= BENCH_NUM_OUTPUTS)
+  {
+    return FALSE;
+  }
+
+  unsigned int TACCTL_OUTMOD_copy = 0;
+
+  switch (outputMode)
+  {
+    case 0: TACCTL_OUTMOD_copy = 0; break;
+    case 1: TACCTL_OUTMOD_copy = (BENCH_OUTMOD0); break;
+    case 2: TACCTL_OUTMOD_copy = (BENCH_OUTMOD2) | (BENCH_OUTMOD0); break;
+    case 3: TACCTL_OUTMOD_copy = (BENCH_OUTMOD2); break;
+
+    default:
+      return FALSE;
+      break;
+  };
+
+  volatile unsigned int* TACCTL = NULL;
+
+  switch (timer)
+  {
+    case 0: TACCTL = (output == 1) ? &benchTACCTL2[0] : &benchTACCTL0[0]; break;
+    case 1: TACCTL = (output == 1) ? &benchTACCTL2[1] : &benchTACCTL0[1]; break;
+
+    default:
+      return FALSE;
+      break;
+  };
+
+  *TACCTL = (*TACCTL & ~((BENCH_OUTMOD2) | (BENCH_OUTMOD1) | (BENCH_OUTMOD0) | (BENCH_OUT))) | TACCTL_OUTMOD_copy;
+
+  return TRUE;
+}
+
+/**
+ * Sets the clock source through the timer's descriptor and the divider table
+ */
+static inline unsigned int
+TableSetClockSource(
+    unsigned int  timer,
+    unsigned int  clockSource
+    )
+{
+  if (
+      (timer >= BENCH_NUM_TIMERS) ||
+      (clockSource >= BENCH_NUM_CLKSOURCES)
+     )
+  {
+    return FALSE;
+  }
+
+  volatile unsigned int* TAxCTL = benchTimers[timer].TAxCTL;
+
+  unsigned int TACTL_MC_copy = *TAxCTL & ((BENCH_MC1) | (BENCH_MC0));
+  *TAxCTL &= ~((BENCH_MC1) | (BENCH_MC0));
+  *TAxCTL &= ~((BENCH_TASSEL1) | (BENCH_TASSEL0));
+  *TAxCTL |= (BENCH_TASSEL1);
+  *TAxCTL &= ~((BENCH_ID1) | (BENCH_ID0));
+  *TAxCTL |= benchClockSourceDividers[clockSource];
+  *TAxCTL |= BENCH_TACLR;
+  *TAxCTL |= TACTL_MC_copy;
+
+  return TRUE;
+}
+
+/**
+ * Sets the output mode through the timer's descriptor and the mode table
+ */
+static inline unsigned int
+TableSetOutputMode(
+    unsigned int  timer,
+    unsigned int  output,
+    unsigned int  outputMode
+    )
+{
+  if (
+      (timer >= BENCH_NUM_TIMERS) ||
+      (output >= BENCH_NUM_OUTPUTS) ||
+      (outputMode >= BENCH_NUM_OUTPUT_MODES)
+     )
+  {
+    return FALSE;
+  }
+
+  volatile unsigned int* TACCTL = benchTimers[timer].TAxCCTL[benchOutputBlocks[output]];
+  *TACCTL = (*TACCTL & ~((BENCH_OUTMOD2) | (BENCH_OUTMOD1) | (BENCH_OUTMOD0) | (BENCH_OUT))) | benchOutputModes[outputMode];
+
+  return TRUE;
+}
+
+/**
+ * HAL functions of the emulated Timer_A modules, called through their ops
+ */
+static unsigned int
+OpsSetClockSource(
+    System_TimerID          timer,
+    System_TimerClockSource clockSource
+    )
+{
+  return TableSetClockSource(timer, clockSource);
+}
+
+static unsigned int
+OpsSetCompareOutputMode(
+    System_TimerID                timer,
+    System_TimerCompareOutput     output,
+    System_TimerCompareOutputMode outputMode
+    )
+{
+  return TableSetOutputMode(timer, output, outputMode);
+}
+
+/**
+ * Ops of a Timer_A module, with only the functions measured here
+ */
+static const System_TimerOps benchTimerAOps =
+{
+  .setClockSource       = OpsSetClockSource,
+  .setCompareOutputMode = OpsSetCompareOutputMode
+};
+
+/**
+ * Ops of each timer, laid out as system_timerOps and read through a volatile
+ * pointer so that calls through it stay indirect
+ */
+static const System_TimerOps* const benchTimerOps [BENCH_NUM_TIMERS] =
+{
+  &benchTimerAOps,
+  &benchTimerAOps
+};
+
+static const System_TimerOps* const* volatile benchOpsTable = benchTimerOps;
+
+/**
+ * Provides the current monotonic time in nanoseconds
+ */
+static double
+GetTimeNanoSec()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return ((double)now.tv_sec * 1e9) + (double)now.tv_nsec;
+}
+
+/**
+ * Calls the given operation the given number of times through the given
+ * variant
+ */
+static void
+RunOp(
+    BenchVariant      variant,
+    BenchOp           op,
+    unsigned long int numIterations
+    )
+{
+  unsigned int result = 0;
+  const System_TimerOps* const* ops = benchOpsTable;
+
+  unsigned long int iter;
+  for(
+      iter = 0;
+      iter < numIterations;
+      iter++
+     )
+  {
+    unsigned int timer = iter & 1;
+    unsigned int output = (iter >> 1) & 1;
+    unsigned int value = (unsigned int)(iter >> 2);
+
+    switch (op)
+    {
+      case BENCH_OP_SET_CLOCK_SOURCE:
+        value %= BENCH_NUM_CLKSOURCES;
+
+        switch (variant)
+        {
+          case BENCH_VARIANT_SWITCH:  result += SwitchSetClockSource(timer, value); break;
+          case BENCH_VARIANT_TABLE:   result += TableSetClockSource(timer, value); break;
+          case BENCH_VARIANT_OPS:     result += (*ops[timer]->setClockSource)(timer, value); break;
+
+          default:
+            break;
+        };
+        break;
+
+      case BENCH_OP_SET_OUTPUT_MODE:
+        value %= BENCH_NUM_OUTPUT_MODES;
+
+        switch (variant)
+        {
+          case BENCH_VARIANT_SWITCH:  result += SwitchSetOutputMode(timer, output, value); break;
+          case BENCH_VARIANT_TABLE:   result += TableSetOutputMode(timer, output, value); break;
+          case BENCH_VARIANT_OPS:     result += (*ops[timer]->setCompareOutputMode)(timer, output, value); break;
+
+          default:
+            break;
+        };
+        break;
+
+      default:
+        break;
+    };
+  }
+
+  benchSink = result;
+}
+
+int main()
+{
+  unsigned int op;
+  for(
+      op = 0;
+      op < BENCH_NUM_OPS;
+      op++
+     )
+  {
+    unsigned int variant;
+    for(
+        variant = 0;
+        variant < BENCH_NUM_VARIANTS;
+        variant++
+       )
+    {
+      // Warm up caches and branch predictors before measuring
+      RunOp(variant, op, BENCH_NUM_ITERATIONS / 10);
+
+      double startTime = GetTimeNanoSec();
+      RunOp(variant, op, BENCH_NUM_ITERATIONS);
+      double endTime = GetTimeNanoSec();
+
+      printf(
+          "hal variant=%s op=%s iterations=%lu ns_per_call=%.2f\n",
+          benchVariantNames[variant],
+          benchOpNames[op],
+          BENCH_NUM_ITERATIONS,
+          (endTime - startTime) / BENCH_NUM_ITERATIONS
+          );
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#else
+#define BENCH_HAVE_TSC 0
+#endif
+
+#include "TimerDriver.h"
+#include "TargetSystem.h"
+
+/**
+ * \file benchHotPaths.c
+ *
+ * Host benchmark for the driver's hot paths
+ *
+ * Measures the cost per call of the compare match callback, of starting and
+ * stopping a timer, and of setting a timer's cycle time, against the mock
+ * system. Each result is printed on its own line as space separated key=value
+ * pairs so that runs can be compared by script. Time stamp counter ticks are
+ * reported alongside the wall time on x86 hosts.
+ *
+ * Built with TIMER_HAL_OPS, the driver calls the mock's HAL functions through
+ * each timer's System_TimerOps instead, as reported by the hal key.
+ *
+ * The same paths are measured in core cycles on the AVR target by the
+ * benchmark under avr/.
+ */
+
+#define BENCH_NUM_ITERATIONS 1000000UL
+
+/**
+ * Cycle times the setter benchmark steps through, in milliseconds
+ */
+static const unsigned long int benchCycleTimes [] = { 1, 10, 100, 500, 1000, 5000 };
+
+#define BENCH_NUM_CYCLE_TIMES (sizeof(benchCycleTimes) / sizeof(benchCycleTimes[0]))
+
+/**
+ * Hot paths measured
+ */
+typedef enum BenchPath_enum
+{
+  BENCH_PATH_COMPARE_MATCH,
+  BENCH_PATH_START_STOP,
+  BENCH_PATH_SET_CYCLE_TIME,
+  BENCH_NUM_PATHS
+} BenchPath;
+
+/**
+ * Names printed for each hot path
+ */
+static const char* benchPathNames [BENCH_NUM_PATHS] =
+{
+  "compare_match",
+  "start_stop",
+  "set_cycle_time_ms"
+};
+
+/**
+ * Provides the current monotonic time in nanoseconds
+ */
+static double
+GetTimeNanoSec()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return ((double)now.tv_sec * 1e9) + (double)now.tv_nsec;
+}
+
+/**
+ * Provides the current time stamp counter, or zero if there is none
+ */
+static unsigned long long int
+GetTimeStampCount()
+{
+#if BENCH_HAVE_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Calls the given hot path on the given timer the given number of times
+ */
+static void
+RunPath(
+    BenchPath         path,
+    TimerInstance*    timer,
+    unsigned long int numIterations
+    )
+{
+  System_EventType event = System_GetTimerCallbackEvent(GetTimerSystemID(timer));
+  System_EventCallback callback = System_GetEventCallback(event);
+  unsigned long int iter;
+
+  switch (path)
+  {
+    case BENCH_PATH_COMPARE_MATCH:
+      for(
+          iter = 0;
+          iter < numIterations;
+          iter++
+         )
+      {
+        (*callback)(event);
+      }
+      break;
+
+    case BENCH_PATH_START_STOP:
+      for(
+          iter = 0;
+          iter < numIterations;
+          iter++
+         )
+      {
+        StartTimer(timer);
+        StopTimer(timer);
+      }
+      break;
+
+    case BENCH_PATH_SET_CYCLE_TIME:
+      for(
+          iter = 0;
+          iter < numIterations;
+          iter++
+         )
+      {
+        SetTimerCycleTimeMilliSec(timer, benchCycleTimes[iter % BENCH_NUM_CYCLE_TIMES]);
+      }
+      break;
+
+    default:
+      break;
+  };
+}
+
+int main()
+{
+  InitTimers();
+
+  System_SetMaxTimerValue(SYSTEM_TIMER0, 256);
+  TimerInstance* timer = CreateTimer();
+  SetTimerCycleTimeMilliSec(timer, 500);
+
+  BenchPath path;
+  for(
+      path = 0;
+      path < BENCH_NUM_PATHS;
+      path++
+     )
+  {
+    // Compare matches are only taken while the timer runs
+    if (path == BENCH_PATH_COMPARE_MATCH)
+    {
+      StartTimer(timer);
+    }
+
+    // Warm up caches and branch predictors before timing
+    RunPath(path, timer, BENCH_NUM_ITERATIONS / 10);
+
+    double startTime = GetTimeNanoSec();
+    unsigned long long int startCount = GetTimeStampCount();
+    RunPath(path, timer, BENCH_NUM_ITERATIONS);
+    unsigned long long int endCount = GetTimeStampCount();
+    double endTime = GetTimeNanoSec();
+
+    StopTimer(timer);
+
+    printf(
+        "hotpath target=host hal=%s path=%s iterations=%lu ns_per_call=%.2f tsc_per_call=%.2f\n",
+        TIMER_HAL_OPS ? "ops" : "direct",
+        benchPathNames[path],
+        BENCH_NUM_ITERATIONS,
+        (endTime - startTime) / BENCH_NUM_ITERATIONS,
+        (double)(endCount - startCount) / BENCH_NUM_ITERATIONS
+        );
+  }
+
+  DestroyAllTimers();
+
+  return 0;
+}
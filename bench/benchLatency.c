@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "TimerDriver.h"
+#include "TimerEvents.h"
+#include "TargetSystem.h"
+
+/**
+ * \file benchLatency.c
+ *
+ * Host benchmark for cycle handler latency
+ *
+ * Measures the time from a compare match interrupt posting its event to the
+ * timer's cycle handler running, in immediate and deferred handler modes. The
+ * interrupt is simulated at a random point in each pass of a main loop that
+ * does some other work before processing timer events, so the deferred
+ * latency spreads out with the work while the immediate latency does not.
+ */
+
+#define BENCH_NUM_TRIALS 100000UL
+
+static volatile unsigned long int benchSink = 0;
+
+static double handlerTime = 0;
+
+/**
+ * Provides the current monotonic time in nanoseconds
+ */
+static double
+GetTimeNanoSec()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return ((double)now.tv_sec * 1e9) + (double)now.tv_nsec;
+}
+
+/**
+ * Cycle handler recording when it ran
+ */
+static void
+RecordHandlerTime()
+{
+  handlerTime = GetTimeNanoSec();
+}
+
+/**
+ * Stands in for the rest of the main loop's work
+ */
+static void
+DoMainLoopWork(
+    unsigned long int numIterations
+    )
+{
+  unsigned long int iter;
+  for(
+      iter = 0;
+      iter < numIterations;
+      iter++
+     )
+  {
+    benchSink++;
+  }
+}
+
+/**
+ * Reports the handler latency for the given mode and amount of main loop work
+ */
+static void
+MeasureLatency(
+    TimerInstance*    timer,
+    TimerHandlerMode  mode,
+    unsigned long int numWorkIterations
+    )
+{
+  System_EventType event = System_GetTimerCallbackEvent(GetTimerSystemID(timer));
+  double minLatency = 0;
+  double maxLatency = 0;
+  double latencySum = 0;
+
+  SetTimerHandlerMode(timer, mode);
+
+  unsigned long int trial;
+  for(
+      trial = 0;
+      trial < BENCH_NUM_TRIALS;
+      trial++
+     )
+  {
+    unsigned long int numWorkBefore = (numWorkIterations == 0) ? 0 : ((unsigned long int)rand() % numWorkIterations);
+
+    DoMainLoopWork(numWorkBefore);
+    double postTime = GetTimeNanoSec();
+    PostTimerEvent(event);
+    DoMainLoopWork(numWorkIterations - numWorkBefore);
+    ProcessTimerEvents();
+
+    double latency = handlerTime - postTime;
+    latencySum += latency;
+
+    if (
+        (trial == 0) ||
+        (latency < minLatency)
+       )
+    {
+      minLatency = latency;
+    }
+
+    if (latency > maxLatency)
+    {
+      maxLatency = latency;
+    }
+  }
+
+  printf(
+      "latency mode=%s main_loop_work_iterations=%lu min_ns=%.0f mean_ns=%.0f max_ns=%.0f\n",
+      (mode == TIMER_HANDLER_IMMEDIATE) ? "immediate" : "deferred",
+      numWorkIterations,
+      minLatency,
+      latencySum / BENCH_NUM_TRIALS,
+      maxLatency
+      );
+}
+
+int main()
+{
+  static const unsigned long int workIterations [] = { 0, 1000, 10000 };
+
+  InitTimers();
+  InitTimerEvents();
+  System_SetMaxTimerValue(SYSTEM_TIMER0, 256);
+
+  TimerInstance* timer = CreateTimer();
+  SetTimerCycleTimeMilliSec(timer, 8);
+  SetTimerCycleHandler(timer, RecordHandlerTime);
+  StartTimer(timer);
+
+  unsigned int workIdx;
+  for(
+      workIdx = 0;
+      workIdx < (sizeof(workIterations) / sizeof(workIterations[0]));
+      workIdx++
+     )
+  {
+    MeasureLatency(timer, TIMER_HANDLER_IMMEDIATE, workIterations[workIdx]);
+    MeasureLatency(timer, TIMER_HANDLER_DEFERRED, workIterations[workIdx]);
+  }
+
+  DestroyAllTimers();
+
+  return 0;
+}
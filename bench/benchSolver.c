@@ -0,0 +1,314 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "TimerDriver.h"
+#include "TargetSystem.h"
+
+/**
+ * \file benchSolver.c
+ *
+ * Host benchmark for the cycle time solver
+ *
+ * Compares SetTimerCycleTimeMilliSec() against the brute-force search the
+ * driver used to do, which tried every number of compare matches per cycle
+ * from one upward. The largest error of the whole cycle length, in ticks of
+ * the selected clock source, is reported for both solvers over a dense range
+ * of periods, then their number of clock source frequency queries and run time
+ * are reported for periods from 1 ms to 1 h. Finally the first-fit and best-fit
+ * solver modes are compared by their cycle error in ticks of the fastest clock
+ * source and their number of compare matches per cycle.
+ */
+
+#define BENCH_MAX_CHECKED_MILLISEC 20000
+
+/**
+ * Result of a cycle time search
+ */
+typedef struct BenchSolution_struct
+{
+  unsigned int            valid;
+  System_TimerClockSource clockSource;
+  unsigned int            compareMatch;
+  unsigned int            finalCompareMatch;
+  unsigned int            compareMatchesPerCycle;
+} BenchSolution;
+
+/**
+ * Reference copy of the original brute-force search
+ */
+static BenchSolution
+BruteForceSolve(
+    System_TimerID  timer,
+    unsigned int    numMilliSec
+    )
+{
+  BenchSolution solution = { FALSE, SYSTEM_TIMER_CLKSOURCE_INVALID, 0, 0, 0 };
+  unsigned long int MAX_IDEAL_FREQ_MS_COUNTER = System_TimerGetMaxValue(timer) * 1000;
+  unsigned long int idealFrequency = 0;
+  unsigned int numMilliSecPerSubCycle = 0;
+  unsigned long int clockSourceFrequency = 0;
+  unsigned int compareMatchesPerCycle = 0;
+
+  for (;;)
+  {
+    compareMatchesPerCycle++;
+
+    if (compareMatchesPerCycle > numMilliSec)
+    {
+      return solution;
+    }
+
+    numMilliSecPerSubCycle = numMilliSec / compareMatchesPerCycle;
+    idealFrequency = (unsigned long int)(MAX_IDEAL_FREQ_MS_COUNTER / numMilliSecPerSubCycle);
+
+    unsigned int clockSourceIter;
+    for(
+        clockSourceIter = 0;
+        clockSourceIter < NUM_TIMER_CLKSOURCES;
+        clockSourceIter++
+       )
+    {
+      clockSourceFrequency = System_TimerGetSourceFrequency(clockSourceIter);
+      if (clockSourceFrequency == 0)
+      {
+        continue;
+      }
+
+      if (idealFrequency >= clockSourceFrequency)
+      {
+        solution.valid = TRUE;
+        solution.clockSource = clockSourceIter;
+        solution.compareMatch = (unsigned int)((numMilliSecPerSubCycle * clockSourceFrequency) / 1000);
+        solution.finalCompareMatch = solution.compareMatch;
+        solution.compareMatchesPerCycle = compareMatchesPerCycle;
+        return solution;
+      }
+    }
+  }
+}
+
+/**
+ * Runs the driver's solver and collects its result
+ */
+static BenchSolution
+DriverSolve(
+    TimerInstance*  timer,
+    unsigned int    numMilliSec
+    )
+{
+  BenchSolution solution = { FALSE, SYSTEM_TIMER_CLKSOURCE_INVALID, 0, 0, 0 };
+
+  if (SetTimerCycleTimeMilliSec(timer, numMilliSec) == TRUE)
+  {
+    solution.valid = TRUE;
+    solution.clockSource = GetTimerClockSource(timer);
+    solution.compareMatch = GetTimerCompareMatch(timer);
+    solution.finalCompareMatch = GetTimerFinalCompareMatch(timer);
+    solution.compareMatchesPerCycle = GetTimerCompareMatchesPerCycle(timer);
+  }
+
+  return solution;
+}
+
+/**
+ * Provides the difference in ticks between the cycle length of a solution and
+ * the requested cycle length
+ */
+static double
+GetCycleErrorTicks(
+    BenchSolution solution,
+    unsigned int  numMilliSec
+    )
+{
+  double exactTicks = ((double)numMilliSec * System_TimerGetSourceFrequency(solution.clockSource)) / 1000.0;
+  double cycleTicks =
+    ((double)(solution.compareMatchesPerCycle - 1) * solution.compareMatch) +
+    solution.finalCompareMatch;
+
+  return (cycleTicks > exactTicks) ? (cycleTicks - exactTicks) : (exactTicks - cycleTicks);
+}
+
+/**
+ * Accumulates the cycle error and interrupt load of a solver mode over the
+ * checked range of periods
+ */
+static void
+MeasureSolverMode(
+    TimerInstance*    timer,
+    TimerSolverMode   mode,
+    double*           maxError,
+    double*           meanError,
+    double*           meanCompareMatches
+    )
+{
+  double errorSum = 0;
+  double compareMatchSum = 0;
+  unsigned int numSolved = 0;
+
+  *maxError = 0;
+  SetTimerSolverMode(timer, mode);
+
+  unsigned int numMilliSec;
+  for(
+      numMilliSec = 1;
+      numMilliSec <= BENCH_MAX_CHECKED_MILLISEC;
+      numMilliSec++
+     )
+  {
+    if (SetTimerCycleTimeMilliSec(timer, numMilliSec) == FALSE)
+    {
+      continue;
+    }
+
+    long long int error = GetTimerCycleErrorTicks(timer);
+    double absError = (error < 0) ? -(double)error : (double)error;
+
+    if (absError > *maxError)
+    {
+      *maxError = absError;
+    }
+
+    errorSum += absError;
+    compareMatchSum += GetTimerCompareMatchesPerCycle(timer);
+    numSolved++;
+  }
+
+  *meanError = (numSolved != 0) ? (errorSum / numSolved) : 0;
+  *meanCompareMatches = (numSolved != 0) ? (compareMatchSum / numSolved) : 0;
+
+  SetTimerSolverMode(timer, TIMER_SOLVER_FIRST_FIT);
+}
+
+/**
+ * Provides the current monotonic time in nanoseconds
+ */
+static double
+GetTimeNanoSec()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return ((double)now.tv_sec * 1e9) + (double)now.tv_nsec;
+}
+
+int main()
+{
+  static const unsigned long int coreFrequencies [] = { 1000000, 8000000, 16000000 };
+  static const unsigned int sweepMilliSec [] =
+  {
+    1, 2, 5, 10, 20, 50, 100, 200, 500,
+    1000, 2000, 5000, 10000, 20000, 60000,
+    300000, 600000, 1800000, 3600000
+  };
+
+  InitTimers();
+  System_SetMaxTimerValue(SYSTEM_TIMER0, 256);
+  TimerInstance* timer = CreateTimer();
+  System_TimerID timerID = GetTimerSystemID(timer);
+
+  unsigned int freqIdx;
+  for(
+      freqIdx = 0;
+      freqIdx < (sizeof(coreFrequencies) / sizeof(coreFrequencies[0]));
+      freqIdx++
+     )
+  {
+    System_SetCoreClockFrequency(coreFrequencies[freqIdx]);
+
+    double bruteForceMaxError = 0;
+    double driverMaxError = 0;
+    unsigned int numMilliSec;
+    for(
+        numMilliSec = 1;
+        numMilliSec <= BENCH_MAX_CHECKED_MILLISEC;
+        numMilliSec++
+       )
+    {
+      BenchSolution bruteForce = BruteForceSolve(timerID, numMilliSec);
+      BenchSolution driver = DriverSolve(timer, numMilliSec);
+
+      if (
+          (bruteForce.valid == TRUE) &&
+          (GetCycleErrorTicks(bruteForce, numMilliSec) > bruteForceMaxError)
+         )
+      {
+        bruteForceMaxError = GetCycleErrorTicks(bruteForce, numMilliSec);
+      }
+
+      if (
+          (driver.valid == TRUE) &&
+          (GetCycleErrorTicks(driver, numMilliSec) > driverMaxError)
+         )
+      {
+        driverMaxError = GetCycleErrorTicks(driver, numMilliSec);
+      }
+    }
+
+    printf(
+        "solver core_hz=%lu checked_period_ms=1..%u brute_force_max_error_ticks=%.3f closed_form_max_error_ticks=%.3f\n",
+        coreFrequencies[freqIdx],
+        BENCH_MAX_CHECKED_MILLISEC,
+        bruteForceMaxError,
+        driverMaxError
+        );
+
+    unsigned int sweepIdx;
+    for(
+        sweepIdx = 0;
+        sweepIdx < (sizeof(sweepMilliSec) / sizeof(sweepMilliSec[0]));
+        sweepIdx++
+       )
+    {
+      numMilliSec = sweepMilliSec[sweepIdx];
+
+      System_ClearNumSourceFrequencyQueries();
+      double startTime = GetTimeNanoSec();
+      BruteForceSolve(timerID, numMilliSec);
+      double bruteForceTime = GetTimeNanoSec() - startTime;
+      unsigned long int bruteForceQueries = System_GetNumSourceFrequencyQueries();
+
+      System_ClearNumSourceFrequencyQueries();
+      startTime = GetTimeNanoSec();
+      DriverSolve(timer, numMilliSec);
+      double driverTime = GetTimeNanoSec() - startTime;
+      unsigned long int driverQueries = System_GetNumSourceFrequencyQueries();
+
+      printf(
+          "solver core_hz=%lu period_ms=%u brute_force_queries=%lu brute_force_ns=%.0f closed_form_queries=%lu closed_form_ns=%.0f\n",
+          coreFrequencies[freqIdx],
+          numMilliSec,
+          bruteForceQueries,
+          bruteForceTime,
+          driverQueries,
+          driverTime
+          );
+    }
+
+    double firstFitMaxError;
+    double firstFitMeanError;
+    double firstFitMeanCompareMatches;
+    double bestFitMaxError;
+    double bestFitMeanError;
+    double bestFitMeanCompareMatches;
+
+    MeasureSolverMode(timer, TIMER_SOLVER_FIRST_FIT, &firstFitMaxError, &firstFitMeanError, &firstFitMeanCompareMatches);
+    MeasureSolverMode(timer, TIMER_SOLVER_BEST_FIT, &bestFitMaxError, &bestFitMeanError, &bestFitMeanCompareMatches);
+
+    printf(
+        "solver_mode core_hz=%lu checked_period_ms=1..%u first_fit_max_error_ticks=%.0f first_fit_mean_error_ticks=%.3f first_fit_mean_compare_matches=%.3f best_fit_max_error_ticks=%.0f best_fit_mean_error_ticks=%.3f best_fit_mean_compare_matches=%.3f\n",
+        coreFrequencies[freqIdx],
+        BENCH_MAX_CHECKED_MILLISEC,
+        firstFitMaxError,
+        firstFitMeanError,
+        firstFitMeanCompareMatches,
+        bestFitMaxError,
+        bestFitMeanError,
+        bestFitMeanCompareMatches
+        );
+  }
+
+  DestroyAllTimers();
+
+  return 0;
+}
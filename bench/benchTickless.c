@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "TimerDriver.h"
+#include "TimerEvents.h"
+#include "TargetSystem.h"
+
+/**
+ * \file benchTickless.c
+ *
+ * Host simulation of one-shot deadline interrupt counts
+ *
+ * Runs typical one-shot workloads on the mock system's simulated clock, once
+ * off a 1ms tick that counts down each pending one-shot in software, and once
+ * off the tickless deadline timer. Each workload is a set of chains, each of
+ * which re-arms a one-shot of a fixed delay from its handler a number of
+ * times. The number of timer interrupts each way is printed, along with the
+ * latest any one-shot was handled, as space separated key=value pairs.
+ */
+
+#if TIMER_NUM_DEADLINES == 0
+#error "benchTickless needs TIMER_NUM_DEADLINES"
+#endif
+
+/**
+ * Core clock frequency simulated, that of the trinket
+ */
+#define BENCH_CORE_CLOCK_FREQ 8000000UL
+
+#define BENCH_MAX_CHAINS 4
+
+/**
+ * One-shot re-armed from its own handler
+ */
+typedef struct BenchChain_struct
+{
+  unsigned long int delayMilliSec;  /**< Delay of each one-shot */
+  unsigned int      numShots;       /**< Number of one-shots in the chain */
+} BenchChain;
+
+/**
+ * Workload of one-shot chains running at once
+ */
+typedef struct BenchWorkload_struct
+{
+  const char*   name;                       /**< Name printed for the workload */
+  unsigned int  numChains;                  /**< Number of chains */
+  BenchChain    chains [BENCH_MAX_CHAINS];  /**< Chains, all started together */
+} BenchWorkload;
+
+static const BenchWorkload benchWorkloads [] =
+{
+  { "sparse",   2, { { 1250, 8 }, { 3300, 3 } } },
+  { "timeouts", 1, { { 50, 200 } } },
+  { "mixed",    3, { { 100, 100 }, { 730, 13 }, { 20, 5 } } }
+};
+
+#define BENCH_NUM_WORKLOADS (sizeof(benchWorkloads) / sizeof(benchWorkloads[0]))
+
+/**
+ * Progress of a chain through a run
+ */
+typedef struct BenchChainState_struct
+{
+  const BenchChain*       chain;          /**< Chain being run */
+  unsigned int            numShotsLeft;   /**< Number of one-shots still to handle */
+  unsigned long int       numTicksLeft;   /**< Number of 1ms ticks until the pending one-shot, for the tick run */
+  unsigned long long int  dueTime;        /**< Core clock cycle the pending one-shot is due on */
+} BenchChainState;
+
+static BenchChainState benchChainStates [BENCH_MAX_CHAINS];
+static unsigned int benchNumChains = 0;
+static unsigned long long int benchMaxLateCycles = 0;
+
+/**
+ * Records how late the given chain's one-shot was handled, and re-arms it
+ *
+ * \return Nonzero if the chain has another one-shot pending, zero otherwise
+ */
+static unsigned int
+HandleShot(
+    BenchChainState*  state
+    )
+{
+  unsigned long long int now = System_GetTime();
+
+  if (now - state->dueTime > benchMaxLateCycles)
+  {
+    benchMaxLateCycles = now - state->dueTime;
+  }
+
+  state->numShotsLeft--;
+
+  if (state->numShotsLeft == 0)
+  {
+    return FALSE;
+  }
+
+  state->dueTime = now + (state->chain->delayMilliSec * (BENCH_CORE_CLOCK_FREQ / 1000));
+  return TRUE;
+}
+
+/**
+ * Deadline handler for the tickless run
+ */
+static void
+HandleDeadline(
+    void* context
+    )
+{
+  BenchChainState* state = (BenchChainState*)context;
+
+  if (HandleShot(state) == TRUE)
+  {
+    AddTimerDeadline(HandleDeadline, state, state->chain->delayMilliSec * 1000);
+  }
+}
+
+/**
+ * Cycle handler of the 1ms tick, counting down each pending one-shot
+ */
+static void
+HandleTick()
+{
+  unsigned int chainIdx;
+  for(
+      chainIdx = 0;
+      chainIdx < benchNumChains;
+      chainIdx++
+     )
+  {
+    BenchChainState* state = &benchChainStates[chainIdx];
+
+    if (state->numShotsLeft == 0)
+    {
+      continue;
+    }
+
+    state->numTicksLeft--;
+
+    if (
+        (state->numTicksLeft == 0) &&
+        (HandleShot(state) == TRUE)
+       )
+    {
+      state->numTicksLeft = state->chain->delayMilliSec;
+    }
+  }
+}
+
+/**
+ * Simulates the given workload, off a 1ms tick or tickless
+ *
+ * \return Number of timer interrupts taken
+ */
+static unsigned long int
+RunWorkload(
+    const BenchWorkload*  workload,
+    unsigned int          isTickless,
+    unsigned long int*    numShots,
+    unsigned long int*    durationMilliSec
+    )
+{
+  System_ResetSimulation();
+  InitTimers();
+  InitTimerEvents();
+
+  TimerInstance* timer = CreateTimer();
+
+  if (isTickless == TRUE)
+  {
+    StartTimerDeadlines(timer);
+  }
+  else
+  {
+    SetTimerCycleTimeMilliSec(timer, 1);
+    SetTimerHandlerMode(timer, TIMER_HANDLER_IMMEDIATE);
+    SetTimerCycleHandler(timer, HandleTick);
+    StartTimer(timer);
+  }
+
+  benchNumChains = workload->numChains;
+  benchMaxLateCycles = 0;
+  *numShots = 0;
+  *durationMilliSec = 0;
+
+  unsigned int chainIdx;
+  for(
+      chainIdx = 0;
+      chainIdx < workload->numChains;
+      chainIdx++
+     )
+  {
+    const BenchChain* chain = &workload->chains[chainIdx];
+    BenchChainState* state = &benchChainStates[chainIdx];
+
+    state->chain = chain;
+    state->numShotsLeft = chain->numShots;
+    state->numTicksLeft = chain->delayMilliSec;
+    state->dueTime = System_GetTime() + (chain->delayMilliSec * (BENCH_CORE_CLOCK_FREQ / 1000));
+
+    if (isTickless == TRUE)
+    {
+      AddTimerDeadline(HandleDeadline, state, chain->delayMilliSec * 1000);
+    }
+
+    *numShots += chain->numShots;
+
+    if ((chain->delayMilliSec * chain->numShots) > *durationMilliSec)
+    {
+      *durationMilliSec = chain->delayMilliSec * chain->numShots;
+    }
+  }
+
+  System_AdvanceTimeMilliSec(*durationMilliSec + 1);
+
+  unsigned long int numInterrupts = System_GetNumTimerCompareMatches(GetTimerSystemID(timer));
+  DestroyAllTimers();
+
+  return numInterrupts;
+}
+
+int main()
+{
+  System_SetCoreClockFrequency(BENCH_CORE_CLOCK_FREQ);
+  System_SetMaxTimerValue(SYSTEM_TIMER0, 256);
+
+  unsigned int workloadIdx;
+  for(
+      workloadIdx = 0;
+      workloadIdx < BENCH_NUM_WORKLOADS;
+      workloadIdx++
+     )
+  {
+    const BenchWorkload* workload = &benchWorkloads[workloadIdx];
+    unsigned long int numShots;
+    unsigned long int durationMilliSec;
+
+    unsigned long int numTickInterrupts = RunWorkload(workload, FALSE, &numShots, &durationMilliSec);
+    unsigned long long int tickMaxLateCycles = benchMaxLateCycles;
+    unsigned long int numTicklessInterrupts = RunWorkload(workload, TRUE, &numShots, &durationMilliSec);
+    unsigned long long int ticklessMaxLateCycles = benchMaxLateCycles;
+
+    printf(
+        "tickless workload=%s oneshots=%lu duration_ms=%lu tick_interrupts=%lu tickless_interrupts=%lu tick_max_late_us=%llu tickless_max_late_us=%llu\n",
+        workload->name,
+        numShots,
+        durationMilliSec,
+        numTickInterrupts,
+        numTicklessInterrupts,
+        tickMaxLateCycles / (BENCH_CORE_CLOCK_FREQ / 1000000),
+        ticklessMaxLateCycles / (BENCH_CORE_CLOCK_FREQ / 1000000)
+        );
+  }
+
+  return 0;
+}
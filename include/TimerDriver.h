@@ -5,8 +5,111 @@
  * \file TimerDriver.h
  *
  * Specification file for the timer driver
+ *
+ * Only the following functions may be called from interrupt context, such as
+ * from a cycle handler run in TIMER_HANDLER_IMMEDIATE mode:
+ * - GetTimerSystemID(), GetTimerStatus(), GetTimerClockSource(),
+ *   GetTimerCompareMatch(), GetTimerFinalCompareMatch(),
+ *   GetTimerCompareMatchesPerCycle(), GetTimerSolverMode(),
+ *   GetTimerCycleTicks(), GetTimerCycleErrorTicks() and
+ *   IsTimerCycleUpdatePending()
+ * - GetTimerSequence()
+ * - GetTimerCompareOutputMode(), GetTimerChannelCompareMatch(),
+ *   GetTimerChannelHandler(), GetTimerChannelHandlerContext(),
+ *   GetTimerPwmMode() and GetTimerPwmDutyCycle()
+ * - GetNumTimerCompareMatches(), GetNumTimerCycles(), GetTimerCycleHandler(),
+ *   GetTimerCycleHandlerEx(), GetTimerCycleHandlerContext(),
+ *   GetTimerHandlerMode(), GetTimerCatchUpPolicy(), GetTimerNumMissedCycles(),
+ *   GetTimerLastMissedCycles() and GetTimerNumOverruns()
+ * - GetTimerTicks64() and GetTimerMicroSec64(), from any interrupt that cannot
+ *   interrupt the clock's own, and IsTimerClockRunning()
+ * - GetNumTimerDeadlines(), GetNumTimerCaptures() and
+ *   GetNumLostTimerCaptures()
+ * - StartTimer() and StopTimer(), on the timer whose handler is running
+ * - StartTimerSequence(), on the timer whose sequence handler is running
+ * - AddTimerDeadline() and CancelTimerDeadline(), from a deadline handler
+ *
+ * All others must be called from the main loop. In particular,
+ * GetTimerLatencyStats() and ResetTimerLatencyStats() enable interrupts once
+ * done, and WaitForTimer() sleeps and processes events.
  */
 
+#ifndef TIMER_NUM_VIRTUAL_TIMERS
+/**
+ * Number of virtual timers available once the hardware timers are used up
+ *
+ * Virtual timers are multiplexed onto the last hardware timer, which is then
+ * reserved for that purpose and no longer handed out by CreateTimer(). Setting
+ * this to zero disables virtual timers.
+ */
+#define TIMER_NUM_VIRTUAL_TIMERS 0
+#endif
+
+#ifndef TIMER_LATENCY_STATS
+/**
+ * Nonzero to record how late each timer's cycle handler runs
+ *
+ * The timer's counter is read as each cycle completes, just before its cycle
+ * handler is called, giving the number of clock source ticks since the compare
+ * match that ended the cycle. This needs System_TimerGetCount() from the
+ * target system.
+ */
+#define TIMER_LATENCY_STATS 0
+#endif
+
+#ifndef TIMER_CAPTURE_BUFFER_SIZE
+/**
+ * Number of input capture timestamps each hardware timer holds until read
+ *
+ * This must be a power of two no larger than 128. Setting this to zero
+ * disables input capture.
+ */
+#define TIMER_CAPTURE_BUFFER_SIZE 0
+#endif
+
+/**
+ * Duty cycle of a PWM output that is high for the whole period, in hundredths
+ * of a percent
+ */
+#define TIMER_PWM_DUTY_CYCLE_MAX 10000
+
+#ifndef TIMER_NUM_DEADLINES
+/**
+ * Number of one-shot deadlines that can be pending at once
+ *
+ * Deadlines are kept by a single hardware timer, see StartTimerDeadlines().
+ * This must be no larger than 255. Setting this to zero disables deadlines.
+ */
+#define TIMER_NUM_DEADLINES 0
+#endif
+
+#ifndef TIMER_GROUP_MAX_TIMERS
+/**
+ * Number of timers a timer group can hold
+ */
+#define TIMER_GROUP_MAX_TIMERS 4
+#endif
+
+#ifndef TIMER_LATENCY_NUM_BUCKETS
+/**
+ * Number of buckets in each timer's latency histogram
+ */
+#define TIMER_LATENCY_NUM_BUCKETS 8
+#endif
+
+#ifndef TIMER_HAL_OPS
+/**
+ * Nonzero to call each hardware timer's HAL functions through its entry in
+ * system_timerOps
+ *
+ * One build of the driver can then drive timers of different kinds, each with
+ * its own System_TimerOps from the target system. Otherwise the driver calls
+ * the System_Timer* functions directly, which the target system can make
+ * static inline. This needs system_timerOps from the target system.
+ */
+#define TIMER_HAL_OPS 0
+#endif
+
 /**
  * Timer context structure typedef
  */
@@ -17,6 +120,97 @@ typedef struct TimerInstance_struct TimerInstance;
  */
 typedef void (*TimerCycleHandler)(void);
 
+/**
+ * Typedef for timer cycle handler taking the timer and a user context
+ */
+typedef void (*TimerCycleHandlerEx)(TimerInstance* instance, void* context);
+
+/**
+ * Typedef for compare channel handler taking the timer, the channel's output
+ * and a user context
+ */
+typedef void (*TimerChannelHandler)(TimerInstance* instance, unsigned int output, void* context);
+
+/**
+ * Typedef for sequence handler, called as a sequence ends or starts over
+ */
+typedef void (*TimerSequenceHandler)(TimerInstance* instance, void* context);
+
+#if TIMER_LATENCY_STATS
+/**
+ * Cycle handler latency statistics, in ticks of the timer's clock source
+ *
+ * Bucket zero counts handlers run on the tick of the compare match. Each
+ * bucket after that spans twice the latencies of the one before, so bucket n
+ * counts latencies of 2^(n-1) up to 2^n - 1 ticks, and the last bucket also
+ * counts everything longer.
+ */
+typedef struct TimerLatencyStats_struct
+{
+  unsigned int  numSamples;                         /**< Number of cycles recorded */
+  unsigned int  minTicks;                           /**< Shortest latency recorded */
+  unsigned int  maxTicks;                           /**< Longest latency recorded */
+  unsigned int  buckets [TIMER_LATENCY_NUM_BUCKETS]; /**< Number of cycles recorded in each latency range */
+} TimerLatencyStats;
+#endif
+
+#if TIMER_NUM_DEADLINES > 0
+/**
+ * Typedef for one-shot deadline handler
+ */
+typedef void (*TimerDeadlineHandler)(void* context);
+
+/**
+ * Deadline identifier returned when a deadline could not be added
+ */
+#define TIMER_DEADLINE_INVALID (TIMER_NUM_DEADLINES)
+#endif
+
+#if TIMER_CAPTURE_BUFFER_SIZE > 0
+/**
+ * Timestamp of an edge on a timer's input
+ */
+typedef struct TimerCapture_struct
+{
+  unsigned long long int  timestamp;  /**< Ticks of the fastest clock source since capture started */
+  unsigned char           isRising;   /**< Nonzero if the input rose, zero if it fell */
+} TimerCapture;
+#endif
+
+/**
+ * Hardware timers started, stopped and reset together
+ *
+ * Groups are allocated by the caller and set up with InitTimerGroup() and
+ * AddTimerToGroup(). Each timer is configured on its own as usual.
+ */
+typedef struct TimerGroup_struct
+{
+  TimerInstance*  timers [TIMER_GROUP_MAX_TIMERS];  /**< Timers in the group */
+  unsigned int    numTimers;                        /**< Number of timers in the group */
+} TimerGroup;
+
+/**
+ * Sequence of intervals between a timer's compare matches, stepped through
+ * from the compare match interrupt
+ *
+ * Sequences are allocated by the caller and set up with InitTimerSequence().
+ * Their steps are read from a constant table, which targets that can keep
+ * constants out of RAM place there when declared with SYSTEM_TABLE_MEMORY:
+ *
+ *     static const unsigned int steps [] SYSTEM_TABLE_MEMORY = { 120, 40, 40 };
+ */
+typedef struct TimerSequence_struct
+{
+  const unsigned int*         steps;          /**< Table of ticks of the clock source from each compare match to the next */
+  unsigned int                numSteps;       /**< Number of steps in the table */
+  unsigned int                clockSource;    /**< Identifier of clock source the steps are counted in */
+  unsigned int                isLooping;      /**< Nonzero to start over after the last step, zero to stop */
+  TimerSequenceHandler        handler;        /**< Handler function to call as the last step ends, if any */
+  void*                       handlerContext; /**< Context to pass to the handler */
+  volatile unsigned int       step;           /**< Index of step running */
+  volatile unsigned long int  numPasses;      /**< Number of times the last step has ended */
+} TimerSequence;
+
 /**
  * Enumeration of all possible timer states
  */
@@ -27,6 +221,44 @@ typedef enum TimerStatus_enum
   TIMER_STATUS_RUNNING
 } TimerStatus;
 
+/**
+ * Enumeration of strategies for finding a timer configuration for a cycle time
+ */
+typedef enum TimerSolverMode_enum
+{
+  TIMER_SOLVER_FIRST_FIT, /**< Fewest compare matches per cycle, then fastest clock source */
+  TIMER_SOLVER_BEST_FIT   /**< Smallest cycle time error, then fewest compare matches per cycle */
+} TimerSolverMode;
+
+/**
+ * Enumeration of contexts to run timer cycle handlers in
+ */
+typedef enum TimerHandlerMode_enum
+{
+  TIMER_HANDLER_DEFERRED, /**< From the main loop, once the event has been dispatched */
+  TIMER_HANDLER_IMMEDIATE /**< From the interrupt service routine that posts the event */
+} TimerHandlerMode;
+
+/**
+ * Enumeration of ways to catch up on cycles missed when a timer overruns
+ */
+typedef enum TimerCatchUpPolicy_enum
+{
+  TIMER_CATCHUP_SKIP,     /**< Count the missed cycles, but only call the cycle handler for cycles actually seen to complete */
+  TIMER_CATCHUP_REPLAY,   /**< Call the cycle handler once for each missed cycle as well */
+  TIMER_CATCHUP_COALESCE  /**< Call the cycle handler once for all of them, see GetTimerLastMissedCycles() */
+} TimerCatchUpPolicy;
+
+/**
+ * Enumeration of PWM waveforms a hardware timer can generate
+ */
+typedef enum TimerPwmMode_enum
+{
+  TIMER_PWM_NONE,         /**< No PWM, the timer clears on compare match */
+  TIMER_PWM_FAST,         /**< Count up once per period, with the output high from the start of each period */
+  TIMER_PWM_PHASE_CORRECT /**< Count up and back down once per period, with the output high around the start of each period */
+} TimerPwmMode;
+
 /**
  * Initializes the timer driver
  *
@@ -38,6 +270,12 @@ InitTimers();
 /**
  * Allocates a new timer context (if possible)
  *
+ * Hardware timers are handed out first. Once they are all in use, virtual
+ * timers are handed out instead (see TIMER_NUM_VIRTUAL_TIMERS). Virtual timers
+ * support the same cycle times and handlers as hardware timers, but have no
+ * compare outputs, and a virtual timer started while others are running
+ * begins counting at the next compare match of the virtual timer base.
+ *
  * \return Pointer to new context, or NULL if not created
  */
 TimerInstance*
@@ -54,6 +292,9 @@ DestroyTimer(
 /**
  * Destroys all timers in use
  *
+ * The monotonic clock, deadlines and any input capture are stopped along with
+ * them, dropping pending deadlines.
+ *
  * \note All existing TimerInstance pointers are invalidated by this function
  */
 void
@@ -93,6 +334,19 @@ GetTimerCompareMatch(
     TimerInstance*  instance  /**< Pointer to instance of timer to get match value of */
     );
 
+/**
+ * Provides the given timer's compare match value for the last sub-cycle
+ *
+ * The remainder of the cycle time that does not divide evenly among the
+ * sub-cycles is added to the last one, so that the whole cycle spans exactly
+ * the number of clock ticks requested. This is the same as the regular compare
+ * match value when the cycle divides evenly.
+ */
+unsigned int
+GetTimerFinalCompareMatch(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get final match value of */
+    );
+
 /**
  * Provides the given timer's number of compare matches per cycle
  *
@@ -107,6 +361,64 @@ GetTimerCompareMatchesPerCycle(
     TimerInstance*  instance  /**< Pointer to instance of timer get matches-per-cycle of */
     );
 
+/**
+ * Provides the strategy used to configure the given timer for a cycle time
+ */
+TimerSolverMode
+GetTimerSolverMode(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get solver mode of */
+    );
+
+/**
+ * Sets the strategy used to configure the given timer for a cycle time
+ *
+ * This takes effect the next time the cycle time is set. First fit is the
+ * default.
+ *
+ * \note Best fit will favor a faster clock source that divides the cycle time
+ * exactly, which can take many more compare matches per cycle.
+ *
+ * \return Nonzero if the solver mode was set, zero otherwise
+ */
+unsigned int
+SetTimerSolverMode(
+    TimerInstance*  instance, /**< Pointer to instance of timer to set solver mode of */
+    TimerSolverMode mode      /**< Strategy to use */
+    );
+
+/**
+ * Provides the length of the given timer's cycle as configured
+ *
+ * \return Cycle length in ticks of the fastest clock source
+ */
+unsigned long long int
+GetTimerCycleTicks(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get cycle length of */
+    );
+
+/**
+ * Provides the difference between the given timer's configured cycle length
+ * and the cycle time last requested
+ *
+ * \return Configured minus requested cycle length, in ticks of the fastest
+ * clock source
+ */
+long long int
+GetTimerCycleErrorTicks(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get cycle error of */
+    );
+
+/**
+ * Provides whether a cycle time set while the given timer ran is waiting for
+ * the current cycle to end
+ *
+ * \return Nonzero if the new cycle time has yet to take over, zero otherwise
+ */
+unsigned int
+IsTimerCycleUpdatePending(
+    TimerInstance*  instance  /**< Pointer to instance of timer to check */
+    );
+
 /**
  * Starts the given timer, if not already running
  *
@@ -125,9 +437,132 @@ StopTimer(
     TimerInstance*  instance  /**< Pointer to instance of timer to  stop */
     );
 
+/**
+ * Empties the given timer group
+ */
+void
+InitTimerGroup(
+    TimerGroup* group /**< Pointer to group to initialize */
+    );
+
+/**
+ * Adds a hardware timer to the given group
+ *
+ * \note Virtual timers share a single hardware timer, so cannot be grouped
+ *
+ * \return Nonzero if the timer was added, zero otherwise
+ */
+unsigned int
+AddTimerToGroup(
+    TimerGroup*     group,    /**< Pointer to group to add to */
+    TimerInstance*  instance  /**< Pointer to instance of timer to add */
+    );
+
+/**
+ * Starts every timer in the given group in phase, from the start of a cycle
+ *
+ * Where the target can hold its prescalers, all timers start counting on the
+ * same clock source tick. Otherwise their counters are cleared back to back
+ * with interrupts disabled, leaving only the few cycles between writes as skew.
+ *
+ * \return Nonzero if the timers were started, zero if none were because any
+ * could not be
+ */
+unsigned int
+StartTimerGroup(
+    TimerGroup* group /**< Pointer to group to start */
+    );
+
+/**
+ * Stops every timer in the given group together
+ */
+void
+StopTimerGroup(
+    TimerGroup* group /**< Pointer to group to stop */
+    );
+
+/**
+ * Brings every running timer in the given group back to the start of a cycle
+ * together, as when the group was started
+ *
+ * Cycles cut short are not counted, and their cycle handlers are not called.
+ *
+ * \note Timers running the monotonic clock or deadlines must not be reset
+ */
+void
+ResetTimerGroup(
+    TimerGroup* group /**< Pointer to group to reset */
+    );
+
+/**
+ * Sets up the given sequence to run the given table of steps
+ */
+void
+InitTimerSequence(
+    TimerSequence*        sequence,     /**< Pointer to sequence to initialize */
+    const unsigned int*   steps,        /**< Table of ticks from each compare match to the next, see TimerSequence */
+    unsigned int          numSteps,     /**< Number of steps in the table */
+    unsigned int          clockSource,  /**< Identifier of clock source to count the steps in */
+    unsigned int          isLooping,    /**< Nonzero to start over after the last step, zero to stop */
+    TimerSequenceHandler  handler,      /**< Function to call as the last step ends, or NULL for none */
+    void*                 context       /**< Context to pass to the handler */
+    );
+
+/**
+ * Runs the given sequence on a hardware timer, from its first step
+ *
+ * The timer stops whatever it was running, and its counter starts over. Each
+ * compare match interrupt writes the length of the step that just started, so
+ * the steps are timed by the hardware alone, and with a compare output mode
+ * set the output changes level on each step. The sequence handler is called
+ * from the interrupt as the last step ends, after the timer has stopped if
+ * the sequence does not loop, so it may start another sequence. Cycle
+ * handlers are not called while a sequence runs.
+ *
+ * Each step must be no longer than the timer's counter, and long enough for
+ * the interrupt to write the next step before the counter passes it.
+ * StopTimer() ends the sequence, after which StartTimer() runs the timer's own
+ * cycle time again.
+ *
+ * \note Timers in a PWM mode use their compare match for the PWM period, so
+ * cannot run sequences
+ *
+ * \return Nonzero if the sequence was started, zero otherwise
+ */
+unsigned int
+StartTimerSequence(
+    TimerInstance*  instance, /**< Pointer to instance of timer to run the sequence on */
+    TimerSequence*  sequence  /**< Pointer to sequence to run */
+    );
+
+/**
+ * Provides the sequence the given timer is running, if any
+ */
+TimerSequence*
+GetTimerSequence(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get sequence of */
+    );
+
 /**
  * Sets the timer cycle time in milliseconds
  *
+ * The fewest compare matches per cycle are used, along with the fastest clock
+ * source that fits them. The solution is computed directly, so the time taken
+ * does not depend on the cycle time requested. The cycle spans the requested
+ * time truncated to a whole number of clock ticks, with any ticks left over
+ * from dividing it into sub-cycles added to the last sub-cycle.
+ *
+ * A running hardware timer finishes its current cycle before the new cycle
+ * time takes over. With TIMER_HANDLER_IMMEDIATE the new configuration is
+ * written from the compare match interrupt ending that cycle, so no cycle is
+ * cut short or stretched. With TIMER_HANDLER_DEFERRED it is only written once
+ * ProcessTimerEvents() handles that compare match, so the first cycle at the
+ * new cycle time is stretched by the time the event waited, or by a full wrap
+ * of the counter if it has already passed the new compare match value.
+ * GetTimerCycleTicks() reports the new cycle time straight away, while the
+ * clock source and compare match values are reported as running until then
+ * (see IsTimerCycleUpdatePending()).
+ *
  * \return Nonzero if the timer cycle time was set, zero otherwise
  */
 unsigned int
@@ -136,6 +571,37 @@ SetTimerCycleTimeMilliSec(
     unsigned int      numMilliSec /**< Number of milliseconds to set period to */
     );
 
+/**
+ * Sets the timer cycle time in microseconds
+ *
+ * The clock source and compare matches are chosen as for
+ * SetTimerCycleTimeMilliSec(), with each sub-cycle lasting at least a
+ * microsecond.
+ *
+ * \return Nonzero if the timer cycle time was set, zero otherwise
+ */
+unsigned int
+SetTimerCycleTimeMicroSec(
+    TimerInstance*    instance,   /**< Pointer to instance of timer to set period of */
+    unsigned long int numMicroSec /**< Number of microseconds to set period to */
+    );
+
+/**
+ * Sets the timer cycle time in ticks of the fastest clock source
+ *
+ * The clock source and compare matches are chosen as for
+ * SetTimerCycleTimeMilliSec(). If a slower clock source is chosen, the cycle
+ * is truncated to a whole number of its ticks, as reported by
+ * GetTimerCycleErrorTicks().
+ *
+ * \return Nonzero if the timer cycle time was set, zero otherwise
+ */
+unsigned int
+SetTimerCycleTimeTicks(
+    TimerInstance*    instance, /**< Pointer to instance of timer to set period of */
+    unsigned long int numTicks  /**< Number of ticks of the fastest clock source to set period to */
+    );
+
 /**
  * Sets the timer cycle time in seconds
  *
@@ -152,26 +618,341 @@ SetTimerCycleTimeSec(
     );
 
 /**
- * Provides the compare output mode for a given timer
+ * Makes the given hardware timer the monotonic clock read by GetTimerTicks64()
+ * and GetTimerMicroSec64(), and starts it from zero
+ *
+ * The timer runs off the slowest clock source that resolves a microsecond, or
+ * the fastest if none does, and wraps at its maximum value. That value is
+ * given to System_TimerSetCompareMatch() as a number of ticks, so each wrap is
+ * exactly System_TimerGetMaxValue() ticks long. Each wrap is
+ * counted by the compare match interrupt, so this puts the timer in
+ * TIMER_HANDLER_IMMEDIATE mode. This replaces the timer's cycle time, which
+ * must be set again before it is next started with StartTimer(). StopTimer()
+ * stops the clock.
+ *
+ * \note Interrupts must not be held off for longer than a wrap of the counter,
+ * or the clock falls behind
+ *
+ * \return Nonzero if the clock was started, zero otherwise
+ */
+unsigned int
+StartTimerClock(
+    TimerInstance*  instance  /**< Pointer to instance of timer to run the clock on */
+    );
+
+/**
+ * Provides the time since the monotonic clock started, in ticks of the fastest
+ * clock source
+ *
+ * This may be called from the main loop or from any interrupt that cannot
+ * interrupt the clock's own. A read that the clock's interrupt lands in the
+ * middle of is retried, so the time never goes backward.
+ *
+ * \return Number of ticks, or zero if the clock is not running
+ */
+unsigned long long int
+GetTimerTicks64();
+
+/**
+ * Provides the time since the monotonic clock started, in microseconds
+ *
+ * This may be called wherever GetTimerTicks64() may.
+ *
+ * \return Number of microseconds, or zero if the clock is not running
+ */
+unsigned long long int
+GetTimerMicroSec64();
+
+/**
+ * Provides whether the monotonic clock is running
+ *
+ * \return Nonzero if the clock is running, zero otherwise
+ */
+unsigned int
+IsTimerClockRunning();
+
+#if TIMER_NUM_DEADLINES > 0
+/**
+ * Makes the given hardware timer keep the one-shot deadlines added with
+ * AddTimerDeadline()
+ *
+ * The timer is tickless: it only interrupts when the earliest deadline is due,
+ * or when that is further off than the counter can reach. Each interval runs
+ * off the fastest clock source that can reach the deadline, so a far deadline
+ * may take a short extra interval at a faster clock source to land exactly.
+ * The timer stops while there are no deadlines. StopTimer() stops it for good
+ * and drops every deadline.
+ *
+ * \return Nonzero if the timer now keeps deadlines, zero otherwise
+ */
+unsigned int
+StartTimerDeadlines(
+    TimerInstance*  instance  /**< Pointer to instance of timer to keep deadlines with */
+    );
+
+/**
+ * Adds a deadline to call the given handler after the given time
+ *
+ * The handler is called from the deadline timer's interrupt, and may add and
+ * cancel deadlines itself. Deadlines due at the same time are handled in no
+ * particular order. A deadline is never handled early, but one added part way
+ * through an interval off a slower clock source may be up to one of its ticks
+ * late.
+ *
+ * \return Identifier of the deadline, or TIMER_DEADLINE_INVALID if it was not
+ * added
+ */
+unsigned int
+AddTimerDeadline(
+    TimerDeadlineHandler  handler,      /**< Function to call once the deadline is due */
+    void*                 context,      /**< Context to pass to the handler */
+    unsigned long int     numMicroSec   /**< Number of microseconds from now the deadline is due */
+    );
+
+/**
+ * Cancels a deadline that is not yet due
+ *
+ * \return Nonzero if the deadline was cancelled, zero otherwise
+ */
+unsigned int
+CancelTimerDeadline(
+    unsigned int  deadline  /**< Identifier of deadline to cancel */
+    );
+
+/**
+ * Provides the number of deadlines not yet due
+ */
+unsigned int
+GetNumTimerDeadlines();
+#endif
+
+#if TIMER_CAPTURE_BUFFER_SIZE > 0
+/**
+ * Starts timestamping edges on the given timer's input
+ *
+ * The timer runs off the fastest clock source and wraps at its maximum value,
+ * with each wrap counted as a cycle to extend the timestamps beyond the width
+ * of the counter. Timestamps are 64 bits wide, like GetTimerTicks64(), so they
+ * do not wrap while capturing. This replaces the timer's cycle time, which must be set
+ * again before it is next started with StartTimer(). Any timestamps not yet
+ * read are discarded. StopTimer() stops capturing.
+ *
+ * \note The timer's capture and compare match events must be dispatched as
+ * they occur, so this puts the timer in TIMER_HANDLER_IMMEDIATE mode. Only
+ * hardware timers with capture inputs can capture.
+ *
+ * \return Nonzero if capture was started, zero otherwise
+ */
+unsigned int
+StartTimerCapture(
+    TimerInstance*  instance, /**< Pointer to instance of timer to capture with */
+    unsigned int    edge      /**< Identifier of input edges to capture */
+    );
+
+/**
+ * Moves timestamps captured by the given timer into the given array, oldest
+ * first
+ *
+ * \return Number of timestamps moved
+ */
+unsigned int
+ReadTimerCaptures(
+    TimerInstance*  instance,     /**< Pointer to instance of timer to read captures of */
+    TimerCapture*   captures,     /**< Array to move timestamps into */
+    unsigned int    maxCaptures   /**< Number of timestamps the array can hold */
+    );
+
+/**
+ * Provides the number of timestamps waiting to be read from the given timer
+ */
+unsigned int
+GetNumTimerCaptures(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get number of captures of */
+    );
+
+/**
+ * Provides the number of timestamps the given timer dropped because its
+ * buffer was full
+ */
+unsigned int
+GetNumLostTimerCaptures(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get number of lost captures of */
+    );
+#endif
+
+/**
+ * Provides the compare output mode of one of a given timer's compare channels
  *
  * \return Identifier of compare output mode of given timer and output
  */
 unsigned int
 GetTimerCompareOutputMode(
     TimerInstance*  instance, /**< Pointer to instance of timer to get mode of */
-    unsigned int         output    /**< Identifier of output to get mode of */
+    unsigned int    output    /**< Identifier of output to get mode of */
     );
 
 /**
- * Sets the compare output mode of a timer
+ * Sets the compare output mode of one of a timer's compare channels
+ *
+ * The outputs a timer offers are enumerated by System_TimerCompareOutput. The
+ * first changes level at the compare match ending each period, and the others
+ * at their own compare values (see SetTimerChannelCompareMatch()).
+ *
+ * \note The other channels drive the PWM output of a timer in a PWM mode, so
+ * only the first channel can be set then
  *
  * \return Nonzero if the timer output mode was set, zero otherwise
  */
 unsigned int
 SetTimerCompareOutputMode(
     TimerInstance*  instance, /**< Pointer to instance of timer to set mode of */
-    unsigned int         output,   /**< Identifier of output to set mode of */
-    unsigned int         mode      /**< Identifier of compare output mode to set to */
+    unsigned int    output,   /**< Identifier of output to set mode of */
+    unsigned int    mode      /**< Identifier of compare output mode to set to */
+    );
+
+/**
+ * Provides the compare value of one of a given timer's other compare channels
+ *
+ * \return Number of clock source ticks into each compare match period the
+ * channel matches at, or zero if it does not match
+ */
+unsigned int
+GetTimerChannelCompareMatch(
+    TimerInstance*  instance, /**< Pointer to instance of timer to get channel compare value of */
+    unsigned int    output    /**< Identifier of channel's output, other than the first */
+    );
+
+/**
+ * Sets the compare value of one of a given timer's other compare channels
+ *
+ * The channel matches the given number of clock source ticks into each period
+ * between the timer's compare matches, sharing the timer's counter, so it
+ * gives a second event stream at a fixed phase from the first. Timers with
+ * several compare matches per cycle match the channel once per compare match.
+ * The value must be less than the timer's compare match values, and zero
+ * stops the channel matching. A cycle time set afterwards that shortens the
+ * period past the value also stops it matching.
+ *
+ * \note The first channel's value is the timer's compare match, so is set
+ * through its cycle time. Timers in a PWM mode use the other channels for
+ * their PWM output, so they cannot be set then.
+ *
+ * \return Nonzero if the compare value was set, zero otherwise
+ */
+unsigned int
+SetTimerChannelCompareMatch(
+    TimerInstance*  instance,     /**< Pointer to instance of timer to set channel compare value of */
+    unsigned int    output,       /**< Identifier of channel's output, other than the first */
+    unsigned int    compareMatch  /**< Number of ticks into each period to match at, or zero to stop matching */
+    );
+
+/**
+ * Provides the handler called when one of a given timer's other compare
+ * channels matches, if any
+ */
+TimerChannelHandler
+GetTimerChannelHandler(
+    TimerInstance*  instance, /**< Pointer to instance of timer to get channel handler of */
+    unsigned int    output    /**< Identifier of channel's output, other than the first */
+    );
+
+/**
+ * Provides the context passed to the handler of one of a given timer's other
+ * compare channels
+ */
+void*
+GetTimerChannelHandlerContext(
+    TimerInstance*  instance, /**< Pointer to instance of timer to get channel handler context of */
+    unsigned int    output    /**< Identifier of channel's output, other than the first */
+    );
+
+/**
+ * Sets the handler to call each time one of a given timer's other compare
+ * channels matches, or NULL for none
+ *
+ * Channel handlers run in the timer's handler mode, as its cycle handler
+ * does.
+ *
+ * \return Nonzero if the channel handler was set, zero otherwise
+ */
+unsigned int
+SetTimerChannelHandler(
+    TimerInstance*      instance, /**< Pointer to instance of timer to set channel handler of */
+    unsigned int        output,   /**< Identifier of channel's output, other than the first */
+    TimerChannelHandler handler,  /**< Function to call on each match of the channel */
+    void*               context   /**< Context to pass to the handler */
+    );
+
+/**
+ * Provides the PWM waveform the given timer generates
+ */
+TimerPwmMode
+GetTimerPwmMode(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get PWM mode of */
+    );
+
+/**
+ * Sets the PWM waveform the given timer generates on its PWM output
+ *
+ * This clears the timer's cycle time, so SetTimerPwmFrequency() must be called
+ * before the timer is started again. PWM modes take over the timer's other
+ * compare channels, so none may have a compare value set. A PWM timer puts
+ * the timer in TIMER_HANDLER_IMMEDIATE mode so that duty cycle updates land on
+ * the period boundary.
+ *
+ * \note Only stopped hardware timers can have their PWM mode set
+ *
+ * \return Nonzero if the PWM mode was set, zero otherwise
+ */
+unsigned int
+SetTimerPwmMode(
+    TimerInstance*  instance, /**< Pointer to instance of timer to set PWM mode of */
+    TimerPwmMode    mode      /**< PWM waveform to generate */
+    );
+
+/**
+ * Sets the frequency of the given timer's PWM output
+ *
+ * The clock source and compare match are chosen by the timer's solver mode, as
+ * for SetTimerCycleTimeMilliSec(), but each PWM period must fit in a single
+ * compare match. The period is reported by GetTimerCycleTicks() and
+ * GetTimerCycleErrorTicks(). The duty cycle is kept. While the timer runs,
+ * the new period takes over at the end of the current one.
+ *
+ * \return Nonzero if the PWM frequency was set, zero otherwise
+ */
+unsigned int
+SetTimerPwmFrequency(
+    TimerInstance*    instance,   /**< Pointer to instance of timer to set PWM frequency of */
+    unsigned long int frequencyHz /**< Number of PWM periods per second */
+    );
+
+/**
+ * Provides the duty cycle of the given timer's PWM output, in hundredths of a
+ * percent
+ */
+unsigned int
+GetTimerPwmDutyCycle(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get duty cycle of */
+    );
+
+/**
+ * Sets the duty cycle of the given timer's PWM output, in hundredths of a
+ * percent
+ *
+ * While the timer runs, the new duty cycle takes effect at the end of the
+ * current period. With TIMER_HANDLER_DEFERRED it is only written once
+ * ProcessTimerEvents() handles that compare match, so the period it is written
+ * in may still see the old duty cycle or a glitch. The compare match
+ * interrupt of a PWM timer is only enabled while such an update is waiting or
+ * a cycle handler is set, so cycles are only counted then.
+ *
+ * \return Nonzero if the duty cycle was set, zero otherwise
+ */
+unsigned int
+SetTimerPwmDutyCycle(
+    TimerInstance*  instance,   /**< Pointer to instance of timer to set duty cycle of */
+    unsigned int    dutyCycle   /**< Duty cycle up to TIMER_PWM_DUTY_CYCLE_MAX */
     );
 
 /**
@@ -202,6 +983,8 @@ GetTimerCycleHandler(
 
 /**
  * Sets the given timer's cycle completion handler
+ *
+ * This replaces any handler set with SetTimerCycleHandlerEx().
  */
 unsigned int
 SetTimerCycleHandler(
@@ -209,6 +992,153 @@ SetTimerCycleHandler(
     TimerCycleHandler handler   /**< Handler call on each cycle completion */
     );
 
+/**
+ * Provides the given timer's cycle completion handler taking a context
+ */
+TimerCycleHandlerEx
+GetTimerCycleHandlerEx(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get cycle handler for */
+    );
+
+/**
+ * Provides the context passed to the given timer's cycle completion handler
+ */
+void*
+GetTimerCycleHandlerContext(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get cycle handler context for */
+    );
+
+/**
+ * Sets the given timer's cycle completion handler, to be called with the
+ * timer and the given context
+ *
+ * This lets one handler serve many timers. It replaces any handler set with
+ * SetTimerCycleHandler().
+ */
+unsigned int
+SetTimerCycleHandlerEx(
+    TimerInstance*      instance, /**< Pointer to instance of timer to set cycle handler for */
+    TimerCycleHandlerEx handler,  /**< Handler call on each cycle completion */
+    void*               context   /**< Context to pass to the handler */
+    );
+
+/**
+ * Provides the context the given timer's cycle handler runs in
+ */
+TimerHandlerMode
+GetTimerHandlerMode(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get handler mode of */
+    );
+
+/**
+ * Sets the context the given timer's cycle handler runs in
+ *
+ * Deferred is the default. Immediate mode gives the handler a fixed, minimal
+ * latency, at the cost of running it with interrupts held off, so it must be
+ * short and may only call the functions listed as safe in interrupt context at
+ * the top of this file.
+ *
+ * \note Virtual timers share an interrupt, so they only support deferred mode
+ *
+ * \return Nonzero if the handler mode was set, zero otherwise
+ */
+unsigned int
+SetTimerHandlerMode(
+    TimerInstance*    instance, /**< Pointer to instance of timer to set handler mode of */
+    TimerHandlerMode  mode      /**< Context to run the cycle handler in */
+    );
+
+/**
+ * Provides how the given timer catches up on missed cycles
+ */
+TimerCatchUpPolicy
+GetTimerCatchUpPolicy(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get catch-up policy of */
+    );
+
+/**
+ * Sets how the given timer catches up on missed cycles
+ *
+ * A cycle is missed when the compare match events that make it up are dropped
+ * or merged before they reach the driver, because the main loop or a handler
+ * ran for longer than the timer's sub-cycle. Skipping is the default, and
+ * leaves the cycle handler called only for cycles seen to complete. In every
+ * policy, missed cycles are still counted by GetNumTimerCycles().
+ *
+ * \note Only hardware timers detect missed compare matches
+ *
+ * \return Nonzero if the policy was set, zero otherwise
+ */
+unsigned int
+SetTimerCatchUpPolicy(
+    TimerInstance*      instance, /**< Pointer to instance of timer to set catch-up policy of */
+    TimerCatchUpPolicy  policy    /**< How to catch up on missed cycles */
+    );
+
+/**
+ * Provides the number of cycles the given timer has missed in total
+ */
+unsigned int
+GetTimerNumMissedCycles(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get number of missed cycles of */
+    );
+
+/**
+ * Provides the number of cycles the given timer missed just before the cycle
+ * it last completed
+ *
+ * This is meant to be called from a cycle handler, which in
+ * TIMER_CATCHUP_COALESCE mode is called once for the completed cycle and
+ * all those missed before it.
+ */
+unsigned int
+GetTimerLastMissedCycles(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get last number of missed cycles of */
+    );
+
+/**
+ * Provides the number of times the given timer's compare match arrived again
+ * before the last one was done with
+ *
+ * An overrun is not necessarily a miss, since the hardware holds one compare
+ * match while the last is handled, but it means the timer's handling is not
+ * keeping up with its cycle time.
+ */
+unsigned int
+GetTimerNumOverruns(
+    TimerInstance*  instance  /**< Pointer to instance of timer to get number of overruns of */
+    );
+
+#if TIMER_LATENCY_STATS
+/**
+ * Provides the given timer's cycle handler latency statistics
+ *
+ * \note A deferred handler held up by more than a sub-cycle is recorded
+ * modulo the sub-cycle, since the counter has wrapped by the time it runs.
+ * Interrupts are briefly disabled to take a consistent copy, so this must be
+ * called with interrupts enabled, and never from interrupt context, where it
+ * would let other interrupts nest.
+ *
+ * \return Nonzero if the statistics were copied, zero otherwise
+ */
+unsigned int
+GetTimerLatencyStats(
+    TimerInstance*      instance, /**< Pointer to instance of timer to get latency statistics of */
+    TimerLatencyStats*  stats     /**< Statistics to copy into */
+    );
+
+/**
+ * Clears the given timer's cycle handler latency statistics
+ *
+ * \note Interrupts are briefly disabled to clear the statistics, so this must
+ * be called with interrupts enabled, and never from interrupt context
+ */
+void
+ResetTimerLatencyStats(
+    TimerInstance*  instance  /**< Pointer to instance of timer to clear latency statistics of */
+    );
+#endif
+
 /**
  * Blocks until timer has finished a single cycle
  *
@@ -216,6 +1146,10 @@ SetTimerCycleHandler(
  * the timer has not yet been configured, this function will return a nonzero
  * value.
  *
+ * \note Posted and pending events are processed with ProcessTimerEvents()
+ * while waiting, so that a deferred compare match can complete the cycle.
+ * This must therefore be called from the main loop, not from an event handler.
+ *
  * \returns Nonzero if timer has finished, zero otherwise
  */
 unsigned int
@@ -0,0 +1,154 @@
+#ifndef TIMER_EVENTS
+#define TIMER_EVENTS
+
+/**
+ * \file TimerEvents.h
+ *
+ * Specification file for the timer event queue
+ *
+ * Interrupt service routines post system events to the queue, and the main
+ * loop dispatches them to the callbacks registered with the system. There is
+ * a single producer (interrupt context) and a single consumer (main loop), so
+ * no locking is needed on either side.
+ *
+ * Events that only need handling once however often they occur can instead
+ * be flagged as pending, which costs a single bit each and is dispatched
+ * without looking at events that are not pending.
+ *
+ * Events marked as immediate skip both, and have their callback called
+ * straight from the interrupt service routine that posts or flags them.
+ *
+ * Events dropped from a full queue or flagged again while still pending are
+ * counted against the event, so that whoever handles it can tell how many
+ * occurrences it missed.
+ *
+ * Only PostTimerEvent() and SetTimerEventPending() may be called from
+ * interrupt context. All others must be called from the main loop.
+ */
+
+#ifndef TIMER_EVENT_QUEUE_SIZE
+/**
+ * Maximum number of events waiting to be dispatched
+ *
+ * This must be a power of two no larger than 128.
+ */
+#define TIMER_EVENT_QUEUE_SIZE 8
+#endif
+
+/**
+ * Empties the event queue and clears its statistics
+ *
+ * \note This must not be called while events may be posted
+ */
+void
+InitTimerEvents();
+
+/**
+ * Adds an event to the back of the queue
+ *
+ * This is meant to be called from the interrupt service routine of the event.
+ * If the queue is full, the event is dropped and counted as lost, and as
+ * missed against the event. Immediate
+ * events are dispatched straight away instead.
+ *
+ * \return Nonzero if the event was queued, zero otherwise
+ */
+unsigned int
+PostTimerEvent(
+    unsigned int  event /**< Identifier of system event that occurred */
+    );
+
+/**
+ * Calls the registered callback of each event waiting in the queue, in the
+ * order they were posted
+ *
+ * Events posted while dispatching are left for the next call.
+ *
+ * \return Number of events dispatched
+ */
+unsigned int
+DispatchTimerEvents();
+
+/**
+ * Flags an event as pending
+ *
+ * This is meant to be called from the interrupt service routine of the event.
+ * An event flagged again before it is dispatched is only dispatched once, and
+ * the repeat is counted as missed against the event. Immediate events are dispatched straight away instead.
+ */
+void
+SetTimerEventPending(
+    unsigned int  event /**< Identifier of system event that occurred */
+    );
+
+/**
+ * Calls the registered callback of each pending event, in order of event
+ * identifier, then dispatches the event queue
+ *
+ * This returns straight away if nothing is pending or queued, so it can be
+ * called on every pass of the main loop.
+ *
+ * \note Interrupts are briefly disabled to take the pending events, so this
+ * must be called with interrupts enabled
+ *
+ * \return Number of events dispatched
+ */
+unsigned int
+ProcessTimerEvents();
+
+/**
+ * Sets whether an event is dispatched as soon as it is posted or flagged,
+ * rather than from the main loop
+ *
+ * \note The event's interrupt must be disabled while this is changed
+ */
+void
+SetTimerEventImmediate(
+    unsigned int  event,      /**< Identifier of system event to set dispatch of */
+    unsigned int  isImmediate /**< Nonzero to dispatch from interrupt context */
+    );
+
+/**
+ * Provides whether an event is dispatched as soon as it is posted or flagged
+ *
+ * \return Nonzero if the event is dispatched from interrupt context, zero
+ * otherwise
+ */
+unsigned int
+GetTimerEventImmediate(
+    unsigned int  event /**< Identifier of system event to get dispatch of */
+    );
+
+/**
+ * Provides the number of events waiting to be dispatched
+ */
+unsigned int
+GetNumQueuedTimerEvents();
+
+/**
+ * Provides the largest number of events that have waited to be dispatched at
+ * once
+ */
+unsigned int
+GetMaxQueuedTimerEvents();
+
+/**
+ * Provides the number of events dropped because the queue was full
+ */
+unsigned int
+GetNumLostTimerEvents();
+
+/**
+ * Provides the number of times the given event has been missed since this was
+ * last called for it, and starts counting again from zero
+ *
+ * \note The count wraps after 255 misses
+ *
+ * \return Number of times the event was dropped or merged
+ */
+unsigned int
+TakeNumMissedTimerEvents(
+    unsigned int  event /**< Identifier of system event to take missed count of */
+    );
+
+#endif /* TIMER_EVENTS */
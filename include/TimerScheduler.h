@@ -0,0 +1,146 @@
+#ifndef TIMER_SCHEDULER
+#define TIMER_SCHEDULER
+
+#include "TimerDriver.h"
+
+/**
+ * \file TimerScheduler.h
+ *
+ * Specification file for the cooperative periodic task scheduler
+ *
+ * Tasks are run from the main loop, each every given number of ticks of a
+ * single timer. The timer's cycle handler counts the ticks, so it runs in
+ * TIMER_HANDLER_DEFERRED mode and the main loop must call ProcessTimerEvents()
+ * before RunTimerTasks():
+ *
+ *     for (;;)
+ *     {
+ *       ProcessTimerEvents();
+ *       RunTimerTasks();
+ *     }
+ *
+ * Tasks run to completion, one after another, highest priority first. A task
+ * that falls a whole period or more behind skips the periods it missed rather
+ * than running several times in a row.
+ *
+ * All functions must be called from the main loop.
+ */
+
+#ifndef TIMER_SCHEDULER_MAX_TASKS
+/**
+ * Number of tasks the scheduler can hold at once
+ *
+ * This must be no larger than 255.
+ */
+#define TIMER_SCHEDULER_MAX_TASKS 8
+#endif
+
+/**
+ * Task identifier returned when a task could not be added
+ */
+#define TIMER_TASK_INVALID (TIMER_SCHEDULER_MAX_TASKS)
+
+/**
+ * Longest run reported for a task no run of which has been measured
+ */
+#define TIMER_TASK_UNMEASURED (~0ULL)
+
+/**
+ * Typedef for task functions
+ */
+typedef void (*TimerTaskFunction)(void* context);
+
+/**
+ * Run statistics of a task
+ */
+typedef struct TimerTaskStats_struct
+{
+  unsigned long int       numRuns;        /**< Number of times the task has run */
+  unsigned long int       numSkipped;     /**< Number of periods skipped because the task fell behind */
+  unsigned long long int  maxRunTicks;    /**< Longest run measured, in ticks of the fastest clock source, or TIMER_TASK_UNMEASURED if none was */
+} TimerTaskStats;
+
+/**
+ * Removes every task and stops the scheduler
+ */
+void
+InitTimerScheduler();
+
+/**
+ * Starts counting scheduler ticks off the given timer
+ *
+ * Each cycle of the timer is a tick, so its cycle time must already be set.
+ * This replaces the timer's cycle handler and catch-up policy, and starts it.
+ * Tasks keep their place in their periods across a stop and start.
+ *
+ * \return Nonzero if the scheduler was started, zero otherwise
+ */
+unsigned int
+StartTimerScheduler(
+    TimerInstance*  tickTimer /**< Pointer to instance of timer to tick off */
+    );
+
+/**
+ * Stops the scheduler's timer, so no more ticks are counted
+ */
+void
+StopTimerScheduler();
+
+/**
+ * Provides the number of ticks counted since the scheduler was initialized
+ */
+unsigned long int
+GetTimerSchedulerTicks();
+
+/**
+ * Adds a task to run every given number of ticks
+ *
+ * The task first runs the given number of ticks from now. Among tasks due at
+ * once, those with a higher priority run first, and those with the same
+ * priority run in the order they were added.
+ *
+ * \return Identifier of the task, or TIMER_TASK_INVALID if it was not added
+ */
+unsigned int
+AddTimerTask(
+    TimerTaskFunction function, /**< Function to run */
+    void*             context,  /**< Context to pass to the function */
+    unsigned long int period,   /**< Number of ticks between runs */
+    unsigned long int phase,    /**< Number of ticks until the first run */
+    unsigned char     priority  /**< Priority over other tasks due at once */
+    );
+
+/**
+ * Removes a task, which may be the one running
+ *
+ * \return Nonzero if the task was removed, zero otherwise
+ */
+unsigned int
+RemoveTimerTask(
+    unsigned int  task  /**< Identifier of task to remove */
+    );
+
+/**
+ * Runs every task that is due, highest priority first
+ *
+ * Run times are measured off the monotonic clock, so a second hardware timer
+ * must be running it (see StartTimerClock()) besides the scheduler's own. A
+ * run the clock is not running throughout is not measured.
+ *
+ * \return Number of tasks run
+ */
+unsigned int
+RunTimerTasks();
+
+/**
+ * Provides the run statistics of a task
+ *
+ * \return Nonzero if the statistics were provided, zero otherwise
+ */
+unsigned int
+GetTimerTaskStats(
+    unsigned int    task,   /**< Identifier of task to get statistics of */
+    TimerTaskStats* stats   /**< Statistics to fill in */
+    );
+
+#endif /* TIMER_SCHEDULER */
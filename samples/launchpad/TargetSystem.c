@@ -3,6 +3,61 @@
 
 static void (*callbacks [SYSTEM_NUM_EVENTS])(System_EventType) = {NULL};
 
+unsigned int system_compareValues [SYSTEM_NUM_TIMERS] = {0};
+
+const System_TimerDescriptor system_timers [SYSTEM_NUM_TIMERS] =
+{
+  [SYSTEM_TIMER0] =
+  {
+    &TA0CTL,
+    &TA0R,
+    { &TA0CCTL0, &TA0CCTL1, &TA0CCTL2 },
+    { &TA0CCR0, &TA0CCR1, &TA0CCR2 },
+    { SYSTEM_EVENT_TIMER0_COMPAREMATCH, SYSTEM_EVENT_TIMER0_CAPTURE, SYSTEM_EVENT_TIMER0_COMPAREMATCH_2 }
+  },
+  [SYSTEM_TIMER1] =
+  {
+    &TA1CTL,
+    &TA1R,
+    { &TA1CCTL0, &TA1CCTL1, &TA1CCTL2 },
+    { &TA1CCR0, &TA1CCR1, &TA1CCR2 },
+    { SYSTEM_EVENT_TIMER1_COMPAREMATCH, SYSTEM_EVENT_TIMER1_CAPTURE, SYSTEM_EVENT_TIMER1_COMPAREMATCH_2 }
+  }
+};
+
+const System_EventSource system_eventSources [SYSTEM_NUM_EVENTS] =
+{
+  [SYSTEM_EVENT_TIMER0_COMPAREMATCH]    = { SYSTEM_TIMER0, SYSTEM_TIMER_BLOCK_PERIOD },
+  [SYSTEM_EVENT_TIMER1_COMPAREMATCH]    = { SYSTEM_TIMER1, SYSTEM_TIMER_BLOCK_PERIOD },
+  [SYSTEM_EVENT_TIMER0_CAPTURE]         = { SYSTEM_TIMER0, SYSTEM_TIMER_BLOCK_CAPTURE },
+  [SYSTEM_EVENT_TIMER1_CAPTURE]         = { SYSTEM_TIMER1, SYSTEM_TIMER_BLOCK_CAPTURE },
+  [SYSTEM_EVENT_TIMER0_COMPAREMATCH_2]  = { SYSTEM_TIMER0, SYSTEM_TIMER_BLOCK_CHANNEL },
+  [SYSTEM_EVENT_TIMER1_COMPAREMATCH_2]  = { SYSTEM_TIMER1, SYSTEM_TIMER_BLOCK_CHANNEL }
+};
+
+const unsigned int system_clockSourceDividers [NUM_TIMER_CLKSOURCES] =
+{
+  [SYSTEM_TIMER_CLKSOURCE_SUB]      = 0,
+  [SYSTEM_TIMER_CLKSOURCE_SUB_PRE2] = (ID0),
+  [SYSTEM_TIMER_CLKSOURCE_SUB_PRE4] = (ID1),
+  [SYSTEM_TIMER_CLKSOURCE_SUB_PRE8] = (ID1) | (ID0),
+  [SYSTEM_TIMER_CLKSOURCE_OFF]      = 0
+};
+
+const unsigned int system_outputModes [SYSTEM_NUM_TIMER_OUTPUT_MODES] =
+{
+  [SYSTEM_TIMER_OUTPUT_MODE_NONE]   = 0,
+  [SYSTEM_TIMER_OUTPUT_MODE_SET]    = (OUTMOD_1),
+  [SYSTEM_TIMER_OUTPUT_MODE_CLEAR]  = (OUTMOD_5),
+  [SYSTEM_TIMER_OUTPUT_MODE_TOGGLE] = (OUTMOD_4)
+};
+
+const System_TimerBlock system_outputBlocks [SYSTEM_NUM_TIMER_OUTPUTS] =
+{
+  [SYSTEM_TIMER_OUTPUT_0] = SYSTEM_TIMER_BLOCK_PERIOD,
+  [SYSTEM_TIMER_OUTPUT_2] = SYSTEM_TIMER_BLOCK_CHANNEL
+};
+
 
 void
 System_RegisterCallback(
@@ -8,6 +8,14 @@
 #define TRUE 1
 #define FALSE 0
 
+/**
+ * Attribute placing a constant table where System_ReadTableValue() reads it
+ *
+ * \note Constants are already kept in flash, which shares the address space
+ * with RAM
+ */
+#define SYSTEM_TABLE_MEMORY
+
 #define SYSTEM_SUB_CLOCK_FREQUENCY 1048578 // Subsystem clock
 
 /**
@@ -41,7 +49,9 @@ typedef enum System_TimerClockSource_enum
  */
 typedef enum System_TimerCompareOutput_enum
 {
-  SYSTEM_TIMER_OUTPUT_0
+  SYSTEM_TIMER_OUTPUT_0,    /**< TAx.0, matching on TAxCCR0 */
+  SYSTEM_TIMER_OUTPUT_2,    /**< TAx.2, matching on TAxCCR2, as TAxCCR1 serves PWM and input capture */
+  SYSTEM_NUM_TIMER_OUTPUTS
 } System_TimerCompareOutput;
 
 /**
@@ -49,9 +59,22 @@ typedef enum System_TimerCompareOutput_enum
  */
 typedef enum System_TimerWaveGenMode_enum
 {
-  SYSTEM_TIMER_WAVEGEN_MODE_CTC /**< Clear timer on compare-match */
+  SYSTEM_TIMER_WAVEGEN_MODE_CTC,               /**< Clear timer on compare-match */
+  SYSTEM_TIMER_WAVEGEN_MODE_FAST_PWM,          /**< Count up to the compare-match value, with the PWM output high below the PWM compare value */
+  SYSTEM_TIMER_WAVEGEN_MODE_PHASE_CORRECT_PWM  /**< Count up to the compare-match value and back down, with the PWM output high below the PWM compare value */
 } System_TimerWaveGenMode;
 
+/**
+ * Enumeration of timer input capture edges
+ */
+typedef enum System_TimerCaptureEdge_enum
+{
+  SYSTEM_TIMER_CAPTURE_NONE,    /**< Input capture disabled */
+  SYSTEM_TIMER_CAPTURE_RISING,
+  SYSTEM_TIMER_CAPTURE_FALLING,
+  SYSTEM_TIMER_CAPTURE_BOTH
+} System_TimerCaptureEdge;
+
 /**
  * Enumeration of timer compare output modes
  */
@@ -60,7 +83,8 @@ typedef enum System_TimerCompareOutputMode_enum
   SYSTEM_TIMER_OUTPUT_MODE_NONE,   /**< Outputs disconnected */
   SYSTEM_TIMER_OUTPUT_MODE_SET,
   SYSTEM_TIMER_OUTPUT_MODE_CLEAR,
-  SYSTEM_TIMER_OUTPUT_MODE_TOGGLE
+  SYSTEM_TIMER_OUTPUT_MODE_TOGGLE,
+  SYSTEM_NUM_TIMER_OUTPUT_MODES
 } System_TimerCompareOutputMode;
 
 /**
@@ -70,6 +94,10 @@ typedef enum System_EventType_enum
 {
   SYSTEM_EVENT_TIMER0_COMPAREMATCH,
   SYSTEM_EVENT_TIMER1_COMPAREMATCH,
+  SYSTEM_EVENT_TIMER0_CAPTURE,
+  SYSTEM_EVENT_TIMER1_CAPTURE,
+  SYSTEM_EVENT_TIMER0_COMPAREMATCH_2,
+  SYSTEM_EVENT_TIMER1_COMPAREMATCH_2,
   SYSTEM_NUM_EVENTS,
   SYSTEM_EVENT_INVALID
 } System_EventType;
@@ -79,6 +107,73 @@ typedef enum System_EventType_enum
  */
 typedef void (*System_EventCallback)(System_EventType);
 
+/**
+ * Enumeration of the capture/compare blocks of a timer used by the driver
+ */
+typedef enum System_TimerBlock_enum
+{
+  SYSTEM_TIMER_BLOCK_PERIOD,    /**< Block 0, matching at the end of each period */
+  SYSTEM_TIMER_BLOCK_CAPTURE,   /**< Block 1, for input capture and the PWM output */
+  SYSTEM_TIMER_BLOCK_CHANNEL,   /**< Block 2, for the other compare channel */
+  SYSTEM_NUM_TIMER_BLOCKS
+} System_TimerBlock;
+
+/**
+ * Registers and events of a Timer_A module
+ *
+ * Every operation on a timer looks its registers up here rather than
+ * switching on the timer, so another Timer_A module only needs its own entry
+ * in system_timers, along with its events.
+ */
+typedef struct System_TimerDescriptor_struct
+{
+  volatile unsigned int*  TAxCTL;                             /**< Control register */
+  volatile unsigned int*  TAxR;                               /**< Counter register */
+  volatile unsigned int*  TAxCCTL [SYSTEM_NUM_TIMER_BLOCKS];  /**< Capture/compare control register of each block */
+  volatile unsigned int*  TAxCCR [SYSTEM_NUM_TIMER_BLOCKS];   /**< Capture/compare register of each block */
+  System_EventType        events [SYSTEM_NUM_TIMER_BLOCKS];   /**< Interrupt event of each block */
+} System_TimerDescriptor;
+
+/**
+ * Capture/compare block raising a system event
+ */
+typedef struct System_EventSource_struct
+{
+  System_TimerID    timer;  /**< Timer raising the event */
+  System_TimerBlock block;  /**< Block of the timer raising the event */
+} System_EventSource;
+
+/**
+ * Registers and events of each timer, indexed by timer
+ */
+extern const System_TimerDescriptor system_timers [SYSTEM_NUM_TIMERS];
+
+/**
+ * Block raising each event, indexed by event
+ */
+extern const System_EventSource system_eventSources [SYSTEM_NUM_EVENTS];
+
+/**
+ * Input divider bits of TAxCTL for each clock source, indexed by clock source
+ */
+extern const unsigned int system_clockSourceDividers [NUM_TIMER_CLKSOURCES];
+
+/**
+ * OUTMOD bits of TAxCCTLn for each compare output mode, indexed by mode
+ */
+extern const unsigned int system_outputModes [SYSTEM_NUM_TIMER_OUTPUT_MODES];
+
+/**
+ * Block driving each compare output, indexed by output
+ */
+extern const System_TimerBlock system_outputBlocks [SYSTEM_NUM_TIMER_OUTPUTS];
+
+/**
+ * Compare match value last set for each timer, in ticks between compare
+ * matches, indexed by timer
+ */
+extern unsigned int system_compareValues [SYSTEM_NUM_TIMERS];
+
 /**
  * Provides the frequency in Hz for a given clock source
  *
@@ -125,116 +220,274 @@ System_TimerSetClockSource(
     System_TimerClockSource clockSource
     )
 {
-  // Initialize copy of timer control register
-  unsigned int TACTL_copy = 0;
-
-  switch (clockSource)
+  if (
+      (timer >= SYSTEM_NUM_TIMERS) ||
+      (clockSource >= NUM_TIMER_CLKSOURCES)
+     )
   {
-    case SYSTEM_TIMER_CLKSOURCE_SUB:
-      break;
+    return FALSE;
+  }
 
-    case SYSTEM_TIMER_CLKSOURCE_SUB_PRE2:
-      TACTL_copy |= (ID0);
-      break;
+  volatile unsigned int* TAxCTL = system_timers[timer].TAxCTL;
 
-    case SYSTEM_TIMER_CLKSOURCE_SUB_PRE4:
-      TACTL_copy |= (ID1);
-      break;
+  // Stop timer when configuring clock source
+  unsigned int TACTL_MC_copy = *TAxCTL & ((MC1) | (MC0));
+  *TAxCTL &= ~((MC1) | (MC0));
 
-    case SYSTEM_TIMER_CLKSOURCE_SUB_PRE8:
-      TACTL_copy |= (ID1) | (ID0);
-      break;
+  // Run off submaster clock
+  *TAxCTL &= ~((TASSEL1) | (TASSEL0));
+  *TAxCTL |= (TASSEL1);
 
-    case SYSTEM_TIMER_CLKSOURCE_OFF:
-      break;
+  // Set input clock frequency divider
+  *TAxCTL &= ~((ID1) | (ID0));
+  *TAxCTL |= system_clockSourceDividers[clockSource];
 
-    default:
-      return FALSE;
-      break;
-  };
+  // Reset divider logic
+  *TAxCTL |= TACLR;
 
-  unsigned int TACTL_MC_copy = 0;
-  switch (timer)
+  // Restart timer
+  *TAxCTL |= TACTL_MC_copy;
+
+  return TRUE;
+}
+
+/**
+ * Writes TAxCCR0 so that the counter counts the timer's compare match value
+ * in ticks from one compare match to the next
+ *
+ * In up mode the counter returns to zero on the tick after it reaches
+ * TAxCCR0, so counts one tick more than TAxCCR0. In up/down mode it turns
+ * back down at TAxCCR0 instead.
+ */
+static inline void
+System_TimerWriteCompareMatch(
+    System_TimerID  timer
+    )
+{
+  const System_TimerDescriptor* descriptor = &system_timers[timer];
+  unsigned int compareValue = system_compareValues[timer];
+
+  if (
+      (compareValue != 0) &&
+      ((*descriptor->TAxCTL & ((MC1) | (MC0))) != ((MC1) | (MC0)))
+     )
+  {
+    compareValue--;
+  }
+
+  *descriptor->TAxCCR[SYSTEM_TIMER_BLOCK_PERIOD] = compareValue;
+}
+
+/**
+ * Sets the timer compare match value
+ *
+ * The value is the number of ticks from one compare match to the next, as
+ * counted up from zero.
+ *
+ * \return Nonzero if configuration was successful, zero otherwise
+ */
+static inline unsigned int
+System_TimerSetCompareMatch(
+    System_TimerID  timer,
+    unsigned int    compareValue
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
   {
-    case SYSTEM_TIMER0:
-      // Stop timer when configuring clock source
-      TACTL_MC_copy = TA0CTL & ((MC1) | (MC0));
-      TA0CTL &= ~((MC1) | (MC0));
+    return FALSE;
+  }
 
-      // Run off submaster clock
-      TA0CTL &= ~((TASSEL1) | (TASSEL0));
-      TA0CTL |= (TASSEL1);
+  system_compareValues[timer] = compareValue;
+  System_TimerWriteCompareMatch(timer);
+  *system_timers[timer].TAxCCTL[SYSTEM_TIMER_BLOCK_PERIOD] &= ~(CAP);
 
-      // Set input clock frequency divider
-      TA0CTL &= ~((ID1) | (ID0));
-      TA0CTL |= TACTL_copy;
+  return TRUE;
+}
 
-      // Reset divider logic
-      TA0CTL |= TACLR;
+/**
+ * Sets the value a timer's PWM output changes level at
+ *
+ * \return Nonzero if configuration was successful, zero otherwise
+ */
+static inline unsigned int
+System_TimerSetPwmCompareMatch(
+    System_TimerID  timer,
+    unsigned int    compareValue
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
+  {
+    return FALSE;
+  }
 
-      // Restart timer
-      TA0CTL |= TACTL_MC_copy;
-      break;
+  *system_timers[timer].TAxCCR[SYSTEM_TIMER_BLOCK_CAPTURE] = compareValue;
 
-    case SYSTEM_TIMER1:
-      // Stop timer when configuring clock source
-      TACTL_MC_copy = TA1CTL & ((MC1) | (MC0));
-      TA1CTL &= ~((MC1) | (MC0));
+  return TRUE;
+}
 
-      // Run off submaster clock
-      TA1CTL &= ~((TASSEL1) | (TASSEL0));
-      TA1CTL |= (TASSEL1);
+/**
+ * Provides the current counter value of a timer
+ *
+ * \return Number of clock source ticks since the timer last matched or was
+ * started
+ */
+static inline unsigned int
+System_TimerGetCount(
+    System_TimerID  timer
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
+  {
+    return 0;
+  }
 
-      // Set input clock frequency divider
-      TA1CTL &= ~((ID1) | (ID0));
-      TA1CTL |= TACTL_copy;
+  return *system_timers[timer].TAxR;
+}
 
-      // Reset divider logic
-      TA1CTL |= TACLR;
+/**
+ * Provides whether a timer's compare match interrupt is waiting to be serviced
+ *
+ * \return Nonzero if the timer has matched since its interrupt was last
+ * serviced, zero otherwise
+ */
+static inline unsigned int
+System_TimerGetCompareMatchPending(
+    System_TimerID  timer
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
+  {
+    return FALSE;
+  }
 
-      // Restart timer
-      TA1CTL |= TACTL_MC_copy;
-      break;
+  return ((*system_timers[timer].TAxCCTL[SYSTEM_TIMER_BLOCK_PERIOD] & CCIFG) != 0) ? TRUE : FALSE;
+}
 
-    default:
-      return FALSE;
-      break;
-  };
+/**
+ * Clears a timer's counter, the clock source ticks counted toward its next
+ * tick and any compare match pending from before
+ *
+ * \return Nonzero if the counter was cleared, zero otherwise
+ */
+static inline unsigned int
+System_TimerClearCount(
+    System_TimerID  timer
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
+  {
+    return FALSE;
+  }
+
+  // Also clears the input divider
+  *system_timers[timer].TAxCTL |= (TACLR);
+  *system_timers[timer].TAxCCTL[SYSTEM_TIMER_BLOCK_PERIOD] &= ~(CCIFG);
 
   return TRUE;
 }
 
 /**
- * Sets the timer compare match value
+ * Reads a value from a constant table declared with SYSTEM_TABLE_MEMORY
  *
- * \return Nonzero if configuration was successful, zero otherwise
+ * \return Value at the given address
  */
 static inline unsigned int
-System_TimerSetCompareMatch(
-    System_TimerID  timer,
-    unsigned int    compareValue
+System_ReadTableValue(
+    const unsigned int* address
+    )
+{
+  return *address;
+}
+
+/**
+ * Holds every timer's prescaler, stopping all timers counting, or releases
+ * them from the start of a tick
+ *
+ * \note Each Timer_A has its own input divider, so there is nothing shared to
+ * hold
+ *
+ * \return Nonzero if the target can hold its prescalers, zero otherwise
+ */
+static inline unsigned int
+System_TimersHoldPrescalers(
+    unsigned int  isHeld
     )
 {
-  switch (timer)
+  return FALSE;
+}
+
+/**
+ * Sets which edges of a timer's input capture the counter
+ *
+ * Capture/compare block 1 captures its CCIxA input.
+ *
+ * \return Nonzero if the configuration was successful, zero otherwise
+ */
+static inline unsigned int
+System_TimerSetCaptureEdge(
+    System_TimerID          timer,
+    System_TimerCaptureEdge edge
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
   {
-    case SYSTEM_TIMER0:
-      TA0CCR0 = compareValue;
-      TA0CCTL0 &= ~(CAP);
-      break;
-    
-    case SYSTEM_TIMER1:
-      TA1CCR0 = compareValue;
-      TA1CCTL0 &= ~(CAP);
-      break;
+    return FALSE;
+  }
+
+  unsigned int TACCTL_copy = 0;
 
+  switch (edge)
+  {
+    case SYSTEM_TIMER_CAPTURE_NONE:     TACCTL_copy = 0; break;
+    case SYSTEM_TIMER_CAPTURE_RISING:   TACCTL_copy = (CM_1) | (CCIS_0) | (SCS) | (CAP); break;
+    case SYSTEM_TIMER_CAPTURE_FALLING:  TACCTL_copy = (CM_2) | (CCIS_0) | (SCS) | (CAP); break;
+    case SYSTEM_TIMER_CAPTURE_BOTH:     TACCTL_copy = (CM_3) | (CCIS_0) | (SCS) | (CAP); break;
     default:
       return FALSE;
       break;
   };
 
+  // Keep the interrupt enable as it was
+  volatile unsigned int* TAxCCTL = system_timers[timer].TAxCCTL[SYSTEM_TIMER_BLOCK_CAPTURE];
+  *TAxCCTL = (*TAxCCTL & (CCIE)) | TACCTL_copy;
+
   return TRUE;
 }
 
+/**
+ * Provides the counter value a timer captured on its last input edge
+ */
+static inline unsigned int
+System_TimerGetCaptureValue(
+    System_TimerID  timer
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
+  {
+    return 0;
+  }
+
+  return *system_timers[timer].TAxCCR[SYSTEM_TIMER_BLOCK_CAPTURE];
+}
+
+/**
+ * Provides the level of a timer's input just after its last captured edge
+ *
+ * \return Nonzero if the input was high, zero otherwise
+ */
+static inline unsigned int
+System_TimerGetCaptureLevel(
+    System_TimerID  timer
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
+  {
+    return FALSE;
+  }
+
+  return ((*system_timers[timer].TAxCCTL[SYSTEM_TIMER_BLOCK_CAPTURE] & SCCI) != 0) ? TRUE : FALSE;
+}
+
 /**
  * Sets the timer compare output mode
  *
@@ -243,23 +496,46 @@ System_TimerSetCompareMatch(
 static inline unsigned int
 System_TimerSetCompareOutputMode(
     System_TimerID                timer,
+    System_TimerCompareOutput     output,
     System_TimerCompareOutputMode outputMode
     )
 {
-  switch (timer)
+  if (
+      (timer >= SYSTEM_NUM_TIMERS) ||
+      (output >= SYSTEM_NUM_TIMER_OUTPUTS) ||
+      (outputMode >= SYSTEM_NUM_TIMER_OUTPUT_MODES)
+     )
   {
-    case SYSTEM_TIMER0:
-      TA0CCTL0 &= ~((OUTMOD2) | (OUTMOD1) | (OUTMOD0) | (OUT));
-      break;
+    return FALSE;
+  }
 
-    case SYSTEM_TIMER1:
-      TA1CCTL0 &= ~((OUTMOD2) | (OUTMOD1) | (OUTMOD0) | (OUT));
-      break;
+  volatile unsigned int* TAxCCTL = system_timers[timer].TAxCCTL[system_outputBlocks[output]];
+  *TAxCCTL = (*TAxCCTL & ~((OUTMOD2) | (OUTMOD1) | (OUTMOD0) | (OUT))) | system_outputModes[outputMode];
 
-    default:
-      return FALSE;
-      break;
-  };
+  return TRUE;
+}
+
+/**
+ * Sets the value one of the timer's other compare channels matches at
+ *
+ * \return Nonzero if the configuration was successful, zero otherwise
+ */
+static inline unsigned int
+System_TimerSetChannelCompareMatch(
+    System_TimerID            timer,
+    System_TimerCompareOutput output,
+    unsigned int              compareValue
+    )
+{
+  if (
+      (timer >= SYSTEM_NUM_TIMERS) ||
+      (output != SYSTEM_TIMER_OUTPUT_2)
+     )
+  {
+    return FALSE;
+  }
+
+  *system_timers[timer].TAxCCR[SYSTEM_TIMER_BLOCK_CHANNEL] = compareValue;
 
   return TRUE;
 }
@@ -267,6 +543,9 @@ System_TimerSetCompareOutputMode(
 /**
  * Sets the timer waveform generation mode
  *
+ * The PWM modes drive the output of capture/compare block 1 as the PWM
+ * output, non-inverted, so they cannot be used along with input capture.
+ *
  * \return Nonzero if the configuration was successful, zero otherwise
  */
 static inline unsigned int
@@ -275,16 +554,30 @@ System_TimerSetWaveGenMode(
     System_TimerWaveGenMode waveGenMode
     )
 {
-  switch (timer)
+  if (timer >= SYSTEM_NUM_TIMERS)
+  {
+    return FALSE;
+  }
+
+  unsigned int TACTL_MC_copy = 0;
+  unsigned int TACCTL_OUTMOD_copy = 0;
+
+  switch (waveGenMode)
   {
-    case SYSTEM_TIMER0:
-      TA0CTL &= ~((MC1) | (MC0));
-      TA0CTL |= (MC0);
+    case SYSTEM_TIMER_WAVEGEN_MODE_CTC:
+      TACTL_MC_copy = (MC0);
+      break;
+
+    case SYSTEM_TIMER_WAVEGEN_MODE_FAST_PWM:
+      // Up mode, reset at CCR1 and set at CCR0
+      TACTL_MC_copy = (MC0);
+      TACCTL_OUTMOD_copy = (OUTMOD_7);
       break;
 
-    case SYSTEM_TIMER1:
-      TA1CTL &= ~((MC1) | (MC0));
-      TA1CTL |= (MC0);
+    case SYSTEM_TIMER_WAVEGEN_MODE_PHASE_CORRECT_PWM:
+      // Up/down mode, toggle at CCR1 and reset at CCR0
+      TACTL_MC_copy = (MC1) | (MC0);
+      TACCTL_OUTMOD_copy = (OUTMOD_2);
       break;
 
     default:
@@ -292,6 +585,20 @@ System_TimerSetWaveGenMode(
       break;
   };
 
+  const System_TimerDescriptor* descriptor = &system_timers[timer];
+
+  *descriptor->TAxCTL &= ~((MC1) | (MC0));
+  *descriptor->TAxCTL |= TACTL_MC_copy;
+
+  // The same compare match value takes a different TAxCCR0 in each mode
+  System_TimerWriteCompareMatch(timer);
+
+  if (TACCTL_OUTMOD_copy != 0)
+  {
+    volatile unsigned int* TAxCCTL = descriptor->TAxCCTL[SYSTEM_TIMER_BLOCK_CAPTURE];
+    *TAxCCTL = (*TAxCCTL & ~((OUTMOD2) | (OUTMOD1) | (OUTMOD0) | (CAP))) | TACCTL_OUTMOD_copy;
+  }
+
   return TRUE;
 }
 
@@ -320,36 +627,30 @@ System_EnableEvent(
     System_EventType  event /**< Type of event to enable interrupts for */
     )
 {
-  unsigned int TACTL_MC_copy = 0;
-
-  switch (event)
+  if (event >= SYSTEM_NUM_EVENTS)
   {
-    case SYSTEM_EVENT_TIMER0_COMPAREMATCH:
-      // Stop timer when configuring clock source
-      TACTL_MC_copy = TA0CTL & ((MC1) | (MC0));
-      TA0CTL &= ~((MC1) | (MC0));
+    return FALSE;
+  }
 
-      TA0CCTL0 |= (CCIE);
+  const System_EventSource* source = &system_eventSources[event];
+  volatile unsigned int* TAxCTL = system_timers[source->timer].TAxCTL;
+  volatile unsigned int* TAxCCTL = system_timers[source->timer].TAxCCTL[source->block];
 
-      // Restart timer
-      TA0CTL |= TACTL_MC_copy;
-      break;
-    
-    case SYSTEM_EVENT_TIMER1_COMPAREMATCH:
-      // Stop timer when configuring clock source
-      TACTL_MC_copy = TA1CTL & ((MC1) | (MC0));
-      TA1CTL &= ~((MC1) | (MC0));
+  if (source->block == SYSTEM_TIMER_BLOCK_PERIOD)
+  {
+    // Stop timer when configuring clock source
+    unsigned int TACTL_MC_copy = *TAxCTL & ((MC1) | (MC0));
+    *TAxCTL &= ~((MC1) | (MC0));
 
-      TA1CCTL0 |= (CCIE);
+    *TAxCCTL |= (CCIE);
 
-      // Restart timer
-      TA1CTL |= TACTL_MC_copy;
-      break;
-    
-    default:
-      return FALSE;
-      break;
-  };
+    // Restart timer
+    *TAxCTL |= TACTL_MC_copy;
+  }
+  else
+  {
+    *TAxCCTL |= (CCIE);
+  }
 
   // Set global interrupt enable
   __eint();
@@ -365,40 +666,72 @@ System_DisableEvent(
     System_EventType  event /** Type of event to disable interrupts for */
     )
 {
-  unsigned int TACTL_MC_copy = 0;
-
-  switch (event)
+  if (event >= SYSTEM_NUM_EVENTS)
   {
-    case SYSTEM_EVENT_TIMER0_COMPAREMATCH:
-      // Stop timer when configuring clock source
-      TACTL_MC_copy = TA0CTL & ((MC1) | (MC0));
-      TA0CTL &= ~((MC1) | (MC0));
+    return FALSE;
+  }
 
-      TA0CCTL0 &= ~(CCIE);
+  const System_EventSource* source = &system_eventSources[event];
+  volatile unsigned int* TAxCTL = system_timers[source->timer].TAxCTL;
+  volatile unsigned int* TAxCCTL = system_timers[source->timer].TAxCCTL[source->block];
 
-      // Restart timer
-      TA0CTL |= TACTL_MC_copy;
-      break;
-    
-    case SYSTEM_EVENT_TIMER1_COMPAREMATCH:
-      // Stop timer when configuring clock source
-      TACTL_MC_copy = TA1CTL & ((MC1) | (MC0));
-      TA1CTL &= ~((MC1) | (MC0));
+  if (source->block == SYSTEM_TIMER_BLOCK_PERIOD)
+  {
+    // Stop timer when configuring clock source
+    unsigned int TACTL_MC_copy = *TAxCTL & ((MC1) | (MC0));
+    *TAxCTL &= ~((MC1) | (MC0));
 
-      TA1CCTL0 &= ~(CCIE);
+    *TAxCCTL &= ~(CCIE);
 
-      // Restart timer
-      TA1CTL |= TACTL_MC_copy;
-      break;
-    
-    default:
-      return FALSE;
-      break;
-  };
+    // Restart timer
+    *TAxCTL |= TACTL_MC_copy;
+  }
+  else
+  {
+    *TAxCCTL &= ~(CCIE);
+  }
 
   return TRUE;
 }
 
+/**
+ * Disables all interrupts
+ */
+static inline void
+System_DisableInterrupts()
+{
+  __dint();
+}
+
+/**
+ * Enables all interrupts
+ */
+static inline void
+System_EnableInterrupts()
+{
+  __eint();
+}
+
+/**
+ * Idles the processor until an interrupt has been serviced
+ *
+ * Interrupts are enabled in the same instruction that enters low-power mode,
+ * so an interrupt that arrived after the caller last checked wakes the
+ * processor instead of being missed.
+ *
+ * \note Interrupt service routines must clear the LPM0 bits on exit to wake
+ * the processor
+ */
+static inline void
+System_WaitForEvent(
+    System_EventType  event /**< Type of event being waited for */
+    )
+{
+  // Timer A keeps running off the subsystem clock in LPM0
+  __bis_SR_register(LPM0_bits | GIE);
+  __dint();
+}
+
 /**
  * Provides the callback event type for the given timer
  */
@@ -407,15 +740,49 @@ System_GetTimerCallbackEvent(
     System_TimerID  timerID
     )
 {
-  switch (timerID)
+  if (timerID >= SYSTEM_NUM_TIMERS)
   {
-    case SYSTEM_TIMER0: return SYSTEM_EVENT_TIMER0_COMPAREMATCH; break;
-    case SYSTEM_TIMER1: return SYSTEM_EVENT_TIMER1_COMPAREMATCH; break;
-    
-    default:
-      return SYSTEM_EVENT_INVALID;
-      break;
-  };
+    return SYSTEM_EVENT_INVALID;
+  }
+
+  return system_timers[timerID].events[SYSTEM_TIMER_BLOCK_PERIOD];
+}
+
+/**
+ * Provides the input capture event type for the given timer
+ */
+static inline System_EventType
+System_GetTimerCaptureEvent(
+    System_TimerID  timerID
+    )
+{
+  if (timerID >= SYSTEM_NUM_TIMERS)
+  {
+    return SYSTEM_EVENT_INVALID;
+  }
+
+  return system_timers[timerID].events[SYSTEM_TIMER_BLOCK_CAPTURE];
+}
+
+/**
+ * Provides the compare match event type of one of the given timer's other
+ * compare channels
+ */
+static inline System_EventType
+System_GetTimerChannelEvent(
+    System_TimerID            timerID,
+    System_TimerCompareOutput output
+    )
+{
+  if (
+      (timerID >= SYSTEM_NUM_TIMERS) ||
+      (output != SYSTEM_TIMER_OUTPUT_2)
+     )
+  {
+    return SYSTEM_EVENT_INVALID;
+  }
+
+  return system_timers[timerID].events[SYSTEM_TIMER_BLOCK_CHANNEL];
 }
 
 #endif /* TARGET_SYSTEM */
@@ -3,11 +3,21 @@
 
 #include "TargetSystem.h"
 #include "TimerDriver.h"
+#include "TimerEvents.h"
 
-static void ToggleLED1();
-static void ToggleLED2();
+/**
+ * Output pin driving an LED
+ */
+typedef struct LED_struct
+{
+  volatile uint8_t* port; /**< Output register of the LED's port */
+  uint8_t           mask; /**< Bit of the LED in its port */
+} LED;
+
+static void ToggleLED(TimerInstance* timer, void* context);
 
-static uint8_t events [SYSTEM_NUM_EVENTS] = {FALSE};
+static LED led1 = { &P1OUT, 1 };
+static LED led2 = { &P4OUT, (1<<7) };
 
 int main()
 {
@@ -19,6 +29,7 @@ int main()
 
   // Initialize timer driver
   InitTimers();
+  InitTimerEvents();
 
   // Initialize timer 1
   TimerInstance* timer1 = CreateTimer();
@@ -26,9 +37,10 @@ int main()
       timer1,
       500
       );
-  SetTimerCycleHandler(
+  SetTimerCycleHandlerEx(
       timer1,
-      ToggleLED1
+      ToggleLED,
+      &led1
       );
 
   // Initialize timer 2
@@ -37,63 +49,45 @@ int main()
       timer2,
       333
       );
-  SetTimerCycleHandler(
+  SetTimerCycleHandlerEx(
       timer2,
-      ToggleLED2
+      ToggleLED,
+      &led2
       );
 
-  // Start timers
-  StartTimer(timer1);
-  StartTimer(timer2);
-
-  System_EventType eventIter = 0;
-  System_EventCallback currentEventCallback = NULL;
+  // Start timers in phase
+  TimerGroup ledTimers;
+  InitTimerGroup(&ledTimers);
+  AddTimerToGroup(&ledTimers, timer1);
+  AddTimerToGroup(&ledTimers, timer2);
+  StartTimerGroup(&ledTimers);
 
   while(1)
   {
-    for(
-        eventIter = 0;
-        eventIter < SYSTEM_NUM_EVENTS;
-        ++eventIter
-       )
-    {
-      if (events[eventIter] == FALSE)
-      {
-        continue;
-      }
-
-      currentEventCallback = System_GetEventCallback(eventIter);
-
-      if (currentEventCallback != NULL)
-      {
-        (*currentEventCallback)(eventIter);
-      }
-
-      events[eventIter] = FALSE;
-    }
+    ProcessTimerEvents();
   }
 
   return 0;
 }
 
 void
-ToggleLED1()
-{
-  P1OUT ^= 1;
-}
-
-void
-ToggleLED2()
+ToggleLED(
+    TimerInstance*  timer,
+    void*           context
+    )
 {
-  P4OUT ^= (1<<7);
+  LED* led = (LED*)context;
+  *(led->port) ^= led->mask;
 }
 
 ISR(TIMER0_A0, Timer1ServiceRoutine)
 {
-  events[SYSTEM_EVENT_TIMER0_COMPAREMATCH] = TRUE;
+  PostTimerEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  __bic_SR_register_on_exit(LPM0_bits);
 }
 
 ISR(TIMER1_A0, Timer2ServiceRoutine)
 {
-  events[SYSTEM_EVENT_TIMER1_COMPAREMATCH] = TRUE;
+  PostTimerEvent(SYSTEM_EVENT_TIMER1_COMPAREMATCH);
+  __bic_SR_register_on_exit(LPM0_bits);
 }
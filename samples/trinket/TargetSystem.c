@@ -3,6 +3,41 @@
 
 static void (*callbacks [SYSTEM_NUM_EVENTS])(System_EventType) = {NULL};
 
+unsigned int system_compareValue = 0;
+
+const unsigned char system_clockSourceBits [NUM_TIMER_CLKSOURCES] SYSTEM_TABLE_MEMORY =
+{
+  [SYSTEM_TIMER_CLKSOURCE_INT]          = (1<<CS00),
+  [SYSTEM_TIMER_CLKSOURCE_INT_PRE8]     = (1<<CS01),
+  [SYSTEM_TIMER_CLKSOURCE_INT_PRE64]    = (1<<CS01) | (1<<CS00),
+  [SYSTEM_TIMER_CLKSOURCE_INT_PRE256]   = (1<<CS02),
+  [SYSTEM_TIMER_CLKSOURCE_INT_PRE1024]  = (1<<CS02) | (1<<CS00),
+  [SYSTEM_TIMER_CLKSOURCE_OFF]          = 0
+};
+
+const unsigned char system_outputMasks [SYSTEM_NUM_TIMER_OUTPUTS] SYSTEM_TABLE_MEMORY =
+{
+  [SYSTEM_TIMER_OUTPUT_A] = (1<<COM0A1) | (1<<COM0A0),
+  [SYSTEM_TIMER_OUTPUT_B] = (1<<COM0B1) | (1<<COM0B0)
+};
+
+const unsigned char system_outputModeBits [SYSTEM_NUM_TIMER_OUTPUTS][SYSTEM_NUM_TIMER_OUTPUT_MODES] SYSTEM_TABLE_MEMORY =
+{
+  [SYSTEM_TIMER_OUTPUT_A] =
+  {
+    [SYSTEM_TIMER_OUTPUT_MODE_NONE]   = 0,
+    [SYSTEM_TIMER_OUTPUT_MODE_SET]    = (1<<COM0A1) | (1<<COM0A0),
+    [SYSTEM_TIMER_OUTPUT_MODE_CLEAR]  = (1<<COM0A1),
+    [SYSTEM_TIMER_OUTPUT_MODE_TOGGLE] = (1<<COM0A0)
+  },
+  [SYSTEM_TIMER_OUTPUT_B] =
+  {
+    [SYSTEM_TIMER_OUTPUT_MODE_NONE]   = 0,
+    [SYSTEM_TIMER_OUTPUT_MODE_SET]    = (1<<COM0B1) | (1<<COM0B0),
+    [SYSTEM_TIMER_OUTPUT_MODE_CLEAR]  = (1<<COM0B1),
+    [SYSTEM_TIMER_OUTPUT_MODE_TOGGLE] = (1<<COM0B0)
+  }
+};
 
 void
 System_RegisterCallback(
@@ -4,10 +4,19 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/pgmspace.h>
 
 #define TRUE 1
 #define FALSE 0
 
+/**
+ * Attribute placing a constant table in flash, where System_ReadTableValue()
+ * reads it, rather than copying it into RAM at startup
+ */
+#define SYSTEM_TABLE_MEMORY PROGMEM
+
 #define SYSTEM_CORE_CLOCK_FREQUENCY 8000000
 
 /**
@@ -41,7 +50,9 @@ typedef enum System_TimerClockSource_enum
  */
 typedef enum System_TimerCompareOutput_enum
 {
-  SYSTEM_TIMER_OUTPUT_A
+  SYSTEM_TIMER_OUTPUT_A,    /**< OC0A (PB0), matching on OCR0A */
+  SYSTEM_TIMER_OUTPUT_B,    /**< OC0B (PB1), matching on OCR0B */
+  SYSTEM_NUM_TIMER_OUTPUTS
 } System_TimerCompareOutput;
 
 /**
@@ -49,9 +60,22 @@ typedef enum System_TimerCompareOutput_enum
  */
 typedef enum System_TimerWaveGenMode_enum
 {
-  SYSTEM_TIMER_WAVEGEN_MODE_CTC /**< Clear timer on compare-match */
+  SYSTEM_TIMER_WAVEGEN_MODE_CTC,               /**< Clear timer on compare-match */
+  SYSTEM_TIMER_WAVEGEN_MODE_FAST_PWM,          /**< Count up to the compare-match value, with the PWM output high below the PWM compare value */
+  SYSTEM_TIMER_WAVEGEN_MODE_PHASE_CORRECT_PWM  /**< Count up to the compare-match value and back down, with the PWM output high below the PWM compare value */
 } System_TimerWaveGenMode;
 
+/**
+ * Enumeration of timer input capture edges
+ */
+typedef enum System_TimerCaptureEdge_enum
+{
+  SYSTEM_TIMER_CAPTURE_NONE,    /**< Input capture disabled */
+  SYSTEM_TIMER_CAPTURE_RISING,
+  SYSTEM_TIMER_CAPTURE_FALLING,
+  SYSTEM_TIMER_CAPTURE_BOTH
+} System_TimerCaptureEdge;
+
 /**
  * Enumeration of timer compare output modes
  */
@@ -60,7 +84,8 @@ typedef enum System_TimerCompareOutputMode_enum
   SYSTEM_TIMER_OUTPUT_MODE_NONE,   /**< Outputs disconnected */
   SYSTEM_TIMER_OUTPUT_MODE_SET,
   SYSTEM_TIMER_OUTPUT_MODE_CLEAR,
-  SYSTEM_TIMER_OUTPUT_MODE_TOGGLE
+  SYSTEM_TIMER_OUTPUT_MODE_TOGGLE,
+  SYSTEM_NUM_TIMER_OUTPUT_MODES
 } System_TimerCompareOutputMode;
 
 /**
@@ -71,6 +96,7 @@ typedef enum System_EventType_enum
   SYSTEM_EVENT_TIMER0_COMPAREMATCH,
   SYSTEM_EVENT_TIMER1_COMPAREMATCH,
   SYSTEM_EVENT_TIMER2_COMPAREMATCH,
+  SYSTEM_EVENT_TIMER0_COMPAREMATCH_B,
   SYSTEM_NUM_EVENTS,
   SYSTEM_EVENT_INVALID
 } System_EventType;
@@ -80,6 +106,27 @@ typedef enum System_EventType_enum
  */
 typedef void (*System_EventCallback)(System_EventType);
 
+/**
+ * CS0 bits of TCCR0B for each clock source, indexed by clock source
+ */
+extern const unsigned char system_clockSourceBits [NUM_TIMER_CLKSOURCES] SYSTEM_TABLE_MEMORY;
+
+/**
+ * COM0 bits of TCCR0A for each output, indexed by output
+ */
+extern const unsigned char system_outputMasks [SYSTEM_NUM_TIMER_OUTPUTS] SYSTEM_TABLE_MEMORY;
+
+/**
+ * COM0 bits of TCCR0A for each output in each compare output mode, indexed by
+ * output then mode
+ */
+extern const unsigned char system_outputModeBits [SYSTEM_NUM_TIMER_OUTPUTS][SYSTEM_NUM_TIMER_OUTPUT_MODES] SYSTEM_TABLE_MEMORY;
+
+/**
+ * Compare match value last set, in ticks between compare matches
+ */
+extern unsigned int system_compareValue;
+
 /**
  * Provides the frequency in Hz for a given clock source
  *
@@ -127,44 +174,48 @@ System_TimerSetClockSource(
     System_TimerClockSource clockSource
     )
 {
-  TCCR0B &= ~((1<<CS02) | (1<<CS01) | (1<<CS00));
-
-  switch (clockSource)
+  if (clockSource >= NUM_TIMER_CLKSOURCES)
   {
-    case SYSTEM_TIMER_CLKSOURCE_OFF:
-      break;
-
-    case SYSTEM_TIMER_CLKSOURCE_INT:
-      TCCR0B |= (1<<CS00);
-      break;
-
-    case SYSTEM_TIMER_CLKSOURCE_INT_PRE8:
-      TCCR0B |= (1<<CS01);
-      break;
+    return FALSE;
+  }
 
-    case SYSTEM_TIMER_CLKSOURCE_INT_PRE64:
-      TCCR0B |= (1<<CS01) | (1<<CS00);
-      break;
+  TCCR0B = (TCCR0B & ~((1<<CS02) | (1<<CS01) | (1<<CS00))) | pgm_read_byte(&system_clockSourceBits[clockSource]);
 
-    case SYSTEM_TIMER_CLKSOURCE_INT_PRE256:
-      TCCR0B |= (1<<CS02);
-      break;
+  return TRUE;
+}
 
-    case SYSTEM_TIMER_CLKSOURCE_INT_PRE1024:
-      TCCR0B |= (1<<CS02) | (1<<CS00);
-      break;
+/**
+ * Writes OCR0A so that the counter counts the compare match value in ticks
+ * from one compare match to the next
+ *
+ * The counter clears on the tick after it matches OCR0A, so counts one tick
+ * more than OCR0A, except in phase-correct PWM mode where it turns back down
+ * at OCR0A instead.
+ */
+static inline void
+System_TimerWriteCompareMatch(
+    System_TimerID  timer
+    )
+{
+  unsigned int compareValue = system_compareValue;
 
-    default:
-      return FALSE;
-      break;
-  };
+  if (
+      (compareValue != 0) &&
+      ((TCCR0A & ((1<<WGM01) | (1<<WGM00))) != (1<<WGM00))
+     )
+  {
+    compareValue--;
+  }
 
-  return TRUE;
+  OCR0A = compareValue;
 }
 
 /**
  * Sets the timer compare match value
  *
+ * The value is the number of ticks from one compare match to the next, as
+ * counted up from zero.
+ *
  * \return Nonzero if configuration was successful, zero otherwise
  */
 static inline unsigned int
@@ -173,10 +224,151 @@ System_TimerSetCompareMatch(
     unsigned int    compareValue
     )
 {
-  OCR0A = compareValue;
+  system_compareValue = compareValue;
+  System_TimerWriteCompareMatch(timer);
+  return TRUE;
+}
+
+/**
+ * Sets the value a timer's PWM output changes level at
+ *
+ * \return Nonzero if configuration was successful, zero otherwise
+ */
+static inline unsigned int
+System_TimerSetPwmCompareMatch(
+    System_TimerID  timer,
+    unsigned int    compareValue
+    )
+{
+  OCR0B = compareValue;
+  return TRUE;
+}
+
+/**
+ * Provides the current counter value of a timer
+ *
+ * \return Number of clock source ticks since the timer last matched or was
+ * started
+ */
+static inline unsigned int
+System_TimerGetCount(
+    System_TimerID  timer
+    )
+{
+  return TCNT0;
+}
+
+/**
+ * Provides whether a timer's compare match interrupt is waiting to be serviced
+ *
+ * \return Nonzero if the timer has matched since its interrupt was last
+ * serviced, zero otherwise
+ */
+static inline unsigned int
+System_TimerGetCompareMatchPending(
+    System_TimerID  timer
+    )
+{
+  return ((TIFR & (1<<OCF0A)) != 0) ? TRUE : FALSE;
+}
+
+/**
+ * Clears a timer's counter, the clock source ticks counted toward its next
+ * tick and any compare match pending from before
+ *
+ * \return Nonzero if the counter was cleared, zero otherwise
+ */
+static inline unsigned int
+System_TimerClearCount(
+    System_TimerID  timer
+    )
+{
+  GTCCR |= (1<<PSR0);
+  TCNT0 = 0;
+  TIFR = (1<<OCF0A);
+  return TRUE;
+}
+
+/**
+ * Reads a value from a constant table declared with SYSTEM_TABLE_MEMORY
+ *
+ * \return Value at the given address
+ */
+static inline unsigned int
+System_ReadTableValue(
+    const unsigned int* address
+    )
+{
+  return pgm_read_word(address);
+}
+
+/**
+ * Holds every timer's prescaler, stopping all timers counting, or releases
+ * them from the start of a tick
+ *
+ * While held, timers can be cleared and have their clock sources set, so that
+ * they all start counting together once released.
+ *
+ * \return Nonzero if the target can hold its prescalers, zero otherwise
+ */
+static inline unsigned int
+System_TimersHoldPrescalers(
+    unsigned int  isHeld
+    )
+{
+  if (isHeld == FALSE)
+  {
+    // The prescaler reset stays set until the synchronization mode is cleared
+    GTCCR &= ~(1<<TSM);
+  }
+  else
+  {
+    GTCCR |= (1<<TSM) | (1<<PSR0);
+  }
+
   return TRUE;
 }
 
+/**
+ * Sets which edges of a timer's input capture the counter
+ *
+ * \note Timer 0 has no input capture
+ *
+ * \return Nonzero if the configuration was successful, zero otherwise
+ */
+static inline unsigned int
+System_TimerSetCaptureEdge(
+    System_TimerID          timer,
+    System_TimerCaptureEdge edge
+    )
+{
+  return (edge == SYSTEM_TIMER_CAPTURE_NONE) ? TRUE : FALSE;
+}
+
+/**
+ * Provides the counter value a timer captured on its last input edge
+ */
+static inline unsigned int
+System_TimerGetCaptureValue(
+    System_TimerID  timer
+    )
+{
+  return 0;
+}
+
+/**
+ * Provides the level of a timer's input just after its last captured edge
+ *
+ * \return Nonzero if the input was high, zero otherwise
+ */
+static inline unsigned int
+System_TimerGetCaptureLevel(
+    System_TimerID  timer
+    )
+{
+  return FALSE;
+}
+
 /**
  * Sets the timer compare output mode
  *
@@ -185,31 +377,42 @@ System_TimerSetCompareMatch(
 static inline unsigned int
 System_TimerSetCompareOutputMode(
     System_TimerID                timer,
+    System_TimerCompareOutput     output,
     System_TimerCompareOutputMode outputMode
     )
 {
-  TCCR0A &= ~((1<<COM0A1) | (1<<COM0A0));
-
-  switch (outputMode)
+  if (
+      (output >= SYSTEM_NUM_TIMER_OUTPUTS) ||
+      (outputMode >= SYSTEM_NUM_TIMER_OUTPUT_MODES)
+     )
   {
-    case SYSTEM_TIMER_OUTPUT_MODE_NONE:
-      break;
+    return FALSE;
+  }
 
-    case SYSTEM_TIMER_OUTPUT_MODE_SET:
-      TCCR0A |= (1<<COM0A1) | (1<<COM0A0);
-      break;
+  TCCR0A = (TCCR0A & ~pgm_read_byte(&system_outputMasks[output])) | pgm_read_byte(&system_outputModeBits[output][outputMode]);
 
-    case SYSTEM_TIMER_OUTPUT_MODE_CLEAR:
-      TCCR0A |= (1<<COM0A1);
-      break;
-
-    case SYSTEM_TIMER_OUTPUT_MODE_TOGGLE:
-      TCCR0A |= (1<<COM0A0);
-      break;
+  return TRUE;
+}
 
-    default:
-      return FALSE;
-      break;
+/**
+ * Sets the value one of the timer's other compare channels matches at
+ *
+ * \note OCR0B is also the PWM compare value, so this is only meaningful in CTC
+ * mode
+ *
+ * \return Nonzero if the configuration was successful, zero otherwise
+ */
+static inline unsigned int
+System_TimerSetChannelCompareMatch(
+    System_TimerID            timer,
+    System_TimerCompareOutput output,
+    unsigned int              compareValue
+    )
+{
+  switch (output)
+  {
+    case SYSTEM_TIMER_OUTPUT_B: OCR0B = compareValue; break;
+    default: return FALSE; break;
   };
 
   return TRUE;
@@ -218,6 +421,9 @@ System_TimerSetCompareOutputMode(
 /**
  * Sets the timer waveform generation mode
  *
+ * The PWM modes count up to OCR0A, so they drive OC0B (PB1) as the PWM
+ * output, non-inverted.
+ *
  * \return Nonzero if the configuration was successful, zero otherwise
  */
 static inline unsigned int
@@ -226,6 +432,16 @@ System_TimerSetWaveGenMode(
     System_TimerWaveGenMode waveGenMode
     )
 {
+  // OC0B is free for its own compare output mode in CTC mode, so is only
+  // disconnected when entering or leaving a PWM mode
+  if (
+      (waveGenMode != SYSTEM_TIMER_WAVEGEN_MODE_CTC) ||
+      ((TCCR0A & (1<<WGM00)) != 0)
+     )
+  {
+    TCCR0A &= ~((1<<COM0B1) | (1<<COM0B0));
+  }
+
   TCCR0A &= ~((1<<WGM01) | (1<<WGM00));
   TCCR0B &= ~((1<<WGM02));
 
@@ -235,11 +451,24 @@ System_TimerSetWaveGenMode(
       TCCR0A |= ((1<<WGM01));
       break;
 
+    case SYSTEM_TIMER_WAVEGEN_MODE_FAST_PWM:
+      TCCR0A |= ((1<<WGM01) | (1<<WGM00) | (1<<COM0B1));
+      TCCR0B |= ((1<<WGM02));
+      break;
+
+    case SYSTEM_TIMER_WAVEGEN_MODE_PHASE_CORRECT_PWM:
+      TCCR0A |= ((1<<WGM00) | (1<<COM0B1));
+      TCCR0B |= ((1<<WGM02));
+      break;
+
     default:
       return FALSE;
       break;
   };
 
+  // The same compare match value takes a different OCR0A in each mode
+  System_TimerWriteCompareMatch(timer);
+
   return TRUE;
 }
 
@@ -270,8 +499,9 @@ System_EnableEvent(
 {
   switch (event)
   {
-    case SYSTEM_EVENT_TIMER0_COMPAREMATCH: TIMSK |= (1<<OCIE0A);
-    
+    case SYSTEM_EVENT_TIMER0_COMPAREMATCH: TIMSK |= (1<<OCIE0A); break;
+    case SYSTEM_EVENT_TIMER0_COMPAREMATCH_B: TIMSK |= (1<<OCIE0B); break;
+
     default:
       return FALSE;
       break;
@@ -290,8 +520,9 @@ System_DisableEvent(
 {
   switch (event)
   {
-    case SYSTEM_EVENT_TIMER0_COMPAREMATCH: TIMSK &= ~((1<<OCIE0A));
-    
+    case SYSTEM_EVENT_TIMER0_COMPAREMATCH: TIMSK &= ~((1<<OCIE0A)); break;
+    case SYSTEM_EVENT_TIMER0_COMPAREMATCH_B: TIMSK &= ~((1<<OCIE0B)); break;
+
     default:
       return FALSE;
       break;
@@ -300,6 +531,45 @@ System_DisableEvent(
   return TRUE;
 }
 
+/**
+ * Disables all interrupts
+ */
+static inline void
+System_DisableInterrupts()
+{
+  cli();
+}
+
+/**
+ * Enables all interrupts
+ */
+static inline void
+System_EnableInterrupts()
+{
+  sei();
+}
+
+/**
+ * Idles the processor until an interrupt has been serviced
+ *
+ * The instruction following SEI is always executed before any pending
+ * interrupt, so an interrupt that arrived after the caller last checked wakes
+ * the processor instead of being missed.
+ */
+static inline void
+System_WaitForEvent(
+    System_EventType  event /**< Type of event being waited for */
+    )
+{
+  // Timer 0 keeps running in idle mode
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  sleep_enable();
+  sei();
+  sleep_cpu();
+  sleep_disable();
+  cli();
+}
+
 /**
  * Provides the callback event type for the given timer
  */
@@ -315,4 +585,38 @@ System_GetTimerCallbackEvent(
   };
 }
 
+/**
+ * Provides the compare match event type of one of the given timer's other
+ * compare channels
+ */
+static inline System_EventType
+System_GetTimerChannelEvent(
+    System_TimerID            timer,
+    System_TimerCompareOutput output
+    )
+{
+  if (
+      (timer == SYSTEM_TIMER0) &&
+      (output == SYSTEM_TIMER_OUTPUT_B)
+     )
+  {
+    return SYSTEM_EVENT_TIMER0_COMPAREMATCH_B;
+  }
+
+  return SYSTEM_EVENT_INVALID;
+}
+
+/**
+ * Provides the input capture event type for the given timer
+ *
+ * \note Timer 0 has no input capture
+ */
+static inline System_EventType
+System_GetTimerCaptureEvent(
+    System_TimerID  timer
+    )
+{
+  return SYSTEM_EVENT_INVALID;
+}
+
 #endif /* TARGET_SYSTEM */
@@ -4,11 +4,10 @@
 
 #include "TargetSystem.h"
 #include "TimerDriver.h"
+#include "TimerEvents.h"
 
 static void ToggleLED();
 
-static uint8_t events [SYSTEM_NUM_EVENTS] = {FALSE};
-
 int main()
 {
   // Enable interrupts
@@ -16,6 +15,7 @@ int main()
 
   // Initialize timer driver
   InitTimers();
+  InitTimerEvents();
 
   // Set PORTB0 (OC0A) to output
   DDRB |= (1<<DDB0);
@@ -32,33 +32,17 @@ int main()
       timer,
       ToggleLED
       );
+
+  // Toggle straight from the interrupt for a steady edge
+  SetTimerHandlerMode(
+      timer,
+      TIMER_HANDLER_IMMEDIATE
+      );
   StartTimer(timer);
 
-  System_EventType eventIter = 0;
-  System_EventCallback currentEventCallback = NULL;
-  
   while(1)
   {
-    for(
-        eventIter = 0;
-        eventIter < SYSTEM_NUM_EVENTS;
-        ++eventIter
-       )
-    {
-      if (events[eventIter] == FALSE)
-      {
-        continue;
-      }
-
-      currentEventCallback = System_GetEventCallback(eventIter);
-
-      if (currentEventCallback != NULL)
-      {
-        (*currentEventCallback)(eventIter);
-      }
-
-      events[eventIter] = FALSE;
-    }
+    ProcessTimerEvents();
   }
 
   return 0;
@@ -72,5 +56,5 @@ ToggleLED()
 
 ISR(TIM0_COMPA_vect)
 {
-  events[SYSTEM_EVENT_TIMER0_COMPAREMATCH] = TRUE;
+  PostTimerEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
 }
@@ -2,31 +2,491 @@
 #include <limits.h>
 
 #include "TimerDriver.h"
+#include "TimerEvents.h"
 #include "TargetSystem.h"
 
+#if ((TIMER_CAPTURE_BUFFER_SIZE) & ((TIMER_CAPTURE_BUFFER_SIZE) - 1)) != 0
+#error "TIMER_CAPTURE_BUFFER_SIZE must be a power of two"
+#endif
+
+#if (TIMER_CAPTURE_BUFFER_SIZE) > 128
+#error "TIMER_CAPTURE_BUFFER_SIZE must be no larger than 128"
+#endif
+
+#if TIMER_HAL_OPS
+/**
+ * Whether the given ID has an entry in system_timerOps
+ *
+ * Any other ID, such as the virtual timer base while there are no virtual
+ * timers, fails through NoTimerHalOp() as an invalid ID does in the HAL.
+ */
+#define TIMER_HAS_HAL_OPS(timer) ((timer) < SYSTEM_NUM_TIMERS)
+
+/**
+ * Stands in for the HAL functions of a timer with no entry in system_timerOps
+ *
+ * \return Zero
+ */
+static inline unsigned int
+NoTimerHalOp()
+{
+  return 0;
+}
+
+/**
+ * The HAL functions acting on a single timer, called through the timer's ops
+ * so that each timer can be of a different kind
+ */
+#define System_TimerGetMaxValue(timer) \
+  (TIMER_HAS_HAL_OPS(timer) ? (*system_timerOps[(timer)]->getMaxValue)((timer)) : NoTimerHalOp())
+#define System_TimerSetClockSource(timer, source) \
+  (TIMER_HAS_HAL_OPS(timer) ? (*system_timerOps[(timer)]->setClockSource)((timer), (source)) : NoTimerHalOp())
+#define System_TimerSetCompareMatch(timer, value) \
+  (TIMER_HAS_HAL_OPS(timer) ? (*system_timerOps[(timer)]->setCompareMatch)((timer), (value)) : NoTimerHalOp())
+#define System_TimerSetChannelCompareMatch(timer, output, value) \
+  (TIMER_HAS_HAL_OPS(timer) ? (*system_timerOps[(timer)]->setChannelCompareMatch)((timer), (output), (value)) : NoTimerHalOp())
+#define System_TimerGetCount(timer) \
+  (TIMER_HAS_HAL_OPS(timer) ? (*system_timerOps[(timer)]->getCount)((timer)) : NoTimerHalOp())
+#define System_TimerGetCompareMatchPending(timer) \
+  (TIMER_HAS_HAL_OPS(timer) ? (*system_timerOps[(timer)]->getCompareMatchPending)((timer)) : NoTimerHalOp())
+#define System_TimerClearCount(timer) \
+  (TIMER_HAS_HAL_OPS(timer) ? (*system_timerOps[(timer)]->clearCount)((timer)) : NoTimerHalOp())
+#define System_TimerSetCaptureEdge(timer, edge) \
+  (TIMER_HAS_HAL_OPS(timer) ? (*system_timerOps[(timer)]->setCaptureEdge)((timer), (edge)) : NoTimerHalOp())
+#define System_TimerGetCaptureValue(timer) \
+  (TIMER_HAS_HAL_OPS(timer) ? (*system_timerOps[(timer)]->getCaptureValue)((timer)) : NoTimerHalOp())
+#define System_TimerGetCaptureLevel(timer) \
+  (TIMER_HAS_HAL_OPS(timer) ? (*system_timerOps[(timer)]->getCaptureLevel)((timer)) : NoTimerHalOp())
+#define System_TimerSetCompareOutputMode(timer, output, mode) \
+  (TIMER_HAS_HAL_OPS(timer) ? (*system_timerOps[(timer)]->setCompareOutputMode)((timer), (output), (mode)) : NoTimerHalOp())
+#define System_TimerSetWaveGenMode(timer, mode) \
+  (TIMER_HAS_HAL_OPS(timer) ? (*system_timerOps[(timer)]->setWaveGenMode)((timer), (mode)) : NoTimerHalOp())
+#define System_TimerSetPwmCompareMatch(timer, value) \
+  (TIMER_HAS_HAL_OPS(timer) ? (*system_timerOps[(timer)]->setPwmCompareMatch)((timer), (value)) : NoTimerHalOp())
+#endif
+
+/**
+ * Compare channel of a hardware timer
+ */
+typedef struct TimerChannel_struct
+{
+  System_TimerCompareOutputMode outputMode;     /**< Compare output mode */
+  unsigned int                  compareMatch;   /**< Ticks into each compare match period to match at, or zero if unused, for all but the first channel */
+  TimerChannelHandler           handler;        /**< Handler function to call on each match, for all but the first channel */
+  void*                         handlerContext; /**< Context to pass to the handler */
+} TimerChannel;
+
 struct TimerInstance_struct
 {
   System_TimerID                id;                     /**< System ID of timer */
   TimerStatus                   status;                 /**< Current status of the timer */
   System_TimerClockSource       clockSource;            /**< Clock source currently used for this timer */
   unsigned int                  compareMatch;           /**< Value to trigger a compare match on */
+  unsigned int                  finalCompareMatch;      /**< Value to trigger the last compare match of each cycle on */
   unsigned int                  compareMatchesPerCycle; /**< Number of compare matches per timer cycle */
-  System_TimerCompareOutputMode compareOutputMode;      /**< Compare output mode */
+  TimerChannel                  channels [SYSTEM_NUM_TIMER_OUTPUTS]; /**< Compare channels, indexed by output */
   unsigned int                  numCompareMatches;      /**< Number of compare matches counted in current cycle */
-  unsigned int                  numCycles;              /**< Number of cycles counted */
+  volatile unsigned int         numCycles;              /**< Number of cycles counted */
   TimerCycleHandler             cycleHandler;           /**< Handler function to call for each cycle completion */
+  TimerCycleHandlerEx           cycleHandlerEx;         /**< Handler function to call with the timer and context for each cycle completion */
+  void*                         cycleHandlerContext;    /**< Context to pass to the cycle handler */
+  TimerHandlerMode              handlerMode;            /**< Context to run the cycle handler in */
+  TimerCatchUpPolicy            catchUpPolicy;          /**< How to handle cycles missed by an overrun */
+  unsigned int                  numMissedCycles;        /**< Number of cycles missed in total */
+  unsigned int                  lastMissedCycles;       /**< Number of cycles missed just before the last one completed */
+  unsigned int                  numOverruns;            /**< Number of compare matches that arrived before the last one was done with */
+  TimerSolverMode               solverMode;             /**< Strategy for finding the cycle time configuration */
+  unsigned long long int        cycleTicks;             /**< Cycle length in ticks of the fastest clock source */
+  long long int                 cycleErrorTicks;        /**< Cycle length minus requested length, in ticks of the fastest clock source */
+  unsigned int                  isVirtual;              /**< Nonzero if multiplexed onto the virtual timer base */
+  unsigned long int             virtualDelta;           /**< Ticks from the previous virtual timer's next match to this one's */
+  TimerInstance*                nextVirtual;            /**< Next timer in the virtual timer list */
+  TimerPwmMode                  pwmMode;                /**< PWM waveform generated */
+  unsigned int                  pwmDutyCycle;           /**< PWM duty cycle, in hundredths of a percent */
+  unsigned int                  pwmCompareMatch;        /**< Value the PWM output changes level at, once any pending update is applied */
+  volatile unsigned int         pwmUpdatePending;       /**< Nonzero if the PWM compare value is waiting for the period to end */
+  System_TimerClockSource       stagedClockSource;      /**< Clock source to switch to once the current cycle ends */
+  unsigned int                  stagedCompareMatch;     /**< Compare match value to switch to once the current cycle ends */
+  unsigned int                  stagedFinalMatch;       /**< Final compare match value to switch to once the current cycle ends */
+  unsigned int                  stagedMatchesPerCycle;  /**< Number of compare matches per cycle to switch to once the current cycle ends */
+  volatile unsigned int         cycleUpdatePending;     /**< Nonzero if a new cycle time is waiting for the current cycle to end */
+  TimerSequence*                sequence;               /**< Sequence being run, if any */
+#if TIMER_LATENCY_STATS
+  TimerLatencyStats             latencyStats;           /**< Cycle handler latency statistics */
+#endif
+#if TIMER_CAPTURE_BUFFER_SIZE > 0
+  System_TimerCaptureEdge       captureEdge;            /**< Input edges being captured */
+  volatile unsigned long long int captureBase;          /**< Ticks counted by completed wraps since capture started */
+#endif
 };
 
+/**
+ * Candidate timer configuration for a given cycle time
+ */
+typedef struct TimerCycle_struct
+{
+  System_TimerClockSource clockSource;            /**< Clock source to run the timer off */
+  unsigned long int       numTicks;               /**< Cycle length in ticks of the clock source */
+  unsigned long int       compareMatchesPerCycle; /**< Number of sub-cycles to split the cycle into */
+} TimerCycle;
+
+/**
+ * Number of hardware timers that can be handed out directly
+ *
+ * When virtual timers are enabled, the last hardware timer is reserved as the
+ * base for all virtual timers.
+ */
+#if TIMER_NUM_VIRTUAL_TIMERS > 0
+#define TIMER_NUM_HARDWARE_TIMERS (SYSTEM_NUM_TIMERS - 1)
+#else
+#define TIMER_NUM_HARDWARE_TIMERS (SYSTEM_NUM_TIMERS)
+#endif
+
+#if (TIMER_NUM_DEADLINES) > 255
+#error "TIMER_NUM_DEADLINES must be no larger than 255"
+#endif
+
+#if TIMER_NUM_DEADLINES > 0
+/**
+ * One-shot deadline
+ */
+typedef struct TimerDeadline_struct
+{
+  unsigned long long int  dueTicks; /**< Time the deadline is due, in ticks of the fastest clock source */
+  TimerDeadlineHandler    handler;  /**< Function to call once due, or NULL if the slot is free */
+  void*                   context;  /**< Context to pass to the handler */
+  unsigned char           heapIdx;  /**< Position in the deadline heap */
+} TimerDeadline;
+#endif
+
+#if TIMER_CAPTURE_BUFFER_SIZE > 0
+/**
+ * Mask for wrapping capture buffer indices
+ */
+#define TIMER_CAPTURE_BUFFER_MASK ((TIMER_CAPTURE_BUFFER_SIZE) - 1)
+
+/**
+ * Input capture timestamps waiting to be read from a hardware timer
+ */
+typedef struct TimerCaptureBuffer_struct
+{
+  TimerCapture            captures [TIMER_CAPTURE_BUFFER_SIZE]; /**< Timestamps waiting to be read */
+  volatile unsigned char  head;                                 /**< Free-running index of the next timestamp to capture, only written by the interrupt */
+  volatile unsigned char  tail;                                 /**< Free-running index of the next timestamp to read, only written by the main loop */
+  volatile unsigned int   numLost;                              /**< Number of timestamps dropped because the buffer was full */
+} TimerCaptureBuffer;
+#endif
+
+/**
+ * Total number of timer instances, hardware and virtual
+ */
+#define TIMER_NUM_INSTANCES (TIMER_NUM_HARDWARE_TIMERS + TIMER_NUM_VIRTUAL_TIMERS)
+
+/**
+ * System ID of the hardware timer that virtual timers are multiplexed onto
+ */
+#define TIMER_VIRTUAL_BASE ((System_TimerID)TIMER_NUM_HARDWARE_TIMERS)
+
+/**
+ * Minimum clock source frequency for the virtual timer base
+ *
+ * The virtual timer base runs off the slowest clock source that can still
+ * resolve a single millisecond.
+ */
+#define TIMER_VIRTUAL_MIN_FREQUENCY 1000
+
+/**
+ * Minimum clock source frequency for the monotonic clock
+ *
+ * The clock runs off the slowest clock source that can still resolve a single
+ * microsecond, so that it wraps as seldom as possible.
+ */
+#define TIMER_CLOCK_MIN_FREQUENCY 1000000
+
 static unsigned int timersInitialized = FALSE;
-static TimerInstance timerInstances [SYSTEM_NUM_TIMERS];
-static unsigned int timerInstancesInUse [SYSTEM_NUM_TIMERS];
+static TimerInstance timerInstances [TIMER_NUM_INSTANCES];
+static unsigned int timerInstancesInUse [TIMER_NUM_INSTANCES];
 static unsigned int numTimerInstances = 0;
 
+/**
+ * Reverse lookup from compare match event to the hardware timer raising it
+ */
+static TimerInstance* eventTimerInstances [SYSTEM_NUM_EVENTS];
+
+static TimerInstance* virtualTimerList = NULL;    /**< Running virtual timers, sorted by next compare match */
+static unsigned long int virtualTimerInterval = 0; /**< Number of ticks currently programmed into the virtual timer base */
+
+static TimerInstance* clockTimer = NULL;                      /**< Hardware timer running the monotonic clock, if any */
+static volatile unsigned long long int clockBaseTicks = 0;  /**< Clock source ticks counted by completed wraps of the clock */
+static volatile unsigned char clockSequence = 0;            /**< Incremented before and after each update of the clock, so odd while one is under way */
+static unsigned long int clockSourceFrequency = 0;          /**< Frequency of the clock's clock source */
+static unsigned long int clockTickRatio = 0;                /**< Ticks of the fastest clock source per tick of the clock's */
+
+#if TIMER_NUM_DEADLINES > 0
+static TimerInstance* deadlineTimer = NULL;               /**< Hardware timer keeping deadlines, if any */
+static TimerDeadline deadlines [TIMER_NUM_DEADLINES];     /**< Deadlines, indexed by identifier */
+static unsigned char deadlineHeap [TIMER_NUM_DEADLINES];  /**< Identifiers of pending deadlines, as a binary min-heap on due time */
+static unsigned int numDeadlines = 0;                     /**< Number of pending deadlines */
+static unsigned long long int deadlineBaseTicks = 0;      /**< Time the current interval started from, in ticks of the fastest clock source */
+static unsigned int deadlineStartCount = 0;               /**< Counter value the current interval started from */
+static unsigned int deadlineCompareMatch = 0;             /**< Counter value the current interval ends on */
+static unsigned long int deadlineTickRatio = 0;           /**< Ticks of the fastest clock source per tick of the current interval's, or zero while stopped */
+static unsigned int deadlineHandlersRunning = FALSE;      /**< Nonzero while due deadlines are being handled */
+static unsigned long int deadlineTickRatios [NUM_TIMER_CLKSOURCES]; /**< Ticks of the fastest clock source per tick of each, or zero if unavailable */
+#endif
+
+#if TIMER_CAPTURE_BUFFER_SIZE > 0
+static TimerCaptureBuffer captureBuffers [SYSTEM_NUM_TIMERS]; /**< Captured timestamps, indexed by system timer ID */
+#endif
+
 /**
  * Callback function for timer compare match events
  */
 static void TimerCompareMatchCallback();
 
+/**
+ * Callback function for compare match events of the virtual timer base
+ */
+static void VirtualTimerCompareMatchCallback();
+
+/**
+ * Provides the compare match value for the given sub-cycle of a timer
+ */
+static unsigned int GetTimerSubCycleCompareMatch(TimerInstance* instance, unsigned int subCycle);
+
+/**
+ * Converts a time in units of the given resolution to a number of ticks at the
+ * given frequency, truncating any partial tick
+ */
+static unsigned long long int ConvertTimeToTicks(unsigned long int numUnits, unsigned long int unitsPerSec, unsigned long int frequency);
+
+/**
+ * Configures the given timer to complete a cycle in the given time, in units
+ * of the given resolution
+ *
+ * \return Nonzero if the cycle time was set, zero otherwise
+ */
+static unsigned int SetTimerCycleTime(TimerInstance* instance, unsigned long int numUnits, unsigned long int unitsPerSec);
+
+/**
+ * Finds the cycle configuration with the fewest compare matches per cycle,
+ * using the fastest clock source that allows them
+ *
+ * \return Nonzero if a configuration was found, zero otherwise
+ */
+static unsigned int FindFirstFitTimerCycle(TimerInstance* instance, unsigned long int numUnits, unsigned long int unitsPerSec, System_TimerClockSource firstClockSource, System_TimerClockSource lastClockSource, TimerCycle* cycle);
+
+/**
+ * Finds the cycle configuration with the smallest cycle time error, using the
+ * fewest compare matches per cycle among equally accurate ones
+ *
+ * \return Nonzero if a configuration was found, zero otherwise
+ */
+static unsigned int FindBestFitTimerCycle(TimerInstance* instance, unsigned long int numUnits, unsigned long int unitsPerSec, System_TimerClockSource firstClockSource, System_TimerClockSource lastClockSource, TimerCycle* cycle);
+
+/**
+ * Splits the given cycle into compare match values and applies them to the
+ * timer
+ */
+static void ApplyTimerCycle(TimerInstance* instance, TimerCycle* cycle, unsigned long long int numRequestedTicks);
+
+/**
+ * Switches the given hardware timer to the cycle time staged while it ran,
+ * from the start of a cycle
+ */
+static void ApplyStagedTimerCycle(TimerInstance* instance);
+
+/**
+ * Provides the frequency of the fastest clock source
+ */
+static unsigned long int GetFastestSourceFrequency();
+
+/**
+ * Counts a compare match for the given timer, along with any missed before
+ * it, completing cycles and calling the cycle handler as necessary
+ */
+static void CountTimerCompareMatch(TimerInstance* instance, unsigned int numMissed);
+
+/**
+ * Calls the given timer's cycle handler, if any
+ */
+static void CallTimerCycleHandler(TimerInstance* instance);
+
+/**
+ * Provides the wave generation mode the given timer runs in
+ */
+static System_TimerWaveGenMode GetTimerWaveGenMode(TimerInstance* instance);
+
+/**
+ * Provides the PWM compare value giving the given timer's duty cycle at its
+ * current period, or the period waiting to take over
+ */
+static unsigned int GetTimerPwmCompareMatch(TimerInstance* instance);
+
+/**
+ * Provides whether the given running hardware timer needs its compare match
+ * interrupt
+ *
+ * \return Nonzero if the interrupt is needed, zero otherwise
+ */
+static unsigned int IsTimerCompareMatchEventNeeded(TimerInstance* instance);
+
+/**
+ * Provides the number of clock source ticks counted by the monotonic clock
+ *
+ * \return Number of ticks, or zero if the clock is not running
+ */
+static unsigned long long int GetTimerClockSourceTicks();
+
+/**
+ * Checks that the given hardware timer can be started
+ *
+ * \return Nonzero if the timer has a cycle time and a compare match event,
+ * zero otherwise
+ */
+static unsigned int CanStartTimer(TimerInstance* instance);
+
+/**
+ * Registers the given hardware timer's compare match callback, and sets up
+ * its event and waveform, ready for its clock source to be set
+ */
+static void PrepareTimerStart(TimerInstance* instance);
+
+/**
+ * Registers the compare match callback of one of the given running hardware
+ * timer's other compare channels, and enables its event if the channel has a
+ * handler and compare value, or disables it otherwise
+ */
+static void StartTimerChannel(TimerInstance* instance, unsigned int output);
+
+/**
+ * Calls the handler of the compare channel whose event occurred
+ */
+static void TimerChannelCallback(System_EventType event);
+
+/**
+ * Writes the length of the sequence step that just started, as the previous
+ * one ends, and stops or starts the sequence over after the last step
+ */
+static void TimerSequenceCallback(System_EventType event);
+
+/**
+ * Gives the given stopped timer's compare match back to its own cycle time
+ */
+static void StopTimerSequence(TimerInstance* instance);
+
+/**
+ * Moves every timer in the given group back to the start of its first
+ * sub-cycle, and sets its clock source
+ *
+ * \note This must be called with interrupts disabled
+ */
+static void AlignTimerGroup(TimerGroup* group, unsigned int isStarting);
+
+/**
+ * Provides the clock source shared by all virtual timers
+ */
+static System_TimerClockSource GetVirtualTimerClockSource();
+
+/**
+ * Links a virtual timer into the list so that its next compare match occurs
+ * the given number of ticks after the last match of the virtual timer base
+ */
+static void InsertVirtualTimer(TimerInstance* instance, unsigned long int numTicks);
+
+/**
+ * Unlinks a virtual timer from the list, if present
+ */
+static void RemoveVirtualTimer(TimerInstance* instance);
+
+/**
+ * Adds a virtual timer to the base, starting the base if it was idle
+ */
+static unsigned int StartVirtualTimer(TimerInstance* instance);
+
+/**
+ * Removes a virtual timer from the base, stopping the base if it is now idle
+ */
+static void StopVirtualTimer(TimerInstance* instance);
+
+/**
+ * Stops the hardware timer used as the virtual timer base
+ */
+static void StopVirtualTimerBase();
+
+#if TIMER_NUM_DEADLINES > 0
+/**
+ * Handles due deadlines and starts the next interval, for use as the deadline
+ * timer's compare match callback
+ */
+static void TimerDeadlineCallback(System_EventType event);
+
+/**
+ * Provides the deadline timer's current time, in ticks of the fastest clock
+ * source
+ */
+static unsigned long long int GetTimerDeadlineTicks();
+
+/**
+ * Starts an interval of the deadline timer ending on the earliest deadline, or
+ * as near as the counter reaches, stopping the timer if there are none
+ */
+static void StartTimerDeadlineInterval();
+
+/**
+ * Ends the deadline timer's current interval early if the earliest deadline
+ * is due before it ends
+ */
+static void ShortenTimerDeadlineInterval();
+
+/**
+ * Moves a deadline toward the top of the heap until it is in order
+ */
+static void SiftTimerDeadlineUp(unsigned int heapIdx);
+
+/**
+ * Moves a deadline toward the bottom of the heap until it is in order
+ */
+static void SiftTimerDeadlineDown(unsigned int heapIdx);
+
+/**
+ * Takes the deadline at the given position out of the heap
+ */
+static void RemoveTimerDeadline(unsigned int heapIdx);
+
+/**
+ * Stops the deadline timer and drops every deadline
+ */
+static void StopTimerDeadlines();
+#endif
+
+#if TIMER_CAPTURE_BUFFER_SIZE > 0
+/**
+ * Timestamps an edge captured by a timer, for use as a callback function
+ */
+static void TimerCaptureCallback(System_EventType event);
+
+/**
+ * Stops the given hardware timer capturing its input
+ */
+static void StopTimerCapture(TimerInstance* instance);
+#endif
+
+#if TIMER_LATENCY_STATS
+/**
+ * Records the time since the given timer's last compare match as a cycle
+ * handler latency
+ */
+static void RecordTimerLatency(TimerInstance* instance);
+
+/**
+ * Clears the given timer's latency statistics
+ *
+ * \note The timer's interrupt must not be able to run while this is called
+ */
+static void ClearTimerLatencyStats(TimerInstance* instance);
+#endif
+
 void
 InitTimers()
 {
@@ -38,7 +498,7 @@ InitTimers()
   unsigned int timerIdx;
   for(
       timerIdx = 0;
-      timerIdx < SYSTEM_NUM_TIMERS;
+      timerIdx < TIMER_NUM_INSTANCES;
       timerIdx++
      )
   {
@@ -54,7 +514,7 @@ CreateTimer()
 {
   if (
       (timersInitialized == FALSE) ||
-      (numTimerInstances >= SYSTEM_NUM_TIMERS)
+      (numTimerInstances >= TIMER_NUM_INSTANCES)
      )
   {
     return NULL;
@@ -63,31 +523,98 @@ CreateTimer()
   unsigned int timerIdx;
   for(
       timerIdx = 0;
-      timerIdx < SYSTEM_NUM_TIMERS;
+      timerIdx < TIMER_NUM_INSTANCES;
       timerIdx++
      )
   {
     if (timerInstancesInUse[timerIdx] == FALSE)
     {
       TimerInstance* newTimer = &timerInstances[timerIdx];
-      
-      newTimer->id = timerIdx;
+
+      if (timerIdx < TIMER_NUM_HARDWARE_TIMERS)
+      {
+        newTimer->id = timerIdx;
+        newTimer->isVirtual = FALSE;
+      }
+      else
+      {
+        newTimer->id = TIMER_VIRTUAL_BASE;
+        newTimer->isVirtual = TRUE;
+      }
+
       newTimer->status = TIMER_STATUS_STOPPED;
       newTimer->clockSource = SYSTEM_TIMER_CLKSOURCE_OFF;
       newTimer->compareMatch = 0;
+      newTimer->finalCompareMatch = 0;
+      newTimer->solverMode = TIMER_SOLVER_FIRST_FIT;
+      newTimer->cycleTicks = 0;
+      newTimer->cycleErrorTicks = 0;
       newTimer->compareMatchesPerCycle = 1;
-      newTimer->compareOutputMode = SYSTEM_TIMER_OUTPUT_MODE_NONE;
+
+      unsigned int outputIdx;
+      for(
+          outputIdx = 0;
+          outputIdx < SYSTEM_NUM_TIMER_OUTPUTS;
+          outputIdx++
+         )
+      {
+        newTimer->channels[outputIdx].outputMode = SYSTEM_TIMER_OUTPUT_MODE_NONE;
+        newTimer->channels[outputIdx].compareMatch = 0;
+        newTimer->channels[outputIdx].handler = NULL;
+        newTimer->channels[outputIdx].handlerContext = NULL;
+      }
+
       newTimer->numCompareMatches = 0;
       newTimer->numCycles = 0;
+      newTimer->cycleHandler = NULL;
+      newTimer->cycleHandlerEx = NULL;
+      newTimer->cycleHandlerContext = NULL;
+      newTimer->handlerMode = TIMER_HANDLER_DEFERRED;
+      newTimer->catchUpPolicy = TIMER_CATCHUP_SKIP;
+      newTimer->numMissedCycles = 0;
+      newTimer->lastMissedCycles = 0;
+      newTimer->numOverruns = 0;
+      newTimer->virtualDelta = 0;
+      newTimer->nextVirtual = NULL;
+      newTimer->pwmMode = TIMER_PWM_NONE;
+      newTimer->pwmDutyCycle = 0;
+      newTimer->pwmCompareMatch = 0;
+      newTimer->pwmUpdatePending = FALSE;
+      newTimer->cycleUpdatePending = FALSE;
+      newTimer->sequence = NULL;
+#if TIMER_LATENCY_STATS
+      ClearTimerLatencyStats(newTimer);
+#endif
+#if TIMER_CAPTURE_BUFFER_SIZE > 0
+      newTimer->captureEdge = SYSTEM_TIMER_CAPTURE_NONE;
+      newTimer->captureBase = 0;
+#endif
 
       StopTimer(newTimer);
 
-      System_EventType compareMatchEvent = System_GetTimerCallbackEvent(newTimer->id);
-      System_DisableEvent(compareMatchEvent);
-      System_RegisterCallback(
-          NULL,
-          compareMatchEvent
-          );
+      if (newTimer->isVirtual == FALSE)
+      {
+        System_EventType compareMatchEvent = System_GetTimerCallbackEvent(newTimer->id);
+        System_DisableEvent(compareMatchEvent);
+        System_RegisterCallback(
+            NULL,
+            compareMatchEvent
+            );
+        SetTimerEventImmediate(compareMatchEvent, FALSE);
+
+        // Misses from a previous user of the timer are not this one's
+        TakeNumMissedTimerEvents(compareMatchEvent);
+
+#if TIMER_CAPTURE_BUFFER_SIZE > 0
+        // Nor is its input capture
+        StopTimerCapture(newTimer);
+#endif
+
+        if (compareMatchEvent < SYSTEM_NUM_EVENTS)
+        {
+          eventTimerInstances[compareMatchEvent] = newTimer;
+        }
+      }
 
       timerInstancesInUse[timerIdx] = TRUE;
       numTimerInstances++;
@@ -114,7 +641,7 @@ DestroyTimer(TimerInstance** instance)
   unsigned int timerIdx;
   for(
       timerIdx = 0;
-      timerIdx < SYSTEM_NUM_TIMERS;
+      timerIdx < TIMER_NUM_INSTANCES;
       timerIdx++
      )
   {
@@ -131,16 +658,55 @@ DestroyTimer(TimerInstance** instance)
 void
 DestroyAllTimers()
 {
+  // Nothing may go on reading a timer once it is gone
+  if (clockTimer != NULL)
+  {
+    StopTimer(clockTimer);
+  }
+
+#if TIMER_NUM_DEADLINES > 0
+  if (deadlineTimer != NULL)
+  {
+    StopTimer(deadlineTimer);
+  }
+#endif
+
   unsigned int timerIdx;
   for(
       timerIdx = 0;
-      timerIdx < SYSTEM_NUM_TIMERS;
+      timerIdx < TIMER_NUM_INSTANCES;
       timerIdx++
      )
   {
+#if TIMER_CAPTURE_BUFFER_SIZE > 0
+    if (
+        (timerInstancesInUse[timerIdx] == TRUE) &&
+        (timerInstances[timerIdx].captureEdge != SYSTEM_TIMER_CAPTURE_NONE)
+       )
+    {
+      StopTimer(&timerInstances[timerIdx]);
+    }
+#endif
+
     timerInstancesInUse[timerIdx] = FALSE;
   }
 
+  System_EventType eventIdx;
+  for(
+      eventIdx = 0;
+      eventIdx < SYSTEM_NUM_EVENTS;
+      eventIdx++
+     )
+  {
+    eventTimerInstances[eventIdx] = NULL;
+    SetTimerEventImmediate(eventIdx, FALSE);
+  }
+
+  if (virtualTimerList != NULL)
+  {
+    StopVirtualTimerBase();
+  }
+
   numTimerInstances = 0;
 }
 
@@ -150,7 +716,7 @@ GetTimerStatus(TimerInstance* instance)
   unsigned int timerIdx;
   for(
       timerIdx = 0;
-      timerIdx < SYSTEM_NUM_TIMERS;
+      timerIdx < TIMER_NUM_INSTANCES;
       timerIdx++
      )
   {
@@ -162,7 +728,7 @@ GetTimerStatus(TimerInstance* instance)
       return instance->status;
     }
   }
-  
+
   return TIMER_STATUS_INVALID;
 }
 
@@ -178,6 +744,56 @@ GetTimerCompareMatch(TimerInstance* instance)
   return instance->compareMatch;
 }
 
+unsigned int
+GetTimerFinalCompareMatch(TimerInstance* instance)
+{
+  return instance->finalCompareMatch;
+}
+
+TimerSolverMode
+GetTimerSolverMode(TimerInstance* instance)
+{
+  return instance->solverMode;
+}
+
+unsigned int
+SetTimerSolverMode(
+    TimerInstance*  instance,
+    TimerSolverMode mode
+    )
+{
+  switch (mode)
+  {
+    case TIMER_SOLVER_FIRST_FIT:
+    case TIMER_SOLVER_BEST_FIT:
+      instance->solverMode = mode;
+      return TRUE;
+      break;
+
+    default:
+      return FALSE;
+      break;
+  };
+}
+
+unsigned long long int
+GetTimerCycleTicks(TimerInstance* instance)
+{
+  return instance->cycleTicks;
+}
+
+long long int
+GetTimerCycleErrorTicks(TimerInstance* instance)
+{
+  return instance->cycleErrorTicks;
+}
+
+unsigned int
+IsTimerCycleUpdatePending(TimerInstance* instance)
+{
+  return instance->cycleUpdatePending;
+}
+
 unsigned int
 GetTimerCompareMatchesPerCycle(TimerInstance* instance)
 {
@@ -195,15 +811,17 @@ StartTimer(TimerInstance* instance)
     return FALSE;
   }
 
-  System_EventType event = System_GetTimerCallbackEvent(instance->id);
+  if (instance->isVirtual == TRUE)
+  {
+    return StartVirtualTimer(instance);
+  }
 
-  System_RegisterCallback(
-      TimerCompareMatchCallback,
-      event
-      );
-  System_EnableEvent(event);
+  if (CanStartTimer(instance) == FALSE)
+  {
+    return FALSE;
+  }
 
-  System_TimerSetWaveGenMode(instance->id, SYSTEM_TIMER_WAVEGEN_MODE_CTC);
+  PrepareTimerStart(instance);
 
   System_TimerSetClockSource(
       instance->id,
@@ -217,211 +835,2711 @@ StartTimer(TimerInstance* instance)
 void
 StopTimer(TimerInstance* instance)
 {
+  if (instance->isVirtual == TRUE)
+  {
+    StopVirtualTimer(instance);
+    return;
+  }
+
   instance->status = TIMER_STATUS_STOPPED;
   System_TimerSetClockSource(instance->id, SYSTEM_TIMER_CLKSOURCE_OFF);
 
-  System_EventType event = System_GetTimerCallbackEvent(instance->id);
+  if (instance->sequence != NULL)
+  {
+    StopTimerSequence(instance);
+  }
+
+  // A cycle time set while running is kept for the next start
+  if (instance->cycleUpdatePending == TRUE)
+  {
+    ApplyStagedTimerCycle(instance);
+  }
+
+  if (instance == clockTimer)
+  {
+    clockTimer = NULL;
+  }
+
+#if TIMER_NUM_DEADLINES > 0
+  if (instance == deadlineTimer)
+  {
+    StopTimerDeadlines();
+  }
+#endif
+
+  System_EventType event = System_GetTimerCallbackEvent(instance->id);
+  System_DisableEvent(event);
+
+  unsigned int outputIdx;
+  for(
+      outputIdx = 1;
+      outputIdx < SYSTEM_NUM_TIMER_OUTPUTS;
+      outputIdx++
+     )
+  {
+    System_DisableEvent(System_GetTimerChannelEvent(instance->id, (System_TimerCompareOutput)outputIdx));
+  }
+
+#if TIMER_CAPTURE_BUFFER_SIZE > 0
+  if (instance->captureEdge != SYSTEM_TIMER_CAPTURE_NONE)
+  {
+    StopTimerCapture(instance);
+  }
+#endif
+}
+
+void
+InitTimerGroup(
+    TimerGroup* group
+    )
+{
+  if (group == NULL)
+  {
+    return;
+  }
+
+  group->numTimers = 0;
+}
+
+unsigned int
+AddTimerToGroup(
+    TimerGroup*     group,
+    TimerInstance*  instance
+    )
+{
+  if (
+      (group == NULL) ||
+      (instance == NULL) ||
+      (instance->isVirtual == TRUE) ||
+      (group->numTimers >= TIMER_GROUP_MAX_TIMERS)
+     )
+  {
+    return FALSE;
+  }
+
+  unsigned int timerIdx;
+  for(
+      timerIdx = 0;
+      timerIdx < group->numTimers;
+      timerIdx++
+     )
+  {
+    if (group->timers[timerIdx] == instance)
+    {
+      return FALSE;
+    }
+  }
+
+  group->timers[group->numTimers] = instance;
+  group->numTimers++;
+
+  return TRUE;
+}
+
+unsigned int
+StartTimerGroup(
+    TimerGroup* group
+    )
+{
+  if (
+      (group == NULL) ||
+      (group->numTimers == 0)
+     )
+  {
+    return FALSE;
+  }
+
+  // Check every timer first, so that the group either starts whole or not at
+  // all
+  unsigned int timerIdx;
+  for(
+      timerIdx = 0;
+      timerIdx < group->numTimers;
+      timerIdx++
+     )
+  {
+    if (CanStartTimer(group->timers[timerIdx]) == FALSE)
+    {
+      return FALSE;
+    }
+  }
+
+  System_DisableInterrupts();
+
+  for(
+      timerIdx = 0;
+      timerIdx < group->numTimers;
+      timerIdx++
+     )
+  {
+    PrepareTimerStart(group->timers[timerIdx]);
+  }
+
+  AlignTimerGroup(group, TRUE);
+  System_EnableInterrupts();
+
+  return TRUE;
+}
+
+void
+StopTimerGroup(
+    TimerGroup* group
+    )
+{
+  if (group == NULL)
+  {
+    return;
+  }
+
+  // Holding the prescalers stops every timer on the same tick, before each
+  // is stopped in turn
+  System_DisableInterrupts();
+  unsigned int isHeld = System_TimersHoldPrescalers(TRUE);
+
+  unsigned int timerIdx;
+  for(
+      timerIdx = 0;
+      timerIdx < group->numTimers;
+      timerIdx++
+     )
+  {
+    StopTimer(group->timers[timerIdx]);
+  }
+
+  if (isHeld == TRUE)
+  {
+    System_TimersHoldPrescalers(FALSE);
+  }
+
+  System_EnableInterrupts();
+}
+
+void
+ResetTimerGroup(
+    TimerGroup* group
+    )
+{
+  if (group == NULL)
+  {
+    return;
+  }
+
+  System_DisableInterrupts();
+  AlignTimerGroup(group, FALSE);
+  System_EnableInterrupts();
+}
+
+void
+InitTimerSequence(
+    TimerSequence*        sequence,
+    const unsigned int*   steps,
+    unsigned int          numSteps,
+    unsigned int          clockSource,
+    unsigned int          isLooping,
+    TimerSequenceHandler  handler,
+    void*                 context
+    )
+{
+  sequence->steps = steps;
+  sequence->numSteps = numSteps;
+  sequence->clockSource = clockSource;
+  sequence->isLooping = isLooping;
+  sequence->handler = handler;
+  sequence->handlerContext = context;
+  sequence->step = 0;
+  sequence->numPasses = 0;
+}
+
+unsigned int
+StartTimerSequence(
+    TimerInstance*  instance,
+    TimerSequence*  sequence
+    )
+{
+  if (
+      (instance->isVirtual == TRUE) ||
+      (instance->pwmMode != TIMER_PWM_NONE) ||
+      (sequence == NULL) ||
+      (sequence->steps == NULL) ||
+      (sequence->numSteps == 0) ||
+      (sequence->clockSource >= NUM_TIMER_CLKSOURCES) ||
+      (sequence->clockSource == SYSTEM_TIMER_CLKSOURCE_OFF)
+     )
+  {
+    return FALSE;
+  }
+
+  System_EventType event = System_GetTimerCallbackEvent(instance->id);
+
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return FALSE;
+  }
+
+  // Checked up front, so that the interrupt never has to
+  unsigned long int maxCompareMatch = System_TimerGetMaxValue(instance->id);
+
+  unsigned int stepIdx;
+  for(
+      stepIdx = 0;
+      stepIdx < sequence->numSteps;
+      stepIdx++
+     )
+  {
+    unsigned int numTicks = System_ReadTableValue(&sequence->steps[stepIdx]);
+
+    if (
+        (numTicks == 0) ||
+        (numTicks > maxCompareMatch)
+       )
+    {
+      return FALSE;
+    }
+  }
+
+  StopTimer(instance);
+
+  sequence->step = 0;
+  sequence->numPasses = 0;
+  instance->sequence = sequence;
+
+  eventTimerInstances[event] = instance;
+  System_RegisterCallback(
+      TimerSequenceCallback,
+      event
+      );
+
+  // The next step must be written before the counter gets to it
+  SetTimerEventImmediate(event, TRUE);
+  System_TimerSetWaveGenMode(instance->id, SYSTEM_TIMER_WAVEGEN_MODE_CTC);
+  System_TimerSetCompareMatch(instance->id, System_ReadTableValue(&sequence->steps[0]));
+  System_TimerClearCount(instance->id);
+  System_EnableEvent(event);
+
+  System_TimerSetClockSource(instance->id, (System_TimerClockSource)sequence->clockSource);
+  instance->status = TIMER_STATUS_RUNNING;
+
+  return TRUE;
+}
+
+TimerSequence*
+GetTimerSequence(
+    TimerInstance*  instance
+    )
+{
+  return instance->sequence;
+}
+
+unsigned int
+SetTimerCycleTimeMilliSec(
+    TimerInstance*    instance,
+    unsigned int      numMilliSec
+    )
+{
+  return SetTimerCycleTime(instance, numMilliSec, 1000);
+}
+
+unsigned int
+SetTimerCycleTimeMicroSec(
+    TimerInstance*    instance,
+    unsigned long int numMicroSec
+    )
+{
+  return SetTimerCycleTime(instance, numMicroSec, 1000000);
+}
+
+unsigned int
+SetTimerCycleTimeTicks(
+    TimerInstance*    instance,
+    unsigned long int numTicks
+    )
+{
+  return SetTimerCycleTime(instance, numTicks, GetFastestSourceFrequency());
+}
+
+unsigned int
+SetTimerCycleTime(
+    TimerInstance*    instance,
+    unsigned long int numUnits,
+    unsigned long int unitsPerSec
+    )
+{
+  if (
+      (numUnits == 0) ||
+      (unitsPerSec == 0)
+     )
+  {
+    return FALSE;
+  }
+
+  System_TimerClockSource firstClockSource = 0;
+  System_TimerClockSource lastClockSource = NUM_TIMER_CLKSOURCES - 1;
+
+  // Virtual timers all share the clock source of the virtual timer base
+  if (instance->isVirtual == TRUE)
+  {
+    firstClockSource = GetVirtualTimerClockSource();
+    lastClockSource = firstClockSource;
+
+    if (firstClockSource == SYSTEM_TIMER_CLKSOURCE_INVALID)
+    {
+      return FALSE;
+    }
+  }
+
+  TimerCycle cycle = { SYSTEM_TIMER_CLKSOURCE_INVALID, 0, 0 };
+  unsigned int cycleFound = FALSE;
+
+  switch (instance->solverMode)
+  {
+    case TIMER_SOLVER_FIRST_FIT:
+      cycleFound = FindFirstFitTimerCycle(instance, numUnits, unitsPerSec, firstClockSource, lastClockSource, &cycle);
+      break;
+
+    case TIMER_SOLVER_BEST_FIT:
+      cycleFound = FindBestFitTimerCycle(instance, numUnits, unitsPerSec, firstClockSource, lastClockSource, &cycle);
+      break;
+
+    default:
+      break;
+  };
+
+  if (cycleFound == FALSE)
+  {
+    return FALSE;
+  }
+
+  ApplyTimerCycle(
+      instance,
+      &cycle,
+      ConvertTimeToTicks(numUnits, unitsPerSec, GetFastestSourceFrequency())
+      );
+
+  return TRUE;
+}
+
+unsigned int
+FindFirstFitTimerCycle(
+    TimerInstance*          instance,
+    unsigned long int       numUnits,
+    unsigned long int       unitsPerSec,
+    System_TimerClockSource firstClockSource,
+    System_TimerClockSource lastClockSource,
+    TimerCycle*             cycle
+    )
+{
+  unsigned long int maxCompareMatch = System_TimerGetMaxValue(instance->id);
+  unsigned long int clockSourceFrequency = 0;
+  unsigned long int slowestFrequency = 0;
+  unsigned int clockSourceIter;
+
+  if (maxCompareMatch == 0)
+  {
+    return FALSE;
+  }
+
+  // The slowest clock source needs the fewest ticks, so it alone determines
+  // the minimum number of compare matches per cycle
+  for(
+      clockSourceIter = firstClockSource;
+      clockSourceIter <= lastClockSource;
+      clockSourceIter++
+     )
+  {
+    clockSourceFrequency = System_TimerGetSourceFrequency(clockSourceIter);
+    if (
+        (clockSourceFrequency != 0) &&
+        (
+         (slowestFrequency == 0) ||
+         (clockSourceFrequency < slowestFrequency)
+        )
+       )
+    {
+      slowestFrequency = clockSourceFrequency;
+    }
+  }
+
+  if (slowestFrequency == 0)
+  {
+    return FALSE;
+  }
+
+  unsigned long long int numTicks = ConvertTimeToTicks(numUnits, unitsPerSec, slowestFrequency);
+  unsigned long long int minCompareMatchesPerCycle = (numTicks + maxCompareMatch - 1) / maxCompareMatch;
+
+  if (minCompareMatchesPerCycle == 0)
+  {
+    minCompareMatchesPerCycle = 1;
+  }
+
+  // Each sub-cycle must last at least one unit of the requested resolution
+  if (
+      (minCompareMatchesPerCycle > numUnits) ||
+      (minCompareMatchesPerCycle > UINT_MAX)
+     )
+  {
+    return FALSE;
+  }
+
+  // Pick the fastest clock source that needs no more compare matches
+  for(
+      clockSourceIter = firstClockSource;
+      clockSourceIter <= lastClockSource;
+      clockSourceIter++
+     )
+  {
+    clockSourceFrequency = System_TimerGetSourceFrequency(clockSourceIter);
+    if (clockSourceFrequency == 0)
+    {
+      continue;
+    }
+
+    numTicks = ConvertTimeToTicks(numUnits, unitsPerSec, clockSourceFrequency);
+    unsigned long long int compareMatchesPerCycle = (numTicks + maxCompareMatch - 1) / maxCompareMatch;
+
+    if (
+        (numTicks == 0) ||
+        (numTicks > ULONG_MAX) ||
+        (compareMatchesPerCycle > minCompareMatchesPerCycle)
+       )
+    {
+      continue;
+    }
+
+    cycle->clockSource = clockSourceIter;
+    cycle->numTicks = (unsigned long int)numTicks;
+    cycle->compareMatchesPerCycle = (unsigned long int)compareMatchesPerCycle;
+
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+unsigned int
+FindBestFitTimerCycle(
+    TimerInstance*          instance,
+    unsigned long int       numUnits,
+    unsigned long int       unitsPerSec,
+    System_TimerClockSource firstClockSource,
+    System_TimerClockSource lastClockSource,
+    TimerCycle*             cycle
+    )
+{
+  unsigned long int maxCompareMatch = System_TimerGetMaxValue(instance->id);
+  unsigned long int fastestFrequency = GetFastestSourceFrequency();
+  unsigned long long int numRequestedTicks = ConvertTimeToTicks(numUnits, unitsPerSec, fastestFrequency);
+  unsigned long long int bestError = 0;
+  unsigned int cycleFound = FALSE;
+  unsigned int clockSourceIter;
+
+  if (maxCompareMatch == 0)
+  {
+    return FALSE;
+  }
+
+  for(
+      clockSourceIter = firstClockSource;
+      clockSourceIter <= lastClockSource;
+      clockSourceIter++
+     )
+  {
+    unsigned long int clockSourceFrequency = System_TimerGetSourceFrequency(clockSourceIter);
+    if (clockSourceFrequency == 0)
+    {
+      continue;
+    }
+
+    // The cycle time lies between these two tick counts of this clock source
+    unsigned long long int truncatedTicks = ConvertTimeToTicks(numUnits, unitsPerSec, clockSourceFrequency);
+    unsigned long long int numTicks;
+    for(
+        numTicks = truncatedTicks;
+        numTicks <= truncatedTicks + 1;
+        numTicks++
+       )
+    {
+      unsigned long long int compareMatchesPerCycle = (numTicks + maxCompareMatch - 1) / maxCompareMatch;
+
+      // Each sub-cycle must last at least one unit of the requested resolution
+      if (
+          (numTicks == 0) ||
+          (numTicks > ULONG_MAX) ||
+          (compareMatchesPerCycle > numUnits) ||
+          (compareMatchesPerCycle > UINT_MAX)
+         )
+      {
+        continue;
+      }
+
+      unsigned long long int cycleTicks = numTicks * (fastestFrequency / clockSourceFrequency);
+      unsigned long long int error = (cycleTicks > numRequestedTicks) ?
+        (cycleTicks - numRequestedTicks) :
+        (numRequestedTicks - cycleTicks);
+
+      if (
+          (cycleFound == FALSE) ||
+          (error < bestError) ||
+          (
+           (error == bestError) &&
+           (compareMatchesPerCycle < cycle->compareMatchesPerCycle)
+          )
+         )
+      {
+        cycle->clockSource = clockSourceIter;
+        cycle->numTicks = (unsigned long int)numTicks;
+        cycle->compareMatchesPerCycle = (unsigned long int)compareMatchesPerCycle;
+        bestError = error;
+        cycleFound = TRUE;
+      }
+    }
+  }
+
+  return cycleFound;
+}
+
+void
+ApplyTimerCycle(
+    TimerInstance*          instance,
+    TimerCycle*             cycle,
+    unsigned long long int  numRequestedTicks
+    )
+{
+  unsigned long int maxCompareMatch = System_TimerGetMaxValue(instance->id);
+
+  // Split the ticks evenly, leaving the remainder to the final sub-cycle so
+  // that the whole cycle is exact
+  unsigned long int compareMatch = cycle->numTicks / cycle->compareMatchesPerCycle;
+  unsigned long int finalCompareMatch = compareMatch + (cycle->numTicks % cycle->compareMatchesPerCycle);
+
+  if (finalCompareMatch > maxCompareMatch)
+  {
+    compareMatch++;
+    finalCompareMatch = cycle->numTicks - ((cycle->compareMatchesPerCycle - 1) * compareMatch);
+  }
+
+  instance->cycleTicks =
+    (unsigned long long int)cycle->numTicks *
+    (GetFastestSourceFrequency() / System_TimerGetSourceFrequency(cycle->clockSource));
+
+  if (instance->cycleTicks >= numRequestedTicks)
+  {
+    instance->cycleErrorTicks = (long long int)(instance->cycleTicks - numRequestedTicks);
+  }
+  else
+  {
+    instance->cycleErrorTicks = -((long long int)(numRequestedTicks - instance->cycleTicks));
+  }
+
+  if (
+      (instance->isVirtual == FALSE) &&
+      (instance->status == TIMER_STATUS_RUNNING)
+     )
+  {
+    // Leave the new configuration for the compare match ending the current
+    // cycle, so that no cycle is cut short. Deferred timers only apply it once
+    // the event is processed, which can stretch the cycle it is applied in
+    System_EventType event = System_GetTimerCallbackEvent(instance->id);
+    System_DisableEvent(event);
+    instance->stagedClockSource = cycle->clockSource;
+    instance->stagedCompareMatch = (unsigned int)compareMatch;
+    instance->stagedFinalMatch = (unsigned int)finalCompareMatch;
+    instance->stagedMatchesPerCycle = (unsigned int)cycle->compareMatchesPerCycle;
+    instance->cycleUpdatePending = TRUE;
+    System_EnableEvent(event);
+    return;
+  }
+
+  instance->clockSource = cycle->clockSource;
+  instance->compareMatch = (unsigned int)compareMatch;
+  instance->finalCompareMatch = (unsigned int)finalCompareMatch;
+  instance->compareMatchesPerCycle = (unsigned int)cycle->compareMatchesPerCycle;
+
+  if (instance->isVirtual == FALSE)
+  {
+    System_TimerSetClockSource(
+        instance->id,
+        instance->clockSource
+        );
+    System_TimerSetCompareMatch(
+        instance->id,
+        GetTimerSubCycleCompareMatch(instance, instance->numCompareMatches)
+        );
+  }
+}
+
+void
+ApplyStagedTimerCycle(
+    TimerInstance*  instance
+    )
+{
+  unsigned int isClockSourceChanged = (instance->stagedClockSource != instance->clockSource) ? TRUE : FALSE;
+
+  instance->clockSource = instance->stagedClockSource;
+  instance->compareMatch = instance->stagedCompareMatch;
+  instance->finalCompareMatch = instance->stagedFinalMatch;
+  instance->compareMatchesPerCycle = instance->stagedMatchesPerCycle;
+  instance->numCompareMatches = 0;
+  instance->cycleUpdatePending = FALSE;
+
+  System_TimerSetCompareMatch(
+      instance->id,
+      GetTimerSubCycleCompareMatch(instance, 0)
+      );
+
+  // Some targets pause the counter to switch clock source, so leave it be
+  // unless it changes
+  if (
+      (instance->status == TIMER_STATUS_RUNNING) &&
+      (isClockSourceChanged == TRUE)
+     )
+  {
+    System_TimerSetClockSource(
+        instance->id,
+        instance->clockSource
+        );
+  }
+}
+
+unsigned long int
+GetFastestSourceFrequency()
+{
+  // Clock sources are sorted from highest to lowest frequency
+  unsigned int clockSourceIter;
+  for(
+      clockSourceIter = 0;
+      clockSourceIter < NUM_TIMER_CLKSOURCES;
+      clockSourceIter++
+     )
+  {
+    unsigned long int clockSourceFrequency = System_TimerGetSourceFrequency(clockSourceIter);
+
+    if (clockSourceFrequency != 0)
+    {
+      return clockSourceFrequency;
+    }
+  }
+
+  return 0;
+}
+
+unsigned int
+SetTimerCycleTimeSec(
+    TimerInstance*      instance,
+    unsigned int        numSec
+    )
+{
+  unsigned int MAX_NUM_SEC = UINT_MAX / 1000;
+
+  if (numSec > MAX_NUM_SEC)
+  {
+    return FALSE;
+  }
+
+  return SetTimerCycleTimeMilliSec(
+      instance,
+      ((unsigned long int) numSec * 1000)
+      );
+}
+
+unsigned int
+StartTimerClock(
+    TimerInstance*  instance
+    )
+{
+  if (instance->isVirtual == TRUE)
+  {
+    return FALSE;
+  }
+
+  // Clock sources are sorted from highest to lowest frequency
+  System_TimerClockSource clockSource = SYSTEM_TIMER_CLKSOURCE_INVALID;
+  unsigned int clockSourceIter;
+  for(
+      clockSourceIter = 0;
+      clockSourceIter < NUM_TIMER_CLKSOURCES;
+      clockSourceIter++
+     )
+  {
+    unsigned long int frequency = System_TimerGetSourceFrequency(clockSourceIter);
+
+    if (
+        (frequency != 0) &&
+        (
+         (frequency >= TIMER_CLOCK_MIN_FREQUENCY) ||
+         (clockSource == SYSTEM_TIMER_CLKSOURCE_INVALID)
+        )
+       )
+    {
+      clockSource = clockSourceIter;
+    }
+  }
+
+  unsigned long int maxValue = System_TimerGetMaxValue(instance->id);
+
+  if (
+      (clockSource == SYSTEM_TIMER_CLKSOURCE_INVALID) ||
+      (maxValue == 0)
+     )
+  {
+    return FALSE;
+  }
+
+  StopTimer(instance);
+
+  // Wrap at the full range of the counter, in a single compare match. The
+  // compare value is a number of ticks, which the HAL programs as one less
+  // where its counter clears after matching, so each wrap is exactly
+  // maxValue ticks long and that is what the callback adds to the clock.
+  unsigned long int frequency = System_TimerGetSourceFrequency(clockSource);
+  unsigned long int tickRatio = GetFastestSourceFrequency() / frequency;
+  TimerCycle cycle = { clockSource, maxValue, 1 };
+  ApplyTimerCycle(instance, &cycle, (unsigned long long int)maxValue * tickRatio);
+
+  SetTimerHandlerMode(instance, TIMER_HANDLER_IMMEDIATE);
+
+  clockBaseTicks = 0;
+  clockSequence = 0;
+  clockSourceFrequency = frequency;
+  clockTickRatio = tickRatio;
+  clockTimer = instance;
+
+  if (StartTimer(instance) == FALSE)
+  {
+    clockTimer = NULL;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+unsigned long long int
+GetTimerTicks64()
+{
+  return GetTimerClockSourceTicks() * clockTickRatio;
+}
+
+unsigned long long int
+GetTimerMicroSec64()
+{
+  unsigned long long int numTicks = GetTimerClockSourceTicks();
+
+  if (clockSourceFrequency == 0)
+  {
+    return 0;
+  }
+
+  // Whole seconds first, so that the multiplication cannot overflow
+  return
+    ((numTicks / clockSourceFrequency) * 1000000) +
+    (((numTicks % clockSourceFrequency) * 1000000) / clockSourceFrequency);
+}
+
+unsigned int
+IsTimerClockRunning()
+{
+  return (clockTimer != NULL) ? TRUE : FALSE;
+}
+
+unsigned long long int
+GetTimerClockSourceTicks()
+{
+  TimerInstance* instance = clockTimer;
+
+  if (instance == NULL)
+  {
+    return 0;
+  }
+
+  unsigned char sequence;
+  unsigned long long int numTicks;
+
+  do
+  {
+    sequence = clockSequence;
+    numTicks = clockBaseTicks;
+
+    // A wrap the interrupt has not counted yet is counted here instead. The
+    // counter is read again once the wrap is known to have happened, so that
+    // it is not read from before the wrap.
+    unsigned int count = System_TimerGetCount(instance->id);
+    if (System_TimerGetCompareMatchPending(instance->id) != FALSE)
+    {
+      count = System_TimerGetCount(instance->id);
+      numTicks += instance->compareMatch;
+    }
+
+    numTicks += count;
+  }
+  while (
+      ((sequence & 1) != 0) ||
+      (sequence != clockSequence)
+      );
+
+  return numTicks;
+}
+
+unsigned int
+CanStartTimer(
+    TimerInstance*  instance
+    )
+{
+  if (
+      (instance->isVirtual == TRUE) ||
+      (instance->compareMatch == 0) ||
+      (instance->compareMatchesPerCycle == 0) ||
+      (instance->sequence != NULL) ||
+      (System_GetTimerCallbackEvent(instance->id) >= SYSTEM_NUM_EVENTS)
+     )
+  {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+void
+PrepareTimerStart(
+    TimerInstance*  instance
+    )
+{
+  System_EventType event = System_GetTimerCallbackEvent(instance->id);
+
+  eventTimerInstances[event] = instance;
+  System_RegisterCallback(
+      TimerCompareMatchCallback,
+      event
+      );
+
+  if (IsTimerCompareMatchEventNeeded(instance) == TRUE)
+  {
+    System_EnableEvent(event);
+  }
+
+  System_TimerSetWaveGenMode(instance->id, GetTimerWaveGenMode(instance));
+
+  unsigned int outputIdx;
+  for(
+      outputIdx = 1;
+      outputIdx < SYSTEM_NUM_TIMER_OUTPUTS;
+      outputIdx++
+     )
+  {
+    StartTimerChannel(instance, outputIdx);
+  }
+}
+
+void
+StartTimerChannel(
+    TimerInstance*  instance,
+    unsigned int    output
+    )
+{
+  System_EventType event = System_GetTimerChannelEvent(instance->id, (System_TimerCompareOutput)output);
+
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return;
+  }
+
+  TimerChannel* channel = &instance->channels[output];
+  System_DisableEvent(event);
+
+  if (
+      (channel->handler == NULL) ||
+      (channel->compareMatch == 0)
+     )
+  {
+    return;
+  }
+
+  eventTimerInstances[event] = instance;
+  System_RegisterCallback(
+      TimerChannelCallback,
+      event
+      );
+  SetTimerEventImmediate(event, (instance->handlerMode == TIMER_HANDLER_IMMEDIATE) ? TRUE : FALSE);
+  System_EnableEvent(event);
+}
+
+void
+TimerChannelCallback(
+    System_EventType  event
+    )
+{
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return;
+  }
+
+  TimerInstance* instance = eventTimerInstances[event];
+
+  if (instance == NULL)
+  {
+    return;
+  }
+
+  unsigned int outputIdx;
+  for(
+      outputIdx = 1;
+      outputIdx < SYSTEM_NUM_TIMER_OUTPUTS;
+      outputIdx++
+     )
+  {
+    TimerChannelHandler handler = instance->channels[outputIdx].handler;
+
+    if (
+        (handler != NULL) &&
+        (System_GetTimerChannelEvent(instance->id, (System_TimerCompareOutput)outputIdx) == event)
+       )
+    {
+      (*handler)(instance, outputIdx, instance->channels[outputIdx].handlerContext);
+    }
+  }
+}
+
+void
+TimerSequenceCallback(
+    System_EventType  event
+    )
+{
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return;
+  }
+
+  TimerInstance* instance = eventTimerInstances[event];
+
+  if (
+      (instance == NULL) ||
+      (instance->sequence == NULL)
+     )
+  {
+    return;
+  }
+
+  TimerSequence* sequence = instance->sequence;
+  unsigned int step = sequence->step + 1;
+
+  // The counter has just started over, so this sets the length of the step
+  // now running
+  if (step < sequence->numSteps)
+  {
+    System_TimerSetCompareMatch(instance->id, System_ReadTableValue(&sequence->steps[step]));
+    sequence->step = step;
+    return;
+  }
+
+  sequence->numPasses++;
+
+  if (sequence->isLooping == FALSE)
+  {
+    StopTimer(instance);
+  }
+  else
+  {
+    System_TimerSetCompareMatch(instance->id, System_ReadTableValue(&sequence->steps[0]));
+    sequence->step = 0;
+  }
+
+  if (sequence->handler != NULL)
+  {
+    (*sequence->handler)(instance, sequence->handlerContext);
+  }
+}
+
+void
+StopTimerSequence(
+    TimerInstance*  instance
+    )
+{
+  System_EventType event = System_GetTimerCallbackEvent(instance->id);
+  System_DisableEvent(event);
+  SetTimerEventImmediate(event, (instance->handlerMode == TIMER_HANDLER_IMMEDIATE) ? TRUE : FALSE);
+
+  // Pick the cycle back up where it was left, from a cleared counter
+  if (instance->compareMatch != 0)
+  {
+    System_TimerSetCompareMatch(
+        instance->id,
+        GetTimerSubCycleCompareMatch(instance, instance->numCompareMatches)
+        );
+  }
+
+  System_TimerClearCount(instance->id);
+  instance->sequence = NULL;
+}
+
+void
+AlignTimerGroup(
+    TimerGroup*   group,
+    unsigned int  isStarting
+    )
+{
+  // Without a prescaler hold, the counters are cleared last and back to back,
+  // so the timers start within a few cycles of each other
+  unsigned int isHeld = System_TimersHoldPrescalers(TRUE);
+
+  unsigned int timerIdx;
+  for(
+      timerIdx = 0;
+      timerIdx < group->numTimers;
+      timerIdx++
+     )
+  {
+    TimerInstance* instance = group->timers[timerIdx];
+
+    if (
+        (isStarting == FALSE) &&
+        (instance->status != TIMER_STATUS_RUNNING)
+       )
+    {
+      continue;
+    }
+
+    instance->numCompareMatches = 0;
+    System_TimerSetCompareMatch(
+        instance->id,
+        GetTimerSubCycleCompareMatch(instance, 0)
+        );
+    System_TimerSetClockSource(
+        instance->id,
+        instance->clockSource
+        );
+    instance->status = TIMER_STATUS_RUNNING;
+  }
+
+  for(
+      timerIdx = 0;
+      timerIdx < group->numTimers;
+      timerIdx++
+     )
+  {
+    if (group->timers[timerIdx]->status == TIMER_STATUS_RUNNING)
+    {
+      System_TimerClearCount(group->timers[timerIdx]->id);
+    }
+  }
+
+  if (isHeld == TRUE)
+  {
+    System_TimersHoldPrescalers(FALSE);
+  }
+}
+
+#if TIMER_NUM_DEADLINES > 0
+unsigned int
+StartTimerDeadlines(
+    TimerInstance*  instance
+    )
+{
+  if (instance->isVirtual == TRUE)
+  {
+    return FALSE;
+  }
+
+  System_EventType event = System_GetTimerCallbackEvent(instance->id);
+  unsigned long int fastestFrequency = GetFastestSourceFrequency();
+
+  if (
+      (event >= SYSTEM_NUM_EVENTS) ||
+      (fastestFrequency == 0)
+     )
+  {
+    return FALSE;
+  }
+
+  StopTimer(instance);
+
+  if (deadlineTimer != NULL)
+  {
+    StopTimer(deadlineTimer);
+  }
+
+  // Worked out once, so that each interval is chosen without dividing
+  unsigned int clockSourceIter;
+  for(
+      clockSourceIter = 0;
+      clockSourceIter < NUM_TIMER_CLKSOURCES;
+      clockSourceIter++
+     )
+  {
+    unsigned long int frequency = System_TimerGetSourceFrequency(clockSourceIter);
+    deadlineTickRatios[clockSourceIter] = (frequency != 0) ? (fastestFrequency / frequency) : 0;
+  }
+
+  numDeadlines = 0;
+  deadlineBaseTicks = 0;
+  deadlineTickRatio = 0;
+  deadlineHandlersRunning = FALSE;
+
+  unsigned int deadlineIdx;
+  for(
+      deadlineIdx = 0;
+      deadlineIdx < TIMER_NUM_DEADLINES;
+      deadlineIdx++
+     )
+  {
+    deadlines[deadlineIdx].handler = NULL;
+  }
+
+  // The timer only runs while there are deadlines, so it belongs to them
+  // whether running or not
+  deadlineTimer = instance;
+  instance->status = TIMER_STATUS_RUNNING;
+
+  System_RegisterCallback(
+      TimerDeadlineCallback,
+      event
+      );
+  SetTimerEventImmediate(event, TRUE);
+  System_TimerSetWaveGenMode(instance->id, SYSTEM_TIMER_WAVEGEN_MODE_CTC);
+  System_EnableEvent(event);
+
+  return TRUE;
+}
+
+unsigned int
+AddTimerDeadline(
+    TimerDeadlineHandler  handler,
+    void*                 context,
+    unsigned long int     numMicroSec
+    )
+{
+  if (
+      (deadlineTimer == NULL) ||
+      (handler == NULL) ||
+      (numDeadlines >= TIMER_NUM_DEADLINES)
+     )
+  {
+    return TIMER_DEADLINE_INVALID;
+  }
+
+  // Keep the interrupt from seeing the heap half changed
+  System_EventType event = System_GetTimerCallbackEvent(deadlineTimer->id);
+  System_DisableEvent(event);
+
+  unsigned int deadlineIdx = 0;
+  while (deadlines[deadlineIdx].handler != NULL)
+  {
+    deadlineIdx++;
+  }
+
+  // Once the counter has ticked, it only tells the time to within one of its
+  // ticks, so take the latest it could be to keep the deadline from coming
+  // early
+  unsigned long long int nowTicks = GetTimerDeadlineTicks();
+  if (
+      (deadlineTickRatio > 1) &&
+      (System_TimerGetCount(deadlineTimer->id) != deadlineStartCount)
+     )
+  {
+    nowTicks += deadlineTickRatio - 1;
+  }
+
+  TimerDeadline* deadline = &deadlines[deadlineIdx];
+  deadline->dueTicks = nowTicks + ConvertTimeToTicks(numMicroSec, 1000000, GetFastestSourceFrequency());
+  deadline->handler = handler;
+  deadline->context = context;
+  deadline->heapIdx = (unsigned char)numDeadlines;
+
+  deadlineHeap[numDeadlines] = (unsigned char)deadlineIdx;
+  numDeadlines++;
+  SiftTimerDeadlineUp(deadline->heapIdx);
+
+  // Handlers added from a deadline handler are seen to once it returns
+  if (deadlineHandlersRunning == FALSE)
+  {
+    if (deadlineTickRatio == 0)
+    {
+      StartTimerDeadlineInterval();
+    }
+    else if (deadline->heapIdx == 0)
+    {
+      ShortenTimerDeadlineInterval();
+    }
+  }
+
+  System_EnableEvent(event);
+
+  return deadlineIdx;
+}
+
+unsigned int
+CancelTimerDeadline(
+    unsigned int  deadline
+    )
+{
+  if (
+      (deadlineTimer == NULL) ||
+      (deadline >= TIMER_NUM_DEADLINES) ||
+      (deadlines[deadline].handler == NULL)
+     )
+  {
+    return FALSE;
+  }
+
+  System_EventType event = System_GetTimerCallbackEvent(deadlineTimer->id);
+  System_DisableEvent(event);
+
+  // An interval left ending on the cancelled deadline just finds nothing due
+  RemoveTimerDeadline(deadlines[deadline].heapIdx);
+
+  System_EnableEvent(event);
+
+  return TRUE;
+}
+
+unsigned int
+GetNumTimerDeadlines()
+{
+  return numDeadlines;
+}
+
+void
+TimerDeadlineCallback(
+    System_EventType  event
+    )
+{
+  if (deadlineTimer == NULL)
+  {
+    return;
+  }
+
+  // The counter cleared on this match, so the next interval starts from zero
+  deadlineBaseTicks += (unsigned long long int)(deadlineCompareMatch - deadlineStartCount) * deadlineTickRatio;
+  deadlineStartCount = 0;
+
+  deadlineHandlersRunning = TRUE;
+
+  while (
+      (numDeadlines > 0) &&
+      (deadlines[deadlineHeap[0]].dueTicks <= deadlineBaseTicks)
+      )
+  {
+    TimerDeadline* deadline = &deadlines[deadlineHeap[0]];
+    TimerDeadlineHandler handler = deadline->handler;
+    void* context = deadline->context;
+
+    // Free the slot first, so that the handler may add a deadline in it
+    RemoveTimerDeadline(0);
+    (*handler)(context);
+
+    // The handler may have stopped the deadline timer
+    if (deadlineTimer == NULL)
+    {
+      deadlineHandlersRunning = FALSE;
+      return;
+    }
+  }
+
+  deadlineHandlersRunning = FALSE;
+
+  StartTimerDeadlineInterval();
+}
+
+unsigned long long int
+GetTimerDeadlineTicks()
+{
+  if (deadlineTickRatio == 0)
+  {
+    return deadlineBaseTicks;
+  }
+
+  unsigned long long int numTicks = deadlineBaseTicks;
+  unsigned int startCount = deadlineStartCount;
+  unsigned int count = System_TimerGetCount(deadlineTimer->id);
+
+  // An interval the interrupt has not ended yet is ended here instead. The
+  // counter is read again once the match is known to have happened, so that
+  // it is not read from before the counter cleared.
+  if (System_TimerGetCompareMatchPending(deadlineTimer->id) != FALSE)
+  {
+    count = System_TimerGetCount(deadlineTimer->id);
+    numTicks += (unsigned long long int)(deadlineCompareMatch - deadlineStartCount) * deadlineTickRatio;
+    startCount = 0;
+  }
+
+  if (count < startCount)
+  {
+    return numTicks;
+  }
+
+  return numTicks + ((unsigned long long int)(count - startCount) * deadlineTickRatio);
+}
+
+void
+StartTimerDeadlineInterval()
+{
+  System_TimerID id = deadlineTimer->id;
+
+  if (numDeadlines == 0)
+  {
+    // Take the count up to here into the base, as the counter holds it
+    deadlineBaseTicks = GetTimerDeadlineTicks();
+    System_TimerSetClockSource(id, SYSTEM_TIMER_CLKSOURCE_OFF);
+    deadlineTickRatio = 0;
+    return;
+  }
+
+  unsigned long long int dueTicks = deadlines[deadlineHeap[0]].dueTicks;
+  unsigned long long int numTicks = (dueTicks > deadlineBaseTicks) ? (dueTicks - deadlineBaseTicks) : 0;
+  unsigned long int numCounts = System_TimerGetMaxValue(id) - System_TimerGetCount(id);
+
+  // Clock sources are sorted from highest to lowest frequency. Take the
+  // fastest that reaches the deadline, or the slowest if none does.
+  System_TimerClockSource clockSource = SYSTEM_TIMER_CLKSOURCE_INVALID;
+  unsigned int clockSourceIter;
+  for(
+      clockSourceIter = 0;
+      clockSourceIter < NUM_TIMER_CLKSOURCES;
+      clockSourceIter++
+     )
+  {
+    unsigned long int tickRatio = deadlineTickRatios[clockSourceIter];
+
+    if (tickRatio == 0)
+    {
+      continue;
+    }
+
+    clockSource = clockSourceIter;
+
+    if ((numTicks / tickRatio) <= numCounts)
+    {
+      break;
+    }
+  }
+
+  // The counter has counted on since the interval started. It keeps counting
+  // if the clock source stays, but switching may clear it, so the count so
+  // far is taken into the base and the interval starts from wherever the
+  // counter is left.
+  if (deadlineTickRatios[clockSource] != deadlineTickRatio)
+  {
+    deadlineBaseTicks = GetTimerDeadlineTicks();
+    numTicks = (dueTicks > deadlineBaseTicks) ? (dueTicks - deadlineBaseTicks) : 0;
+
+    System_TimerSetClockSource(id, clockSource);
+    deadlineStartCount = System_TimerGetCount(id);
+    deadlineTickRatio = deadlineTickRatios[clockSource];
+  }
+
+  // Round down so the interval never ends after the deadline
+  unsigned long long int numIntervalCounts = numTicks / deadlineTickRatio;
+
+  if (numIntervalCounts > numCounts)
+  {
+    numIntervalCounts = numCounts;
+  }
+
+  unsigned long int compareMatch = deadlineStartCount + (unsigned long int)numIntervalCounts;
+  unsigned long int minCompareMatch = (unsigned long int)System_TimerGetCount(id) + 1;
+
+  // A deadline already due ends the interval as soon as possible
+  if (compareMatch < minCompareMatch)
+  {
+    compareMatch = minCompareMatch;
+  }
+
+  deadlineCompareMatch = (unsigned int)compareMatch;
+  System_TimerSetCompareMatch(id, deadlineCompareMatch);
+}
+
+void
+ShortenTimerDeadlineInterval()
+{
+  // The interval has already ended, and the interrupt starts the next one
+  // from the earliest deadline
+  if (System_TimerGetCompareMatchPending(deadlineTimer->id) != FALSE)
+  {
+    return;
+  }
+
+  unsigned long long int dueTicks = deadlines[deadlineHeap[0]].dueTicks;
+  unsigned long long int numTicks = (dueTicks > deadlineBaseTicks) ? (dueTicks - deadlineBaseTicks) : 0;
+  unsigned long long int compareMatch = deadlineStartCount + (numTicks / deadlineTickRatio);
+  unsigned long int minCompareMatch = (unsigned long int)System_TimerGetCount(deadlineTimer->id) + 1;
+
+  // The clock source stays as it is, since the counter is mid-interval
+  if (compareMatch < minCompareMatch)
+  {
+    compareMatch = minCompareMatch;
+  }
+
+  if (compareMatch < deadlineCompareMatch)
+  {
+    deadlineCompareMatch = (unsigned int)compareMatch;
+    System_TimerSetCompareMatch(deadlineTimer->id, deadlineCompareMatch);
+  }
+}
+
+void
+SiftTimerDeadlineUp(
+    unsigned int  heapIdx
+    )
+{
+  unsigned char deadlineIdx = deadlineHeap[heapIdx];
+  unsigned long long int dueTicks = deadlines[deadlineIdx].dueTicks;
+
+  while (heapIdx > 0)
+  {
+    unsigned int parentIdx = (heapIdx - 1) / 2;
+    unsigned char parent = deadlineHeap[parentIdx];
+
+    if (deadlines[parent].dueTicks <= dueTicks)
+    {
+      break;
+    }
+
+    deadlineHeap[heapIdx] = parent;
+    deadlines[parent].heapIdx = (unsigned char)heapIdx;
+    heapIdx = parentIdx;
+  }
+
+  deadlineHeap[heapIdx] = deadlineIdx;
+  deadlines[deadlineIdx].heapIdx = (unsigned char)heapIdx;
+}
+
+void
+SiftTimerDeadlineDown(
+    unsigned int  heapIdx
+    )
+{
+  unsigned char deadlineIdx = deadlineHeap[heapIdx];
+  unsigned long long int dueTicks = deadlines[deadlineIdx].dueTicks;
+
+  for (;;)
+  {
+    unsigned int childIdx = (2 * heapIdx) + 1;
+
+    if (childIdx >= numDeadlines)
+    {
+      break;
+    }
+
+    // Follow the earlier of the two children
+    if (
+        ((childIdx + 1) < numDeadlines) &&
+        (deadlines[deadlineHeap[childIdx + 1]].dueTicks < deadlines[deadlineHeap[childIdx]].dueTicks)
+       )
+    {
+      childIdx++;
+    }
+
+    unsigned char child = deadlineHeap[childIdx];
+
+    if (dueTicks <= deadlines[child].dueTicks)
+    {
+      break;
+    }
+
+    deadlineHeap[heapIdx] = child;
+    deadlines[child].heapIdx = (unsigned char)heapIdx;
+    heapIdx = childIdx;
+  }
+
+  deadlineHeap[heapIdx] = deadlineIdx;
+  deadlines[deadlineIdx].heapIdx = (unsigned char)heapIdx;
+}
+
+void
+RemoveTimerDeadline(
+    unsigned int  heapIdx
+    )
+{
+  deadlines[deadlineHeap[heapIdx]].handler = NULL;
+  numDeadlines--;
+
+  if (heapIdx == numDeadlines)
+  {
+    return;
+  }
+
+  // Fill the gap with the last deadline, which may belong either side of it
+  unsigned char lastIdx = deadlineHeap[numDeadlines];
+  deadlineHeap[heapIdx] = lastIdx;
+  SiftTimerDeadlineUp(heapIdx);
+
+  if (deadlines[lastIdx].heapIdx == heapIdx)
+  {
+    SiftTimerDeadlineDown(heapIdx);
+  }
+}
+
+void
+StopTimerDeadlines()
+{
+  System_EventType event = System_GetTimerCallbackEvent(deadlineTimer->id);
+  System_DisableEvent(event);
+  System_RegisterCallback(
+      NULL,
+      event
+      );
+  SetTimerEventImmediate(event, FALSE);
+
+  deadlineTimer = NULL;
+  numDeadlines = 0;
+  deadlineTickRatio = 0;
+}
+#endif
+
+#if TIMER_CAPTURE_BUFFER_SIZE > 0
+unsigned int
+StartTimerCapture(
+    TimerInstance*  instance,
+    unsigned int    edge
+    )
+{
+  if (
+      (instance->isVirtual == TRUE) ||
+      (edge == SYSTEM_TIMER_CAPTURE_NONE)
+     )
+  {
+    return FALSE;
+  }
+
+  System_EventType captureEvent = System_GetTimerCaptureEvent(instance->id);
+
+  if (captureEvent >= SYSTEM_NUM_EVENTS)
+  {
+    return FALSE;
+  }
+
+  StopTimer(instance);
+
+  // Wrap at the full range of the counter, which fits in a single compare
+  // match off the fastest clock source
+  if (
+      (SetTimerCycleTimeTicks(instance, System_TimerGetMaxValue(instance->id)) == FALSE) ||
+      (System_TimerSetCaptureEdge(instance->id, (System_TimerCaptureEdge)edge) == FALSE)
+     )
+  {
+    return FALSE;
+  }
+
+  TimerCaptureBuffer* buffer = &captureBuffers[instance->id];
+  buffer->head = 0;
+  buffer->tail = 0;
+  buffer->numLost = 0;
+
+  instance->captureEdge = (System_TimerCaptureEdge)edge;
+  instance->captureBase = 0;
+
+  SetTimerHandlerMode(instance, TIMER_HANDLER_IMMEDIATE);
+
+  eventTimerInstances[captureEvent] = instance;
+  System_RegisterCallback(
+      TimerCaptureCallback,
+      captureEvent
+      );
+  SetTimerEventImmediate(captureEvent, TRUE);
+  System_EnableEvent(captureEvent);
+
+  return StartTimer(instance);
+}
+
+unsigned int
+ReadTimerCaptures(
+    TimerInstance*  instance,
+    TimerCapture*   captures,
+    unsigned int    maxCaptures
+    )
+{
+  if (
+      (instance->isVirtual == TRUE) ||
+      (captures == NULL)
+     )
+  {
+    return 0;
+  }
+
+  TimerCaptureBuffer* buffer = &captureBuffers[instance->id];
+  unsigned char head = buffer->head;
+  unsigned char tail = buffer->tail;
+  unsigned int numRead = 0;
+
+  while (
+      (tail != head) &&
+      (numRead < maxCaptures)
+      )
+  {
+    captures[numRead] = buffer->captures[tail & TIMER_CAPTURE_BUFFER_MASK];
+    tail++;
+    numRead++;
+  }
+
+  // Free the slots only once they have been copied
+  buffer->tail = tail;
+
+  return numRead;
+}
+
+unsigned int
+GetNumTimerCaptures(
+    TimerInstance*  instance
+    )
+{
+  if (instance->isVirtual == TRUE)
+  {
+    return 0;
+  }
+
+  TimerCaptureBuffer* buffer = &captureBuffers[instance->id];
+  return (unsigned char)(buffer->head - buffer->tail);
+}
+
+unsigned int
+GetNumLostTimerCaptures(
+    TimerInstance*  instance
+    )
+{
+  if (instance->isVirtual == TRUE)
+  {
+    return 0;
+  }
+
+  return captureBuffers[instance->id].numLost;
+}
+
+void
+TimerCaptureCallback(
+    System_EventType  event
+    )
+{
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return;
+  }
+
+  TimerInstance* instance = eventTimerInstances[event];
+
+  if (instance == NULL)
+  {
+    return;
+  }
+
+  unsigned int captureValue = System_TimerGetCaptureValue(instance->id);
+  unsigned long long int captureBase = instance->captureBase;
+
+  // A wrap still waiting to be counted came before the capture if the capture
+  // is from early in the count
+  if (
+      (System_TimerGetCompareMatchPending(instance->id) != FALSE) &&
+      (captureValue < (instance->compareMatch / 2))
+     )
+  {
+    captureBase += instance->compareMatch;
+  }
+
+  TimerCaptureBuffer* buffer = &captureBuffers[instance->id];
+  unsigned char head = buffer->head;
+
+  if ((unsigned char)(head - buffer->tail) >= TIMER_CAPTURE_BUFFER_SIZE)
+  {
+    buffer->numLost++;
+    return;
+  }
+
+  // The timestamp must be in place before the reader can see the new head
+  TimerCapture* capture = &(buffer->captures[head & TIMER_CAPTURE_BUFFER_MASK]);
+  capture->timestamp = captureBase + captureValue;
+  capture->isRising = (System_TimerGetCaptureLevel(instance->id) != FALSE) ? TRUE : FALSE;
+  buffer->head = (unsigned char)(head + 1);
+}
+
+void
+StopTimerCapture(
+    TimerInstance*  instance
+    )
+{
+  System_TimerSetCaptureEdge(instance->id, SYSTEM_TIMER_CAPTURE_NONE);
+  System_DisableEvent(System_GetTimerCaptureEvent(instance->id));
+  instance->captureEdge = SYSTEM_TIMER_CAPTURE_NONE;
+}
+#endif
+
+unsigned int
+GetTimerCompareOutputMode(
+    TimerInstance*  instance,
+    unsigned int    output
+    )
+{
+  if (output >= SYSTEM_NUM_TIMER_OUTPUTS)
+  {
+    return SYSTEM_TIMER_OUTPUT_MODE_NONE;
+  }
+
+  return instance->channels[output].outputMode;
+}
+
+unsigned int
+SetTimerCompareOutputMode(
+    TimerInstance* instance,
+    unsigned int   output,
+    unsigned int   mode
+    )
+{
+  // Virtual timers have no output pins of their own
+  if (
+      (instance->isVirtual == TRUE) ||
+      (output >= SYSTEM_NUM_TIMER_OUTPUTS) ||
+      (
+       (output != 0) &&
+       (instance->pwmMode != TIMER_PWM_NONE)
+      )
+     )
+  {
+    return FALSE;
+  }
+
+  unsigned int systemRetVal = System_TimerSetCompareOutputMode(
+      instance->id,
+      (System_TimerCompareOutput)output,
+      mode
+      );
+
+  if (systemRetVal == TRUE)
+  {
+    instance->channels[output].outputMode = mode;
+    return TRUE;
+  }
+  else
+  {
+    return FALSE;
+  }
+}
+
+unsigned int
+GetTimerChannelCompareMatch(
+    TimerInstance*  instance,
+    unsigned int    output
+    )
+{
+  if (
+      (output == 0) ||
+      (output >= SYSTEM_NUM_TIMER_OUTPUTS)
+     )
+  {
+    return 0;
+  }
+
+  return instance->channels[output].compareMatch;
+}
+
+unsigned int
+SetTimerChannelCompareMatch(
+    TimerInstance*  instance,
+    unsigned int    output,
+    unsigned int    compareMatch
+    )
+{
+  if (
+      (instance->isVirtual == TRUE) ||
+      (output == 0) ||
+      (output >= SYSTEM_NUM_TIMER_OUTPUTS) ||
+      (instance->pwmMode != TIMER_PWM_NONE)
+     )
+  {
+    return FALSE;
+  }
+
+  // The channel must match within every compare match period
+  if (
+      (compareMatch != 0) &&
+      (
+       (compareMatch >= instance->compareMatch) ||
+       (compareMatch >= instance->finalCompareMatch)
+      )
+     )
+  {
+    return FALSE;
+  }
+
+  if (System_TimerSetChannelCompareMatch(instance->id, (System_TimerCompareOutput)output, compareMatch) == FALSE)
+  {
+    return FALSE;
+  }
+
+  instance->channels[output].compareMatch = compareMatch;
+
+  if (instance->status == TIMER_STATUS_RUNNING)
+  {
+    StartTimerChannel(instance, output);
+  }
+
+  return TRUE;
+}
+
+TimerChannelHandler
+GetTimerChannelHandler(
+    TimerInstance*  instance,
+    unsigned int    output
+    )
+{
+  if (
+      (output == 0) ||
+      (output >= SYSTEM_NUM_TIMER_OUTPUTS)
+     )
+  {
+    return NULL;
+  }
+
+  return instance->channels[output].handler;
+}
+
+void*
+GetTimerChannelHandlerContext(
+    TimerInstance*  instance,
+    unsigned int    output
+    )
+{
+  if (
+      (output == 0) ||
+      (output >= SYSTEM_NUM_TIMER_OUTPUTS)
+     )
+  {
+    return NULL;
+  }
+
+  return instance->channels[output].handlerContext;
+}
+
+unsigned int
+SetTimerChannelHandler(
+    TimerInstance*      instance,
+    unsigned int        output,
+    TimerChannelHandler handler,
+    void*               context
+    )
+{
+  if (
+      (instance->isVirtual == TRUE) ||
+      (output == 0) ||
+      (output >= SYSTEM_NUM_TIMER_OUTPUTS)
+     )
+  {
+    return FALSE;
+  }
+
+  // Keep the interrupt from seeing the handler half changed
+  System_EventType event = System_GetTimerChannelEvent(instance->id, (System_TimerCompareOutput)output);
+  System_DisableEvent(event);
+
+  instance->channels[output].handler = handler;
+  instance->channels[output].handlerContext = context;
+
+  if (instance->status == TIMER_STATUS_RUNNING)
+  {
+    StartTimerChannel(instance, output);
+  }
+
+  return TRUE;
+}
+
+TimerPwmMode
+GetTimerPwmMode(
+    TimerInstance*  instance
+    )
+{
+  return instance->pwmMode;
+}
+
+unsigned int
+SetTimerPwmMode(
+    TimerInstance*  instance,
+    TimerPwmMode    mode
+    )
+{
+  if (
+      (instance->isVirtual == TRUE) ||
+      (instance->status == TIMER_STATUS_RUNNING)
+     )
+  {
+    return FALSE;
+  }
+
+  switch (mode)
+  {
+    case TIMER_PWM_NONE:
+    case TIMER_PWM_FAST:
+    case TIMER_PWM_PHASE_CORRECT:
+      break;
+
+    default:
+      return FALSE;
+      break;
+  };
+
+  // PWM modes drive their output off the other compare channels
+  if (mode != TIMER_PWM_NONE)
+  {
+    unsigned int outputIdx;
+    for(
+        outputIdx = 1;
+        outputIdx < SYSTEM_NUM_TIMER_OUTPUTS;
+        outputIdx++
+       )
+    {
+      if (instance->channels[outputIdx].compareMatch != 0)
+      {
+        return FALSE;
+      }
+    }
+  }
+
+  // Periods count differently in each mode, so the old one no longer applies
+  instance->pwmMode = mode;
+  instance->compareMatch = 0;
+  instance->finalCompareMatch = 0;
+  instance->cycleTicks = 0;
+  instance->cycleErrorTicks = 0;
+  instance->pwmUpdatePending = FALSE;
+
+  if (mode != TIMER_PWM_NONE)
+  {
+    SetTimerHandlerMode(instance, TIMER_HANDLER_IMMEDIATE);
+  }
+
+  return TRUE;
+}
+
+unsigned int
+SetTimerPwmFrequency(
+    TimerInstance*    instance,
+    unsigned long int frequencyHz
+    )
+{
+  unsigned long int numHalfPeriods;
+
+  switch (instance->pwmMode)
+  {
+    case TIMER_PWM_FAST:
+      numHalfPeriods = 1;
+      break;
+
+    case TIMER_PWM_PHASE_CORRECT:
+      numHalfPeriods = 2;
+      break;
+
+    default:
+      return FALSE;
+      break;
+  };
+
+  if (frequencyHz > (ULONG_MAX / numHalfPeriods))
+  {
+    return FALSE;
+  }
+
+  // A single unit of the requested resolution keeps the solver to a single
+  // compare match per period. Phase-correct timers count each compare match
+  // twice, once up and once back down, so each is solved as half a period.
+  if (SetTimerCycleTime(instance, 1, frequencyHz * numHalfPeriods) == FALSE)
+  {
+    return FALSE;
+  }
+
+  instance->cycleTicks *= numHalfPeriods;
+  instance->cycleErrorTicks *= numHalfPeriods;
+
+  return SetTimerPwmDutyCycle(instance, instance->pwmDutyCycle);
+}
+
+unsigned int
+GetTimerPwmDutyCycle(
+    TimerInstance*  instance
+    )
+{
+  return instance->pwmDutyCycle;
+}
+
+unsigned int
+SetTimerPwmDutyCycle(
+    TimerInstance*  instance,
+    unsigned int    dutyCycle
+    )
+{
+  if (
+      (instance->pwmMode == TIMER_PWM_NONE) ||
+      (dutyCycle > TIMER_PWM_DUTY_CYCLE_MAX)
+     )
+  {
+    return FALSE;
+  }
+
+  instance->pwmDutyCycle = dutyCycle;
+
+  if (instance->status != TIMER_STATUS_RUNNING)
+  {
+    instance->pwmCompareMatch = GetTimerPwmCompareMatch(instance);
+    System_TimerSetPwmCompareMatch(instance->id, instance->pwmCompareMatch);
+    return TRUE;
+  }
+
+  // Leave the new value for the compare match ending the current period
+  System_EventType event = System_GetTimerCallbackEvent(instance->id);
   System_DisableEvent(event);
+  instance->pwmCompareMatch = GetTimerPwmCompareMatch(instance);
+  instance->pwmUpdatePending = TRUE;
+  System_EnableEvent(event);
+
+  return TRUE;
+}
+
+unsigned int
+GetNumTimerCompareMatches(
+    TimerInstance*  instance
+    )
+{
+  return instance->numCompareMatches;
+}
+
+unsigned int
+GetNumTimerCycles(
+    TimerInstance*  instance
+    )
+{
+  return instance->numCycles;
+}
+
+void
+TimerCompareMatchCallback(
+    System_EventType  event
+    )
+{
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return;
+  }
+
+  TimerInstance* instance = eventTimerInstances[event];
+
+  if (instance == NULL)
+  {
+    return;
+  }
+
+#if TIMER_CAPTURE_BUFFER_SIZE > 0
+  if (instance->captureEdge != SYSTEM_TIMER_CAPTURE_NONE)
+  {
+    instance->captureBase += instance->compareMatch;
+  }
+#endif
+
+  // The period just ended, so the PWM output can change without a glitch
+  if (instance->pwmUpdatePending == TRUE)
+  {
+    System_TimerSetPwmCompareMatch(instance->id, instance->pwmCompareMatch);
+    instance->pwmUpdatePending = FALSE;
+
+    if (IsTimerCompareMatchEventNeeded(instance) == FALSE)
+    {
+      System_DisableEvent(event);
+    }
+  }
+
+  unsigned int numMissed = TakeNumMissedTimerEvents(event);
+
+  // Readers retry if they see the sequence change under them
+  if (instance == clockTimer)
+  {
+    clockSequence++;
+    clockBaseTicks += ((unsigned long long int)numMissed + 1) * instance->compareMatch;
+    clockSequence++;
+  }
+
+  CountTimerCompareMatch(instance, numMissed);
+
+  // A match already waiting arrived before this one was done with
+  if (System_TimerGetCompareMatchPending(instance->id) != FALSE)
+  {
+    instance->numOverruns++;
+  }
+
+  // A new cycle time takes over as the next cycle starts
+  if (
+      (instance->cycleUpdatePending == TRUE) &&
+      (instance->numCompareMatches == 0)
+     )
+  {
+    ApplyStagedTimerCycle(instance);
+
+    if (IsTimerCompareMatchEventNeeded(instance) == FALSE)
+    {
+      System_DisableEvent(event);
+    }
+  }
+  // Switch to the compare match value for the sub-cycle now running
+  else if (instance->finalCompareMatch != instance->compareMatch)
+  {
+    System_TimerSetCompareMatch(
+        instance->id,
+        GetTimerSubCycleCompareMatch(instance, instance->numCompareMatches)
+        );
+  }
+
+  return;
+}
+
+unsigned int
+GetTimerSubCycleCompareMatch(
+    TimerInstance*  instance,
+    unsigned int    subCycle
+    )
+{
+  if (subCycle == instance->compareMatchesPerCycle - 1)
+  {
+    return instance->finalCompareMatch;
+  }
+
+  return instance->compareMatch;
+}
+
+unsigned long long int
+ConvertTimeToTicks(
+    unsigned long int numUnits,
+    unsigned long int unitsPerSec,
+    unsigned long int frequency
+    )
+{
+  return ((unsigned long long int)numUnits * frequency) / unitsPerSec;
+}
+
+void
+CountTimerCompareMatch(
+    TimerInstance*  instance,
+    unsigned int    numMissed
+    )
+{
+  unsigned int numCompleted;
+  unsigned int numMissedCycles;
+
+  if (numMissed == 0)
+  {
+    if (instance->numCompareMatches != instance->compareMatchesPerCycle - 1)
+    {
+      instance->numCompareMatches++;
+      return;
+    }
+
+    instance->numCompareMatches = 0;
+    numCompleted = 1;
+    numMissedCycles = 0;
+  }
+  else
+  {
+    unsigned long int numMatches = (unsigned long int)instance->numCompareMatches + numMissed + 1;
+    numCompleted = numMatches / instance->compareMatchesPerCycle;
+    instance->numCompareMatches = numMatches % instance->compareMatchesPerCycle;
+
+    // The match just taken only completes a cycle if it lands on a boundary
+    numMissedCycles = (instance->numCompareMatches == 0) ? (numCompleted - 1) : numCompleted;
+    instance->numMissedCycles += numMissedCycles;
+
+    if (numCompleted == 0)
+    {
+      return;
+    }
+  }
+
+  instance->numCycles += numCompleted;
+  instance->lastMissedCycles = numMissedCycles;
+
+#if TIMER_LATENCY_STATS
+  RecordTimerLatency(instance);
+#endif
+
+  unsigned int numCalls;
+  if (instance->catchUpPolicy == TIMER_CATCHUP_REPLAY)
+  {
+    numCalls = numCompleted;
+  }
+  else if (instance->catchUpPolicy == TIMER_CATCHUP_COALESCE)
+  {
+    numCalls = 1;
+  }
+  else
+  {
+    numCalls = numCompleted - numMissedCycles;
+  }
+
+  while (numCalls > 0)
+  {
+    CallTimerCycleHandler(instance);
+    numCalls--;
+
+    // Stop replaying once the handler has stopped the timer
+    if (instance->status != TIMER_STATUS_RUNNING)
+    {
+      break;
+    }
+  }
+}
+
+void
+CallTimerCycleHandler(
+    TimerInstance*  instance
+    )
+{
+  if (instance->cycleHandlerEx != NULL)
+  {
+    (*(instance->cycleHandlerEx))(instance, instance->cycleHandlerContext);
+  }
+  else if (instance->cycleHandler != NULL)
+  {
+    (*(instance->cycleHandler))();
+  }
+}
+
+void
+VirtualTimerCompareMatchCallback(
+    System_EventType  event
+    )
+{
+  if (virtualTimerList != NULL)
+  {
+    virtualTimerList->virtualDelta -= virtualTimerInterval;
+  }
+
+  // Timers started from a cycle handler count from this match
+  virtualTimerInterval = 0;
+
+  while (
+      (virtualTimerList != NULL) &&
+      (virtualTimerList->virtualDelta == 0)
+      )
+  {
+    TimerInstance* instance = virtualTimerList;
+    virtualTimerList = instance->nextVirtual;
+
+    unsigned int nextSubCycle = instance->numCompareMatches + 1;
+    if (nextSubCycle == instance->compareMatchesPerCycle)
+    {
+      nextSubCycle = 0;
+    }
+
+    // Re-link before counting so that a cycle handler may stop this timer
+    InsertVirtualTimer(
+        instance,
+        GetTimerSubCycleCompareMatch(instance, nextSubCycle)
+        );
+    CountTimerCompareMatch(instance, 0);
+  }
+
+  if (virtualTimerList == NULL)
+  {
+    StopVirtualTimerBase();
+    return;
+  }
+
+  virtualTimerInterval = virtualTimerList->virtualDelta;
+  System_TimerSetCompareMatch(
+      TIMER_VIRTUAL_BASE,
+      virtualTimerInterval
+      );
+}
+
+System_TimerWaveGenMode
+GetTimerWaveGenMode(
+    TimerInstance*  instance
+    )
+{
+  switch (instance->pwmMode)
+  {
+    case TIMER_PWM_FAST:          return SYSTEM_TIMER_WAVEGEN_MODE_FAST_PWM; break;
+    case TIMER_PWM_PHASE_CORRECT: return SYSTEM_TIMER_WAVEGEN_MODE_PHASE_CORRECT_PWM; break;
+    default:
+      return SYSTEM_TIMER_WAVEGEN_MODE_CTC;
+      break;
+  };
+}
+
+unsigned int
+GetTimerPwmCompareMatch(
+    TimerInstance*  instance
+    )
+{
+  unsigned int compareMatch = (instance->cycleUpdatePending == TRUE) ?
+    instance->stagedCompareMatch :
+    instance->compareMatch;
+
+  return (unsigned int)(((unsigned long int)instance->pwmDutyCycle * compareMatch) / TIMER_PWM_DUTY_CYCLE_MAX);
+}
+
+unsigned int
+IsTimerCompareMatchEventNeeded(
+    TimerInstance*  instance
+    )
+{
+  if (
+      (instance->pwmMode == TIMER_PWM_NONE) ||
+      (instance->pwmUpdatePending == TRUE) ||
+      (instance->cycleUpdatePending == TRUE) ||
+      (instance->cycleHandler != NULL) ||
+      (instance->cycleHandlerEx != NULL)
+     )
+  {
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+System_TimerClockSource
+GetVirtualTimerClockSource()
+{
+  System_TimerClockSource virtualClockSource = SYSTEM_TIMER_CLKSOURCE_INVALID;
+
+  // Clock sources are sorted from highest to lowest frequency
+  unsigned int clockSourceIter;
+  for(
+      clockSourceIter = 0;
+      clockSourceIter < NUM_TIMER_CLKSOURCES;
+      clockSourceIter++
+     )
+  {
+    if (System_TimerGetSourceFrequency(clockSourceIter) >= TIMER_VIRTUAL_MIN_FREQUENCY)
+    {
+      virtualClockSource = clockSourceIter;
+    }
+  }
+
+  return virtualClockSource;
+}
+
+void
+InsertVirtualTimer(
+    TimerInstance*    instance,
+    unsigned long int numTicks
+    )
+{
+  TimerInstance** link = &virtualTimerList;
+
+  while (
+      (*link != NULL) &&
+      (numTicks >= (*link)->virtualDelta)
+      )
+  {
+    numTicks -= (*link)->virtualDelta;
+    link = &((*link)->nextVirtual);
+  }
+
+  instance->virtualDelta = numTicks;
+  instance->nextVirtual = *link;
+
+  if (*link != NULL)
+  {
+    (*link)->virtualDelta -= numTicks;
+  }
+
+  *link = instance;
 }
 
-unsigned int
-SetTimerCycleTimeMilliSec(
-    TimerInstance*    instance,
-    unsigned int      numMilliSec
+void
+RemoveVirtualTimer(
+    TimerInstance*  instance
     )
 {
-  if (numMilliSec == 0)
+  TimerInstance** link = &virtualTimerList;
+
+  while (
+      (*link != NULL) &&
+      (*link != instance)
+      )
   {
-    return FALSE;
+    link = &((*link)->nextVirtual);
   }
 
-  unsigned long int MAX_IDEAL_FREQ_MS_COUNTER = System_TimerGetMaxValue(instance->id) * 1000;
-  unsigned long int idealFrequency = 0;
-  unsigned int numMilliSecPerSubCycle = 0;
-  unsigned long int clockSourceFrequency = 0;
-  instance->compareMatchesPerCycle = 0;
+  if (*link == NULL)
+  {
+    return;
+  }
 
-  for (;;)
+  if (instance->nextVirtual != NULL)
   {
-    instance->compareMatchesPerCycle++;
-    
-    if (instance->compareMatchesPerCycle > numMilliSec)
-    {
-      return FALSE;
-    }
+    instance->nextVirtual->virtualDelta += instance->virtualDelta;
+  }
 
-    numMilliSecPerSubCycle = numMilliSec / instance->compareMatchesPerCycle;
-    idealFrequency = (unsigned long int)(MAX_IDEAL_FREQ_MS_COUNTER / numMilliSecPerSubCycle);
+  *link = instance->nextVirtual;
+  instance->nextVirtual = NULL;
+}
 
-    unsigned int clockSourceIter;
-    for(
-        clockSourceIter = 0;
-        clockSourceIter < NUM_TIMER_CLKSOURCES;
-        clockSourceIter++
-       )
-    {
-      clockSourceFrequency = System_TimerGetSourceFrequency(clockSourceIter);
-      if (clockSourceFrequency == 0)
-      {
-        continue;
-      }
-      
-      if (idealFrequency >= clockSourceFrequency)
-      {
-        instance->clockSource = clockSourceIter;
-        instance->compareMatch = (unsigned int)((numMilliSecPerSubCycle * clockSourceFrequency) / 1000);
+unsigned int
+StartVirtualTimer(
+    TimerInstance*  instance
+    )
+{
+  if (instance->status == TIMER_STATUS_RUNNING)
+  {
+    return TRUE;
+  }
 
-        System_TimerSetClockSource(
-            instance->id,
-            instance->clockSource
-            );
-        System_TimerSetCompareMatch(
-            instance->id,
-            instance->compareMatch
-            );
+  System_EventType event = System_GetTimerCallbackEvent(TIMER_VIRTUAL_BASE);
+  unsigned int baseIdle = (virtualTimerList == NULL);
 
-        return TRUE;
-      }
-    }
+  // Keep the base callback from walking the list while it is being modified
+  System_DisableEvent(event);
+
+  // A timer started while the base is running counts from the next match of
+  // the base, since the current count of the base is unknown
+  InsertVirtualTimer(
+      instance,
+      virtualTimerInterval + GetTimerSubCycleCompareMatch(instance, instance->numCompareMatches)
+      );
+  instance->status = TIMER_STATUS_RUNNING;
+
+  if (baseIdle == TRUE)
+  {
+    virtualTimerInterval = virtualTimerList->virtualDelta;
+
+    System_RegisterCallback(
+        VirtualTimerCompareMatchCallback,
+        event
+        );
+    System_TimerSetWaveGenMode(TIMER_VIRTUAL_BASE, SYSTEM_TIMER_WAVEGEN_MODE_CTC);
+    System_TimerSetCompareMatch(
+        TIMER_VIRTUAL_BASE,
+        virtualTimerInterval
+        );
+    System_TimerSetClockSource(
+        TIMER_VIRTUAL_BASE,
+        instance->clockSource
+        );
   }
 
-  return FALSE;
+  System_EnableEvent(event);
+
+  return TRUE;
 }
 
-unsigned int
-SetTimerCycleTimeSec(
-    TimerInstance*      instance,
-    unsigned int        numSec
+void
+StopVirtualTimer(
+    TimerInstance*  instance
     )
 {
-  unsigned int MAX_NUM_SEC = UINT_MAX / 1000;
+  instance->status = TIMER_STATUS_STOPPED;
 
-  if (numSec > MAX_NUM_SEC)
+  System_EventType event = System_GetTimerCallbackEvent(TIMER_VIRTUAL_BASE);
+  System_DisableEvent(event);
+
+  RemoveVirtualTimer(instance);
+
+  if (virtualTimerList == NULL)
   {
-    return FALSE;
+    StopVirtualTimerBase();
   }
+  else
+  {
+    System_EnableEvent(event);
+  }
+}
 
-  return SetTimerCycleTimeMilliSec(
-      instance,
-      ((unsigned long int) numSec * 1000)
-      );
+void
+StopVirtualTimerBase()
+{
+  System_TimerSetClockSource(TIMER_VIRTUAL_BASE, SYSTEM_TIMER_CLKSOURCE_OFF);
+  System_DisableEvent(System_GetTimerCallbackEvent(TIMER_VIRTUAL_BASE));
+
+  virtualTimerList = NULL;
+  virtualTimerInterval = 0;
 }
 
-unsigned int
-GetTimerCompareOutputMode(
-    TimerInstance*  instance,
-    unsigned int    output
+System_TimerID
+GetTimerSystemID(
+    TimerInstance*  instance
+    )
+{
+  return instance->id;
+}
+
+TimerCycleHandler
+GetTimerCycleHandler(
+    TimerInstance*  instance
     )
 {
-  return instance->compareOutputMode;
+  return instance->cycleHandler;
 }
 
 unsigned int
-SetTimerCompareOutputMode(
-    TimerInstance* instance,
-    unsigned int   output,
-    unsigned int   mode
+SetTimerCycleHandler(
+    TimerInstance*    instance,
+    TimerCycleHandler handler
     )
 {
-  unsigned int systemRetVal = System_TimerSetCompareOutputMode(
-      instance->id,
-      mode
-      );
-  
-  if (systemRetVal == TRUE)
-  {
-    instance->compareOutputMode = mode;
-    return TRUE;
-  }
-  else
+  instance->cycleHandler = handler;
+  instance->cycleHandlerEx = NULL;
+  instance->cycleHandlerContext = NULL;
+
+  // A PWM timer only takes compare matches while something needs them
+  if (
+      (instance->isVirtual == FALSE) &&
+      (instance->status == TIMER_STATUS_RUNNING) &&
+      (IsTimerCompareMatchEventNeeded(instance) == TRUE)
+     )
   {
-    return FALSE;
+    System_EnableEvent(System_GetTimerCallbackEvent(instance->id));
   }
+
+  return TRUE;
 }
 
-unsigned int
-GetNumTimerCompareMatches(
+TimerCycleHandlerEx
+GetTimerCycleHandlerEx(
     TimerInstance*  instance
     )
 {
-  return instance->numCompareMatches;
+  return instance->cycleHandlerEx;
 }
 
-unsigned int
-GetNumTimerCycles(
+void*
+GetTimerCycleHandlerContext(
     TimerInstance*  instance
     )
 {
-  return instance->numCycles;
+  return instance->cycleHandlerContext;
 }
 
-void
-TimerCompareMatchCallback(
-    System_EventType  event
+unsigned int
+SetTimerCycleHandlerEx(
+    TimerInstance*      instance,
+    TimerCycleHandlerEx handler,
+    void*               context
     )
 {
-  unsigned int timerIdx;
-  for(
-      timerIdx = 0;
-      timerIdx < SYSTEM_NUM_TIMERS;
-      timerIdx++
+  instance->cycleHandler = NULL;
+  instance->cycleHandlerEx = handler;
+  instance->cycleHandlerContext = context;
+
+  // A PWM timer only takes compare matches while something needs them
+  if (
+      (instance->isVirtual == FALSE) &&
+      (instance->status == TIMER_STATUS_RUNNING) &&
+      (IsTimerCompareMatchEventNeeded(instance) == TRUE)
      )
   {
-    if (System_GetTimerCallbackEvent(timerInstances[timerIdx].id) == event)
-    {
-      break;
-    }
+    System_EnableEvent(System_GetTimerCallbackEvent(instance->id));
   }
-  
-  if (timerIdx == SYSTEM_NUM_TIMERS)
+
+  return TRUE;
+}
+
+TimerHandlerMode
+GetTimerHandlerMode(
+    TimerInstance*  instance
+    )
+{
+  return instance->handlerMode;
+}
+
+unsigned int
+SetTimerHandlerMode(
+    TimerInstance*    instance,
+    TimerHandlerMode  mode
+    )
+{
+  switch (mode)
   {
-    return;
-  }
+    case TIMER_HANDLER_DEFERRED:
+      break;
+
+    case TIMER_HANDLER_IMMEDIATE:
+      if (instance->isVirtual == TRUE)
+      {
+        return FALSE;
+      }
+      break;
+
+    default:
+      return FALSE;
+      break;
+  };
 
-  TimerInstance* instance = &timerInstances[timerIdx];
+  instance->handlerMode = mode;
 
-  if (instance->numCompareMatches == instance->compareMatchesPerCycle - 1)
+  // A running sequence keeps its interrupt immediate until it stops
+  if (
+      (instance->isVirtual == FALSE) &&
+      (instance->sequence == NULL)
+     )
   {
-    instance->numCompareMatches = 0;
-    instance->numCycles++;
+    // Keep the interrupt from seeing the mode half changed
+    System_EventType event = System_GetTimerCallbackEvent(instance->id);
+    System_DisableEvent(event);
+    SetTimerEventImmediate(event, (mode == TIMER_HANDLER_IMMEDIATE) ? TRUE : FALSE);
 
-    if (instance->cycleHandler != NULL)
+    if (instance->status == TIMER_STATUS_RUNNING)
     {
-      (*(instance->cycleHandler))();
+      System_EnableEvent(event);
+
+      // Channel handlers follow the cycle handler's mode
+      unsigned int outputIdx;
+      for(
+          outputIdx = 1;
+          outputIdx < SYSTEM_NUM_TIMER_OUTPUTS;
+          outputIdx++
+         )
+      {
+        StartTimerChannel(instance, outputIdx);
+      }
     }
   }
-  else
+
+  return TRUE;
+}
+
+TimerCatchUpPolicy
+GetTimerCatchUpPolicy(
+    TimerInstance*  instance
+    )
+{
+  return instance->catchUpPolicy;
+}
+
+unsigned int
+SetTimerCatchUpPolicy(
+    TimerInstance*      instance,
+    TimerCatchUpPolicy  policy
+    )
+{
+  switch (policy)
   {
-    instance->numCompareMatches++;
-  }
+    case TIMER_CATCHUP_SKIP:
+    case TIMER_CATCHUP_REPLAY:
+    case TIMER_CATCHUP_COALESCE:
+      break;
 
-  return;
+    default:
+      return FALSE;
+      break;
+  };
+
+  instance->catchUpPolicy = policy;
+  return TRUE;
 }
 
-System_TimerID
-GetTimerSystemID(
+unsigned int
+GetTimerNumMissedCycles(
     TimerInstance*  instance
     )
 {
-  return instance->id;
+  return instance->numMissedCycles;
 }
 
-TimerCycleHandler
-GetTimerCycleHandler(
+unsigned int
+GetTimerLastMissedCycles(
     TimerInstance*  instance
     )
 {
-  return instance->cycleHandler;
+  return instance->lastMissedCycles;
 }
 
 unsigned int
-SetTimerCycleHandler(
-    TimerInstance*    instance,
-    TimerCycleHandler handler
+GetTimerNumOverruns(
+    TimerInstance*  instance
     )
 {
-  instance->cycleHandler = handler;
-  return TRUE;
+  return instance->numOverruns;
 }
 
 unsigned int
@@ -439,15 +3557,118 @@ WaitForTimer(
     }
   }
 
+  System_EventType event = System_GetTimerCallbackEvent(instance->id);
+
+  // Interrupts are held off between checking for a completed cycle and going
+  // to sleep, so that the compare match completing it cannot be missed
+  System_DisableInterrupts();
   while (instance->numCycles == 0)
   {
-    // TODO: implement better way to test this
-#ifdef TIMER_DEBUG
-    System_TimerWaitCheck(instance->id);
-#endif /* TIMER_DEBUG */
+    // Deferred compare matches are only counted once processed, so there is
+    // no sleeping while one is already waiting
+    if (GetNumQueuedTimerEvents() == 0)
+    {
+      System_WaitForEvent(event);
+    }
+
+    System_EnableInterrupts();
+    ProcessTimerEvents();
+    System_DisableInterrupts();
   }
+  System_EnableInterrupts();
 
   StopTimer(instance);
 
   return TRUE;
 }
+
+#if TIMER_LATENCY_STATS
+unsigned int
+GetTimerLatencyStats(
+    TimerInstance*      instance,
+    TimerLatencyStats*  stats
+    )
+{
+  if (
+      (instance == NULL) ||
+      (stats == NULL)
+     )
+  {
+    return FALSE;
+  }
+
+  System_DisableInterrupts();
+  *stats = instance->latencyStats;
+  System_EnableInterrupts();
+
+  return TRUE;
+}
+
+void
+ResetTimerLatencyStats(
+    TimerInstance*  instance
+    )
+{
+  if (instance == NULL)
+  {
+    return;
+  }
+
+  System_DisableInterrupts();
+  ClearTimerLatencyStats(instance);
+  System_EnableInterrupts();
+}
+
+void
+RecordTimerLatency(
+    TimerInstance*  instance
+    )
+{
+  unsigned int latency = System_TimerGetCount(instance->id);
+  TimerLatencyStats* stats = &(instance->latencyStats);
+
+  unsigned int bucket = 0;
+  while (
+      (bucket < TIMER_LATENCY_NUM_BUCKETS - 1) &&
+      ((latency >> bucket) != 0)
+      )
+  {
+    bucket++;
+  }
+
+  stats->buckets[bucket]++;
+  stats->numSamples++;
+
+  if (latency < stats->minTicks)
+  {
+    stats->minTicks = latency;
+  }
+
+  if (latency > stats->maxTicks)
+  {
+    stats->maxTicks = latency;
+  }
+}
+
+void
+ClearTimerLatencyStats(
+    TimerInstance*  instance
+    )
+{
+  TimerLatencyStats* stats = &(instance->latencyStats);
+
+  stats->numSamples = 0;
+  stats->minTicks = UINT_MAX;
+  stats->maxTicks = 0;
+
+  unsigned int bucket;
+  for(
+      bucket = 0;
+      bucket < TIMER_LATENCY_NUM_BUCKETS;
+      bucket++
+     )
+  {
+    stats->buckets[bucket] = 0;
+  }
+}
+#endif
@@ -0,0 +1,319 @@
+#include <stdlib.h>
+#include <limits.h>
+
+#include "TimerEvents.h"
+#include "TargetSystem.h"
+
+#if ((TIMER_EVENT_QUEUE_SIZE) & ((TIMER_EVENT_QUEUE_SIZE) - 1)) != 0
+#error "TIMER_EVENT_QUEUE_SIZE must be a power of two"
+#endif
+
+#if (TIMER_EVENT_QUEUE_SIZE) > 128
+#error "TIMER_EVENT_QUEUE_SIZE must be no larger than 128"
+#endif
+
+/**
+ * Mask for wrapping queue indices into the event buffer
+ */
+#define TIMER_EVENT_QUEUE_MASK ((TIMER_EVENT_QUEUE_SIZE) - 1)
+
+/**
+ * Buffer of events waiting to be dispatched
+ */
+static volatile unsigned char eventQueue [TIMER_EVENT_QUEUE_SIZE];
+
+/**
+ * Free-running index of the next event to post
+ *
+ * \note Only written by the producer. Indices are single bytes so that they
+ * are read and written atomically on 8-bit targets.
+ */
+static volatile unsigned char eventQueueHead = 0;
+
+/**
+ * Free-running index of the next event to dispatch
+ *
+ * \note Only written by the consumer
+ */
+static volatile unsigned char eventQueueTail = 0;
+
+/**
+ * Largest number of events queued at once
+ */
+static volatile unsigned char maxQueuedEvents = 0;
+
+/**
+ * Number of events dropped because the queue was full
+ */
+static volatile unsigned int numLostEvents = 0;
+
+/**
+ * Bitmask of pending events, indexed by event identifier
+ */
+static volatile unsigned int pendingEventMask = 0;
+
+/**
+ * Bitmask of events dispatched from interrupt context, indexed by event
+ * identifier
+ *
+ * \note Only written by the consumer, while the event's interrupt is
+ * disabled. Each interrupt only reads its own bit, so a torn read of the
+ * others does no harm.
+ */
+static volatile unsigned int immediateEventMask = 0;
+
+/**
+ * Free-running number of times each event was dropped or merged
+ *
+ * \note Only written by the producer
+ */
+static volatile unsigned char eventMissCounts [SYSTEM_NUM_EVENTS];
+
+/**
+ * Value of each event's miss count when the consumer last took it
+ *
+ * \note Only written by the consumer
+ */
+static unsigned char eventMissesTaken [SYSTEM_NUM_EVENTS];
+
+/**
+ * Calls the registered callback of the given event, if any
+ */
+static void DispatchTimerEvent(System_EventType event);
+
+/**
+ * Fails to compile if there are more system events than pending event bits
+ */
+typedef char PendingEventMaskCheck [(SYSTEM_NUM_EVENTS <= (sizeof(unsigned int) * CHAR_BIT)) ? 1 : -1];
+
+void
+InitTimerEvents()
+{
+  eventQueueHead = 0;
+  eventQueueTail = 0;
+  maxQueuedEvents = 0;
+  numLostEvents = 0;
+  pendingEventMask = 0;
+
+  unsigned int eventIdx;
+  for(
+      eventIdx = 0;
+      eventIdx < SYSTEM_NUM_EVENTS;
+      eventIdx++
+     )
+  {
+    eventMissCounts[eventIdx] = 0;
+    eventMissesTaken[eventIdx] = 0;
+  }
+}
+
+unsigned int
+PostTimerEvent(
+    unsigned int  event
+    )
+{
+  if (
+      (event < SYSTEM_NUM_EVENTS) &&
+      ((immediateEventMask & (1U << event)) != 0)
+     )
+  {
+    DispatchTimerEvent((System_EventType)event);
+    return TRUE;
+  }
+
+  unsigned char head = eventQueueHead;
+  unsigned char numQueued = (unsigned char)(head - eventQueueTail);
+
+  if (numQueued >= TIMER_EVENT_QUEUE_SIZE)
+  {
+    numLostEvents++;
+
+    if (event < SYSTEM_NUM_EVENTS)
+    {
+      eventMissCounts[event]++;
+    }
+
+    return FALSE;
+  }
+
+  // The event must be in place before the consumer can see the new head
+  eventQueue[head & TIMER_EVENT_QUEUE_MASK] = (unsigned char)event;
+  eventQueueHead = (unsigned char)(head + 1);
+
+  if (numQueued >= maxQueuedEvents)
+  {
+    maxQueuedEvents = (unsigned char)(numQueued + 1);
+  }
+
+  return TRUE;
+}
+
+unsigned int
+DispatchTimerEvents()
+{
+  unsigned int numDispatched = 0;
+  unsigned char head = eventQueueHead;
+  unsigned char tail = eventQueueTail;
+
+  while (tail != head)
+  {
+    System_EventType event = (System_EventType)eventQueue[tail & TIMER_EVENT_QUEUE_MASK];
+
+    // Free the slot before dispatching so the handler has the whole queue
+    tail++;
+    eventQueueTail = tail;
+
+    DispatchTimerEvent(event);
+    numDispatched++;
+  }
+
+  return numDispatched;
+}
+
+void
+SetTimerEventPending(
+    unsigned int  event
+    )
+{
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return;
+  }
+
+  if ((immediateEventMask & (1U << event)) != 0)
+  {
+    DispatchTimerEvent((System_EventType)event);
+  }
+  else
+  {
+    if ((pendingEventMask & (1U << event)) != 0)
+    {
+      eventMissCounts[event]++;
+    }
+
+    pendingEventMask |= (1U << event);
+  }
+}
+
+unsigned int
+ProcessTimerEvents()
+{
+  unsigned int numDispatched = 0;
+
+  if (pendingEventMask != 0)
+  {
+    // Take every pending event at once, so interrupts are only held off for
+    // a read and a write
+    System_DisableInterrupts();
+    unsigned int pendingEvents = pendingEventMask;
+    pendingEventMask = 0;
+    System_EnableInterrupts();
+
+    while (pendingEvents != 0)
+    {
+      System_EventType event = (System_EventType)__builtin_ctz(pendingEvents);
+      pendingEvents &= (pendingEvents - 1);
+
+      DispatchTimerEvent(event);
+      numDispatched++;
+    }
+  }
+
+  if (eventQueueTail != eventQueueHead)
+  {
+    numDispatched += DispatchTimerEvents();
+  }
+
+  return numDispatched;
+}
+
+void
+SetTimerEventImmediate(
+    unsigned int  event,
+    unsigned int  isImmediate
+    )
+{
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return;
+  }
+
+  if (isImmediate == FALSE)
+  {
+    immediateEventMask &= ~(1U << event);
+  }
+  else
+  {
+    immediateEventMask |= (1U << event);
+  }
+}
+
+unsigned int
+GetTimerEventImmediate(
+    unsigned int  event
+    )
+{
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return FALSE;
+  }
+
+  return ((immediateEventMask & (1U << event)) != 0) ? TRUE : FALSE;
+}
+
+unsigned int
+GetNumQueuedTimerEvents()
+{
+  return (unsigned char)(eventQueueHead - eventQueueTail);
+}
+
+unsigned int
+GetMaxQueuedTimerEvents()
+{
+  return maxQueuedEvents;
+}
+
+unsigned int
+GetNumLostTimerEvents()
+{
+  unsigned int count;
+
+  // Read until two reads agree, in case an interrupt updated the count
+  // between reading its bytes
+  do
+  {
+    count = numLostEvents;
+  }
+  while (count != numLostEvents);
+
+  return count;
+}
+
+unsigned int
+TakeNumMissedTimerEvents(
+    unsigned int  event
+    )
+{
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return 0;
+  }
+
+  unsigned char count = eventMissCounts[event];
+  unsigned char numMissed = (unsigned char)(count - eventMissesTaken[event]);
+  eventMissesTaken[event] = count;
+
+  return numMissed;
+}
+
+void
+DispatchTimerEvent(
+    System_EventType  event
+    )
+{
+  System_EventCallback callback = System_GetEventCallback(event);
+  if (callback != NULL)
+  {
+    (*callback)(event);
+  }
+}
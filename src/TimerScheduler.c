@@ -0,0 +1,317 @@
+#include <stdlib.h>
+#include <limits.h>
+
+#include "TimerScheduler.h"
+#include "TargetSystem.h"
+
+#if (TIMER_SCHEDULER_MAX_TASKS) > 255
+#error "TIMER_SCHEDULER_MAX_TASKS must be no larger than 255"
+#endif
+
+/**
+ * Periodic task
+ */
+typedef struct TimerTask_struct
+{
+  TimerTaskFunction function;     /**< Function to run, or NULL if the slot is free */
+  void*             context;      /**< Context to pass to the function */
+  unsigned long int period;       /**< Number of ticks between runs */
+  unsigned long int nextRunTick;  /**< Tick the task is next due on */
+  unsigned char     priority;     /**< Priority over other tasks due at once */
+  TimerTaskStats    stats;        /**< Run statistics */
+} TimerTask;
+
+static TimerTask tasks [TIMER_SCHEDULER_MAX_TASKS];
+
+/**
+ * Identifiers of the tasks in use, highest priority first
+ */
+static unsigned char taskOrder [TIMER_SCHEDULER_MAX_TASKS];
+static unsigned int numTasks = 0;
+
+static TimerInstance* schedulerTimer = NULL;  /**< Timer counting scheduler ticks, if started */
+static unsigned long int schedulerTicks = 0;  /**< Ticks counted since the scheduler was initialized */
+
+/**
+ * Counts a scheduler tick, for use as a cycle handler
+ */
+static void CountTimerSchedulerTick();
+
+/**
+ * Provides whether the given task is due
+ *
+ * \return Nonzero if the task is due, zero otherwise
+ */
+static unsigned int IsTimerTaskDue(TimerTask* task);
+
+/**
+ * Runs the given task, measuring how long it takes
+ */
+static void RunTimerTask(unsigned int taskIdx);
+
+void
+InitTimerScheduler()
+{
+  StopTimerScheduler();
+
+  unsigned int taskIdx;
+  for(
+      taskIdx = 0;
+      taskIdx < TIMER_SCHEDULER_MAX_TASKS;
+      taskIdx++
+     )
+  {
+    tasks[taskIdx].function = NULL;
+  }
+
+  numTasks = 0;
+  schedulerTicks = 0;
+}
+
+unsigned int
+StartTimerScheduler(
+    TimerInstance*  tickTimer
+    )
+{
+  if (tickTimer == NULL)
+  {
+    return FALSE;
+  }
+
+  StopTimerScheduler();
+
+  // Replay missed cycles so that every tick is counted
+  if (
+      (SetTimerHandlerMode(tickTimer, TIMER_HANDLER_DEFERRED) == FALSE) ||
+      (SetTimerCatchUpPolicy(tickTimer, TIMER_CATCHUP_REPLAY) == FALSE)
+     )
+  {
+    return FALSE;
+  }
+
+  SetTimerCycleHandler(tickTimer, CountTimerSchedulerTick);
+
+  if (StartTimer(tickTimer) == FALSE)
+  {
+    SetTimerCycleHandler(tickTimer, NULL);
+    return FALSE;
+  }
+
+  schedulerTimer = tickTimer;
+  return TRUE;
+}
+
+void
+StopTimerScheduler()
+{
+  if (schedulerTimer == NULL)
+  {
+    return;
+  }
+
+  StopTimer(schedulerTimer);
+  SetTimerCycleHandler(schedulerTimer, NULL);
+  schedulerTimer = NULL;
+}
+
+unsigned long int
+GetTimerSchedulerTicks()
+{
+  return schedulerTicks;
+}
+
+unsigned int
+AddTimerTask(
+    TimerTaskFunction function,
+    void*             context,
+    unsigned long int period,
+    unsigned long int phase,
+    unsigned char     priority
+    )
+{
+  if (
+      (function == NULL) ||
+      (period == 0) ||
+      (period > (ULONG_MAX / 2)) ||
+      (phase > (ULONG_MAX / 2)) ||
+      (numTasks >= TIMER_SCHEDULER_MAX_TASKS)
+     )
+  {
+    return TIMER_TASK_INVALID;
+  }
+
+  unsigned int taskIdx = 0;
+  while (tasks[taskIdx].function != NULL)
+  {
+    taskIdx++;
+  }
+
+  TimerTask* task = &tasks[taskIdx];
+  task->function = function;
+  task->context = context;
+  task->period = period;
+  task->nextRunTick = schedulerTicks + phase;
+  task->priority = priority;
+  task->stats.numRuns = 0;
+  task->stats.numSkipped = 0;
+  task->stats.maxRunTicks = TIMER_TASK_UNMEASURED;
+
+  // Insert after every task of the same or higher priority
+  unsigned int orderIdx = numTasks;
+  while (
+      (orderIdx > 0) &&
+      (tasks[taskOrder[orderIdx - 1]].priority < priority)
+      )
+  {
+    taskOrder[orderIdx] = taskOrder[orderIdx - 1];
+    orderIdx--;
+  }
+
+  taskOrder[orderIdx] = (unsigned char)taskIdx;
+  numTasks++;
+
+  return taskIdx;
+}
+
+unsigned int
+RemoveTimerTask(
+    unsigned int  task
+    )
+{
+  if (
+      (task >= TIMER_SCHEDULER_MAX_TASKS) ||
+      (tasks[task].function == NULL)
+     )
+  {
+    return FALSE;
+  }
+
+  tasks[task].function = NULL;
+
+  unsigned int orderIdx = 0;
+  while (taskOrder[orderIdx] != task)
+  {
+    orderIdx++;
+  }
+
+  numTasks--;
+  for(
+      ;
+      orderIdx < numTasks;
+      orderIdx++
+     )
+  {
+    taskOrder[orderIdx] = taskOrder[orderIdx + 1];
+  }
+
+  return TRUE;
+}
+
+unsigned int
+RunTimerTasks()
+{
+  unsigned int numRun = 0;
+  unsigned int orderIdx = 0;
+
+  while (orderIdx < numTasks)
+  {
+    unsigned int taskIdx = taskOrder[orderIdx];
+    orderIdx++;
+
+    if (IsTimerTaskDue(&tasks[taskIdx]) == FALSE)
+    {
+      continue;
+    }
+
+    unsigned int numTasksBefore = numTasks;
+
+    RunTimerTask(taskIdx);
+    numRun++;
+
+    // Tasks added or removed by the one that ran may have moved the rest.
+    // Those already run are no longer due, so starting over skips them.
+    if (numTasks != numTasksBefore)
+    {
+      orderIdx = 0;
+    }
+  }
+
+  return numRun;
+}
+
+unsigned int
+GetTimerTaskStats(
+    unsigned int    task,
+    TimerTaskStats* stats
+    )
+{
+  if (
+      (task >= TIMER_SCHEDULER_MAX_TASKS) ||
+      (tasks[task].function == NULL) ||
+      (stats == NULL)
+     )
+  {
+    return FALSE;
+  }
+
+  *stats = tasks[task].stats;
+  return TRUE;
+}
+
+void
+CountTimerSchedulerTick()
+{
+  schedulerTicks++;
+}
+
+unsigned int
+IsTimerTaskDue(
+    TimerTask*  task
+    )
+{
+  // Due ticks are never more than half the tick range ahead, so the
+  // difference only wraps for tasks that are not yet due
+  return ((schedulerTicks - task->nextRunTick) <= (ULONG_MAX / 2)) ? TRUE : FALSE;
+}
+
+void
+RunTimerTask(
+    unsigned int  taskIdx
+    )
+{
+  TimerTask* task = &tasks[taskIdx];
+
+  // Skip whole periods the task fell behind by, rather than running it for
+  // each of them
+  unsigned long int numSkipped = (schedulerTicks - task->nextRunTick) / task->period;
+  task->nextRunTick += (numSkipped + 1) * task->period;
+  task->stats.numSkipped += numSkipped;
+  task->stats.numRuns++;
+
+  TimerTaskFunction function = task->function;
+  unsigned int isMeasured = IsTimerClockRunning();
+  unsigned long long int startTicks = GetTimerTicks64();
+  (*function)(task->context);
+  unsigned long long int endTicks = GetTimerTicks64();
+
+  // The task may have removed itself, or stopped or restarted the clock
+  if (
+      (task->function != function) ||
+      (isMeasured == FALSE) ||
+      (IsTimerClockRunning() == FALSE) ||
+      (endTicks < startTicks)
+     )
+  {
+    return;
+  }
+
+  unsigned long long int runTicks = endTicks - startTicks;
+
+  if (
+      (task->stats.maxRunTicks == TIMER_TASK_UNMEASURED) ||
+      (runTicks > task->stats.maxRunTicks)
+     )
+  {
+    task->stats.maxRunTicks = runTicks;
+  }
+}
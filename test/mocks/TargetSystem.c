@@ -1,4 +1,43 @@
+#include <stdlib.h>
+#include <limits.h>
+
 #include "TargetSystem.h"
+#include "TimerEvents.h"
+
+/**
+ * \file TargetSystem.c
+ *
+ * Mock hardware abstraction layer with a discrete-event timer simulator
+ *
+ * Each running timer counts up one tick per prescaler period of the core
+ * clock. When it has counted as many ticks as its compare value, it clears
+ * and raises its compare match event, so the compare value is the number of
+ * ticks between matches. A counter left past its compare value runs on to the
+ * maximum timer value and wraps first, as on the real hardware.
+ *
+ * Simulated time only moves when asked to, and jumps straight from one
+ * compare match to the next, so hours of simulated time take milliseconds.
+ * Interrupts are serviced at the time they occur, provided both the event and
+ * global interrupts are enabled; otherwise they stay pending until they are.
+ * An event occurring again while still pending is lost, as the hardware only
+ * has a single flag for it.
+ *
+ * Each interrupt service routine posts its event with PostTimerEvent(), as the
+ * samples' do. While time is advanced, the main loop processes the events
+ * posted after every interrupt. Sleeping in System_WaitForEvent() only
+ * services interrupts, leaving their events for the caller to process.
+ *
+ * Edges can be scheduled on each timer's input. An edge the timer is set to
+ * capture latches the counter and raises the timer's capture event.
+ *
+ * Holding the prescalers stops every timer counting until they are released.
+ *
+ * Each of a timer's other compare channels raises its own event as the count
+ * reaches the channel's compare value, provided that falls within the period.
+ *
+ * A timer in phase-correct PWM mode counts back down from its compare value
+ * before matching again, so it matches half as often as in the other modes.
+ */
 
 /**
  * Core clock frequency
@@ -10,20 +49,137 @@ static unsigned long int coreClockFrequency = 1000000;
 // Mock system settings
 static System_TimerClockSource system_clockSources [SYSTEM_NUM_TIMERS];
 static unsigned int system_compareValues [SYSTEM_NUM_TIMERS];
-static System_TimerCompareOutputMode system_outputModes [SYSTEM_NUM_TIMERS];
+static unsigned int system_pwmCompareValues [SYSTEM_NUM_TIMERS];
+static unsigned int system_channelCompareValues [SYSTEM_NUM_TIMERS][SYSTEM_NUM_TIMER_OUTPUTS];
+static System_TimerCompareOutputMode system_outputModes [SYSTEM_NUM_TIMERS][SYSTEM_NUM_TIMER_OUTPUTS];
 static System_TimerWaveGenMode system_waveGenModes [SYSTEM_NUM_TIMERS];
+static System_TimerCaptureEdge system_captureEdges [SYSTEM_NUM_TIMERS];
+static unsigned int system_captureValues [SYSTEM_NUM_TIMERS];
+static unsigned int system_captureLevels [SYSTEM_NUM_TIMERS];
 static unsigned int system_maxTimerValues [SYSTEM_NUM_TIMERS] = { 256 };
-static unsigned int system_numWaitChecks [SYSTEM_NUM_TIMERS] = { 0 };
+static unsigned int system_interruptsEnabled = TRUE;
+static unsigned int system_prescalersHeld = FALSE;
+static unsigned int system_prescalerHoldSupported = TRUE;
+static unsigned int system_numSleeps = 0;
+static unsigned long int system_numSourceFrequencyQueries = 0;
+
+/**
+ * HAL functions of the simulated timers, shared by all of them
+ */
+static const System_TimerOps system_simulatedTimerOps =
+{
+  System_TimerGetMaxValue,
+  System_TimerSetClockSource,
+  System_TimerSetCompareMatch,
+  System_TimerSetChannelCompareMatch,
+  System_TimerGetCount,
+  System_TimerGetCompareMatchPending,
+  System_TimerClearCount,
+  System_TimerSetCaptureEdge,
+  System_TimerGetCaptureValue,
+  System_TimerGetCaptureLevel,
+  System_TimerSetCompareOutputMode,
+  System_TimerSetWaveGenMode,
+  System_TimerSetPwmCompareMatch
+};
+
+const System_TimerOps* system_timerOps [SYSTEM_NUM_TIMERS] =
+{
+  [SYSTEM_TIMER0] = &system_simulatedTimerOps,
+  [SYSTEM_TIMER1] = &system_simulatedTimerOps,
+  [SYSTEM_TIMER2] = &system_simulatedTimerOps
+};
 
 static unsigned int system_events [SYSTEM_NUM_EVENTS] = {FALSE};
 static System_EventCallback system_eventCallbacks [SYSTEM_NUM_EVENTS]; /**< Pointers to timer compare match event callback functions */
 
+// Simulation state
+static unsigned long long int system_time = 0;                          /**< Core clock cycles simulated since reset */
+static unsigned long int system_timerCounts [SYSTEM_NUM_TIMERS];        /**< Ticks counted by each timer */
+static unsigned long int system_prescalerCounts [SYSTEM_NUM_TIMERS];    /**< Core clock cycles counted toward each timer's next tick */
+static unsigned long int system_numCompareMatches [SYSTEM_NUM_TIMERS];  /**< Compare matches each timer has made */
+static unsigned int system_pendingEvents [SYSTEM_NUM_EVENTS];           /**< Events raised but not yet serviced */
+static unsigned long int system_numLostEvents = 0;                      /**< Events raised while already pending */
+static unsigned int system_inputLevels [SYSTEM_NUM_TIMERS];             /**< Current level of each timer's input */
+static const unsigned long long int* system_inputEdgeTimes [SYSTEM_NUM_TIMERS]; /**< Times of the edges scheduled on each timer's input */
+static unsigned int system_numInputEdges [SYSTEM_NUM_TIMERS];           /**< Number of edges scheduled on each timer's input */
+static unsigned int system_nextInputEdges [SYSTEM_NUM_TIMERS];          /**< Index of the next edge to simulate on each timer's input */
+
+/**
+ * Provides the number of core clock cycles per tick of the given timer, or
+ * zero if it is stopped
+ */
+static unsigned long int GetTimerPrescaler(System_TimerID timer);
+
+/**
+ * Provides the number of ticks between the given timer's compare matches, or
+ * zero if it will not match
+ */
+static unsigned long int GetTimerPeriod(System_TimerID timer);
+
+/**
+ * Provides the number of core clock cycles until the given timer's next
+ * compare match
+ *
+ * \return Number of cycles, or ULLONG_MAX if the timer will not match
+ */
+static unsigned long long int GetCyclesToCompareMatch(System_TimerID timer);
+
+/**
+ * Provides the number of core clock cycles until the given compare channel of
+ * the given timer next matches
+ *
+ * \return Number of cycles, or ULLONG_MAX if the channel will not match
+ */
+static unsigned long long int GetCyclesToChannelMatch(System_TimerID timer, System_TimerCompareOutput output);
+
+/**
+ * Moves every timer forward by the given number of core clock cycles, raising
+ * the events of those that match
+ */
+static void AdvanceTimers(unsigned long long int numCycles);
+
+/**
+ * Provides the number of core clock cycles until the next edge on any timer's
+ * input
+ *
+ * \return Number of cycles, or ULLONG_MAX if there are no more edges
+ */
+static unsigned long long int GetCyclesToInputEdge();
+
+/**
+ * Simulates every input edge scheduled up to the current time
+ */
+static void ApplyInputEdges();
+
+/**
+ * Raises the given event, counting it as lost if it is already pending
+ */
+static void RaiseEvent(System_EventType event);
+
+/**
+ * Services every pending event that is enabled, if interrupts are enabled
+ *
+ * \return Number of events serviced
+ */
+static unsigned int ServicePendingEvents();
+
+/**
+ * Simulates up to the given time, stopping early once an interrupt has been
+ * serviced if asked to
+ *
+ * \return Number of interrupts serviced
+ */
+static unsigned int Simulate(unsigned long long int endTime, unsigned int serviceInterrupts, unsigned int stopOnInterrupt);
+
 
 unsigned long int
 System_TimerGetSourceFrequency(
     System_TimerClockSource clockSource
     )
 {
+  system_numSourceFrequencyQueries++;
+
   switch (clockSource)
   {
     case SYSTEM_TIMER_CLKSOURCE_INT:          return coreClockFrequency; break;
@@ -65,13 +221,38 @@ System_TimerSetCompareMatch(
   return TRUE;
 }
 
+unsigned int
+System_TimerSetChannelCompareMatch(
+    System_TimerID            timer,
+    System_TimerCompareOutput output,
+    unsigned int              compareValue
+    )
+{
+  if (
+      (output == SYSTEM_TIMER_OUTPUT_A) ||
+      (output >= SYSTEM_NUM_TIMER_OUTPUTS)
+     )
+  {
+    return FALSE;
+  }
+
+  system_channelCompareValues[timer][output] = compareValue;
+  return TRUE;
+}
+
 unsigned int
 System_TimerSetCompareOutputMode(
     System_TimerID                timer,
+    System_TimerCompareOutput     output,
     System_TimerCompareOutputMode outputMode
     )
 {
-  system_outputModes[timer] = outputMode;
+  if (output >= SYSTEM_NUM_TIMER_OUTPUTS)
+  {
+    return FALSE;
+  }
+
+  system_outputModes[timer][output] = outputMode;
   return TRUE;
 }
 
@@ -85,6 +266,75 @@ System_TimerSetWaveGenMode(
   return TRUE;
 }
 
+unsigned int
+System_TimerSetPwmCompareMatch(
+    System_TimerID  timer,
+    unsigned int    compareValue
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
+  {
+    return FALSE;
+  }
+
+  system_pwmCompareValues[timer] = compareValue;
+  return TRUE;
+}
+
+unsigned int
+System_TimerSetCaptureEdge(
+    System_TimerID          timer,
+    System_TimerCaptureEdge edge
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
+  {
+    return FALSE;
+  }
+
+  switch (edge)
+  {
+    case SYSTEM_TIMER_CAPTURE_NONE:
+    case SYSTEM_TIMER_CAPTURE_RISING:
+    case SYSTEM_TIMER_CAPTURE_FALLING:
+    case SYSTEM_TIMER_CAPTURE_BOTH:
+      break;
+
+    default:
+      return FALSE;
+      break;
+  };
+
+  system_captureEdges[timer] = edge;
+  return TRUE;
+}
+
+unsigned int
+System_TimerGetCaptureValue(
+    System_TimerID  timer
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
+  {
+    return 0;
+  }
+
+  return system_captureValues[timer];
+}
+
+unsigned int
+System_TimerGetCaptureLevel(
+    System_TimerID  timer
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
+  {
+    return FALSE;
+  }
+
+  return system_captureLevels[timer];
+}
+
 void
 System_RegisterCallback(
     void (*callback)(System_EventType),
@@ -102,6 +352,11 @@ System_EnableEvent(
     System_EventType  event
     )
 {
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return FALSE;
+  }
+
   system_events[event] = TRUE;
   return TRUE;
 }
@@ -111,10 +366,40 @@ System_DisableEvent(
     System_EventType  event
     )
 {
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return FALSE;
+  }
+
   system_events[event] = FALSE;
   return TRUE;
 }
 
+void
+System_DisableInterrupts()
+{
+  system_interruptsEnabled = FALSE;
+}
+
+void
+System_EnableInterrupts()
+{
+  system_interruptsEnabled = TRUE;
+}
+
+void
+System_WaitForEvent(
+    System_EventType  event
+    )
+{
+  system_numSleeps++;
+
+  // Sleep with interrupts enabled until one has been serviced
+  system_interruptsEnabled = TRUE;
+  Simulate(ULLONG_MAX, TRUE, TRUE);
+  system_interruptsEnabled = FALSE;
+}
+
 System_EventType
 System_GetTimerCallbackEvent(
     System_TimerID  timerID
@@ -129,6 +414,108 @@ System_GetTimerCallbackEvent(
   };
 }
 
+System_EventType
+System_GetTimerCaptureEvent(
+    System_TimerID  timerID
+    )
+{
+  switch (timerID)
+  {
+    case SYSTEM_TIMER0: return SYSTEM_EVENT_TIMER0_CAPTURE; break;
+    case SYSTEM_TIMER1: return SYSTEM_EVENT_TIMER1_CAPTURE; break;
+    case SYSTEM_TIMER2: return SYSTEM_EVENT_TIMER2_CAPTURE; break;
+    default: return SYSTEM_EVENT_INVALID; break;
+  };
+}
+
+System_EventType
+System_GetTimerChannelEvent(
+    System_TimerID            timerID,
+    System_TimerCompareOutput output
+    )
+{
+  if (timerID >= SYSTEM_NUM_TIMERS)
+  {
+    return SYSTEM_EVENT_INVALID;
+  }
+
+  switch (output)
+  {
+    case SYSTEM_TIMER_OUTPUT_A: return System_GetTimerCallbackEvent(timerID); break;
+    case SYSTEM_TIMER_OUTPUT_B: return (System_EventType)(SYSTEM_EVENT_TIMER0_COMPAREMATCH_B + timerID); break;
+    case SYSTEM_TIMER_OUTPUT_C: return (System_EventType)(SYSTEM_EVENT_TIMER0_COMPAREMATCH_C + timerID); break;
+    default: return SYSTEM_EVENT_INVALID; break;
+  };
+}
+
+unsigned int
+System_TimerGetCompareMatchPending(
+    System_TimerID  timer
+    )
+{
+  System_EventType event = System_GetTimerCallbackEvent(timer);
+
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return FALSE;
+  }
+
+  return system_pendingEvents[event];
+}
+
+unsigned int
+System_TimerClearCount(
+    System_TimerID  timer
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
+  {
+    return FALSE;
+  }
+
+  system_timerCounts[timer] = 0;
+  system_prescalerCounts[timer] = 0;
+  system_pendingEvents[System_GetTimerCallbackEvent(timer)] = FALSE;
+  return TRUE;
+}
+
+unsigned int
+System_ReadTableValue(
+    const unsigned int* address
+    )
+{
+  return *address;
+}
+
+unsigned int
+System_TimersHoldPrescalers(
+    unsigned int  isHeld
+    )
+{
+  if (system_prescalerHoldSupported == FALSE)
+  {
+    return FALSE;
+  }
+
+  system_prescalersHeld = isHeld;
+
+  // Released prescalers start a fresh tick
+  if (isHeld == FALSE)
+  {
+    unsigned int timerIdx;
+    for(
+        timerIdx = 0;
+        timerIdx < SYSTEM_NUM_TIMERS;
+        timerIdx++
+       )
+    {
+      system_prescalerCounts[timerIdx] = 0;
+    }
+  }
+
+  return TRUE;
+}
+
 // Test accessors (not for production use)
 
 System_TimerClockSource
@@ -149,10 +536,20 @@ System_TimerGetCompareValue(
 
 System_TimerCompareOutputMode
 System_TimerGetCompareOutputMode(
-    System_TimerID  timer
+    System_TimerID            timer,
+    System_TimerCompareOutput output
     )
 {
-  return system_outputModes[timer];
+  return system_outputModes[timer][output];
+}
+
+unsigned int
+System_TimerGetChannelCompareValue(
+    System_TimerID            timer,
+    System_TimerCompareOutput output
+    )
+{
+  return system_channelCompareValues[timer][output];
 }
 
 System_TimerWaveGenMode
@@ -163,6 +560,22 @@ System_TimerGetWaveGenMode(
   return system_waveGenModes[timer];
 }
 
+System_TimerCaptureEdge
+System_TimerGetCaptureEdge(
+    System_TimerID  timer
+    )
+{
+  return system_captureEdges[timer];
+}
+
+unsigned int
+System_TimerGetPwmCompareValue(
+    System_TimerID  timer
+    )
+{
+  return system_pwmCompareValues[timer];
+}
+
 unsigned int
 System_GetEvent(
     System_EventType  event
@@ -179,30 +592,67 @@ System_GetEventCallback(
   return system_eventCallbacks[event];
 }
 
-void
-System_TimerWaitCheck(
+unsigned int
+System_GetInterruptsEnabled()
+{
+  return system_interruptsEnabled;
+}
+
+unsigned int
+System_GetNumSleeps()
+{
+  return system_numSleeps;
+}
+
+unsigned long int
+System_GetNumSourceFrequencyQueries()
+{
+  return system_numSourceFrequencyQueries;
+}
+
+unsigned long long int
+System_GetTime()
+{
+  return system_time;
+}
+
+unsigned int
+System_TimerGetCount(
     System_TimerID  timer
     )
 {
-  switch (timer)
+  if (timer >= SYSTEM_NUM_TIMERS)
   {
-    case SYSTEM_TIMER0: (*(system_eventCallbacks[SYSTEM_EVENT_TIMER0_COMPAREMATCH]))(SYSTEM_EVENT_TIMER0_COMPAREMATCH); break;
-    case SYSTEM_TIMER1: (*(system_eventCallbacks[SYSTEM_EVENT_TIMER1_COMPAREMATCH]))(SYSTEM_EVENT_TIMER1_COMPAREMATCH); break;
+    return 0;
+  }
 
-    default:
-      return;
-      break;
-  };
+  unsigned long int count = system_timerCounts[timer];
+  unsigned long int compareValue = system_compareValues[timer];
+
+  // Past the compare value a phase-correct timer is counting back down
+  if (
+      (system_waveGenModes[timer] == SYSTEM_TIMER_WAVEGEN_MODE_PHASE_CORRECT_PWM) &&
+      (count > compareValue)
+     )
+  {
+    count = (2 * compareValue) - count;
+  }
 
-  system_numWaitChecks[timer]++;
+  return (unsigned int)count;
 }
 
-unsigned int
-System_GetNumTimerWaitChecks(
+unsigned long int
+System_GetNumTimerCompareMatches(
     System_TimerID  timer
     )
 {
-  return system_numWaitChecks[timer];
+  return system_numCompareMatches[timer];
+}
+
+unsigned long int
+System_GetNumLostEvents()
+{
+  return system_numLostEvents;
 }
 
 // Test manipulators (not for production use)
@@ -225,9 +675,506 @@ System_SetMaxTimerValue(
 }
 
 void
-System_ClearNumTimerWaitChecks(
-    System_TimerID timer
+System_SetPrescalerHoldSupported(
+    unsigned int  isSupported
+    )
+{
+  system_prescalerHoldSupported = isSupported;
+}
+
+void
+System_ClearNumSleeps()
+{
+  system_numSleeps = 0;
+}
+
+void
+System_ClearNumSourceFrequencyQueries()
+{
+  system_numSourceFrequencyQueries = 0;
+}
+
+void
+System_AdvanceTime(
+    unsigned long long int  numCycles
+    )
+{
+  Simulate(system_time + numCycles, TRUE, FALSE);
+}
+
+void
+System_AdvanceTimeMilliSec(
+    unsigned long int numMilliSec
+    )
+{
+  System_AdvanceTime(((unsigned long long int)numMilliSec * coreClockFrequency) / 1000);
+}
+
+void
+System_ConsumeTime(
+    unsigned long long int  numCycles
+    )
+{
+  Simulate(system_time + numCycles, FALSE, FALSE);
+}
+
+void
+System_InjectTimerInputEdges(
+    System_TimerID                timer,
+    const unsigned long long int* edgeTimes,
+    unsigned int                  numEdges
+    )
+{
+  if (timer >= SYSTEM_NUM_TIMERS)
+  {
+    return;
+  }
+
+  system_inputEdgeTimes[timer] = edgeTimes;
+  system_numInputEdges[timer] = numEdges;
+  system_nextInputEdges[timer] = 0;
+}
+
+void
+System_ResetSimulation()
+{
+  system_time = 0;
+  system_numLostEvents = 0;
+  system_interruptsEnabled = TRUE;
+  system_prescalersHeld = FALSE;
+  system_prescalerHoldSupported = TRUE;
+
+  unsigned int timerIdx;
+  for(
+      timerIdx = 0;
+      timerIdx < SYSTEM_NUM_TIMERS;
+      timerIdx++
+     )
+  {
+    system_timerCounts[timerIdx] = 0;
+    system_prescalerCounts[timerIdx] = 0;
+    system_numCompareMatches[timerIdx] = 0;
+    system_pwmCompareValues[timerIdx] = 0;
+    system_captureValues[timerIdx] = 0;
+    system_captureLevels[timerIdx] = FALSE;
+    system_inputLevels[timerIdx] = FALSE;
+    system_inputEdgeTimes[timerIdx] = NULL;
+    system_numInputEdges[timerIdx] = 0;
+    system_nextInputEdges[timerIdx] = 0;
+    system_timerOps[timerIdx] = &system_simulatedTimerOps;
+
+    unsigned int outputIdx;
+    for(
+        outputIdx = 0;
+        outputIdx < SYSTEM_NUM_TIMER_OUTPUTS;
+        outputIdx++
+       )
+    {
+      system_channelCompareValues[timerIdx][outputIdx] = 0;
+    }
+  }
+
+  unsigned int eventIdx;
+  for(
+      eventIdx = 0;
+      eventIdx < SYSTEM_NUM_EVENTS;
+      eventIdx++
+     )
+  {
+    system_pendingEvents[eventIdx] = FALSE;
+  }
+}
+
+unsigned long int
+GetTimerPrescaler(
+    System_TimerID  timer
+    )
+{
+  switch (system_clockSources[timer])
+  {
+    case SYSTEM_TIMER_CLKSOURCE_INT:          return 1; break;
+    case SYSTEM_TIMER_CLKSOURCE_INT_PRE8:     return 8; break;
+    case SYSTEM_TIMER_CLKSOURCE_INT_PRE64:    return 64; break;
+    case SYSTEM_TIMER_CLKSOURCE_INT_PRE256:   return 256; break;
+    case SYSTEM_TIMER_CLKSOURCE_INT_PRE1024:  return 1024; break;
+    default:
+      return 0;
+      break;
+  };
+}
+
+unsigned long int
+GetTimerPeriod(
+    System_TimerID  timer
+    )
+{
+  unsigned long int compareValue = system_compareValues[timer];
+
+  if (
+      (compareValue == 0) ||
+      (compareValue > system_maxTimerValues[timer])
+     )
+  {
+    return 0;
+  }
+
+  if (system_waveGenModes[timer] == SYSTEM_TIMER_WAVEGEN_MODE_PHASE_CORRECT_PWM)
+  {
+    return 2 * compareValue;
+  }
+
+  return compareValue;
+}
+
+unsigned long long int
+GetCyclesToCompareMatch(
+    System_TimerID  timer
+    )
+{
+  unsigned long int prescaler = GetTimerPrescaler(timer);
+  unsigned long int period = GetTimerPeriod(timer);
+  unsigned long int maxValue = system_maxTimerValues[timer];
+  unsigned long int count = system_timerCounts[timer];
+
+  if (
+      (prescaler == 0) ||
+      (period == 0) ||
+      (system_prescalersHeld == TRUE)
+     )
+  {
+    return ULLONG_MAX;
+  }
+
+  // A counter already past the compare value wraps before matching
+  unsigned long int numTicks = (count < period) ?
+    (period - count) :
+    ((maxValue - count) + period);
+
+  return ((unsigned long long int)numTicks * prescaler) - system_prescalerCounts[timer];
+}
+
+unsigned long long int
+GetCyclesToChannelMatch(
+    System_TimerID            timer,
+    System_TimerCompareOutput output
+    )
+{
+  unsigned long int prescaler = GetTimerPrescaler(timer);
+  unsigned long int period = GetTimerPeriod(timer);
+  unsigned long int maxValue = system_maxTimerValues[timer];
+  unsigned long int count = system_timerCounts[timer];
+  unsigned long int channelValue = system_channelCompareValues[timer][output];
+
+  // The other channels drive the PWM output in phase-correct mode
+  if (
+      (prescaler == 0) ||
+      (period == 0) ||
+      (system_prescalersHeld == TRUE) ||
+      (system_waveGenModes[timer] == SYSTEM_TIMER_WAVEGEN_MODE_PHASE_CORRECT_PWM) ||
+      (channelValue == 0) ||
+      (channelValue >= period)
+     )
+  {
+    return ULLONG_MAX;
+  }
+
+  unsigned long int numTicks;
+
+  if (count < channelValue)
+  {
+    numTicks = channelValue - count;
+  }
+  else if (count < period)
+  {
+    numTicks = (period - count) + channelValue;
+  }
+  else
+  {
+    numTicks = (maxValue - count) + channelValue;
+  }
+
+  return ((unsigned long long int)numTicks * prescaler) - system_prescalerCounts[timer];
+}
+
+void
+AdvanceTimers(
+    unsigned long long int  numCycles
     )
 {
-  system_numWaitChecks[timer] = 0;
+  unsigned int timerIdx;
+  for(
+      timerIdx = 0;
+      timerIdx < SYSTEM_NUM_TIMERS;
+      timerIdx++
+     )
+  {
+    unsigned long int prescaler = GetTimerPrescaler(timerIdx);
+    unsigned long int maxValue = system_maxTimerValues[timerIdx];
+
+    if (
+        (prescaler == 0) ||
+        (maxValue == 0) ||
+        (system_prescalersHeld == TRUE)
+       )
+    {
+      continue;
+    }
+
+    unsigned long long int numCyclesToMatch = GetCyclesToCompareMatch(timerIdx);
+
+    unsigned int outputIdx;
+    for(
+        outputIdx = SYSTEM_TIMER_OUTPUT_B;
+        outputIdx < SYSTEM_NUM_TIMER_OUTPUTS;
+        outputIdx++
+       )
+    {
+      if (numCycles >= GetCyclesToChannelMatch(timerIdx, outputIdx))
+      {
+        RaiseEvent(System_GetTimerChannelEvent(timerIdx, outputIdx));
+      }
+    }
+
+    unsigned long long int numPrescalerCycles = system_prescalerCounts[timerIdx] + numCycles;
+    unsigned long long int numTicks = numPrescalerCycles / prescaler;
+    system_prescalerCounts[timerIdx] = (unsigned long int)(numPrescalerCycles % prescaler);
+
+    if (numCycles < numCyclesToMatch)
+    {
+      // A phase-correct count runs up to twice the compare value
+      unsigned long int wrapValue = GetTimerPeriod(timerIdx);
+      if (wrapValue < maxValue)
+      {
+        wrapValue = maxValue;
+      }
+
+      system_timerCounts[timerIdx] = (unsigned long int)((system_timerCounts[timerIdx] + numTicks) % wrapValue);
+      continue;
+    }
+
+    // Clear on compare match
+    system_timerCounts[timerIdx] = 0;
+    system_numCompareMatches[timerIdx]++;
+
+    RaiseEvent(System_GetTimerCallbackEvent(timerIdx));
+  }
+}
+
+unsigned long long int
+GetCyclesToInputEdge()
+{
+  unsigned long long int numCyclesToEdge = ULLONG_MAX;
+
+  unsigned int timerIdx;
+  for(
+      timerIdx = 0;
+      timerIdx < SYSTEM_NUM_TIMERS;
+      timerIdx++
+     )
+  {
+    if (system_nextInputEdges[timerIdx] >= system_numInputEdges[timerIdx])
+    {
+      continue;
+    }
+
+    unsigned long long int edgeTime = system_inputEdgeTimes[timerIdx][system_nextInputEdges[timerIdx]];
+    unsigned long long int numCycles = (edgeTime > system_time) ? (edgeTime - system_time) : 0;
+
+    if (numCycles < numCyclesToEdge)
+    {
+      numCyclesToEdge = numCycles;
+    }
+  }
+
+  return numCyclesToEdge;
+}
+
+void
+ApplyInputEdges()
+{
+  unsigned int timerIdx;
+  for(
+      timerIdx = 0;
+      timerIdx < SYSTEM_NUM_TIMERS;
+      timerIdx++
+     )
+  {
+    while (
+        (system_nextInputEdges[timerIdx] < system_numInputEdges[timerIdx]) &&
+        (system_inputEdgeTimes[timerIdx][system_nextInputEdges[timerIdx]] <= system_time)
+        )
+    {
+      system_nextInputEdges[timerIdx]++;
+      system_inputLevels[timerIdx] = (system_inputLevels[timerIdx] == FALSE) ? TRUE : FALSE;
+
+      System_TimerCaptureEdge edge = system_captureEdges[timerIdx];
+      unsigned int isCaptured =
+        (edge == SYSTEM_TIMER_CAPTURE_BOTH) ||
+        ((edge == SYSTEM_TIMER_CAPTURE_RISING) && (system_inputLevels[timerIdx] == TRUE)) ||
+        ((edge == SYSTEM_TIMER_CAPTURE_FALLING) && (system_inputLevels[timerIdx] == FALSE));
+
+      if (isCaptured)
+      {
+        system_captureValues[timerIdx] = (unsigned int)system_timerCounts[timerIdx];
+        system_captureLevels[timerIdx] = system_inputLevels[timerIdx];
+        RaiseEvent(System_GetTimerCaptureEvent(timerIdx));
+      }
+    }
+  }
+}
+
+void
+RaiseEvent(
+    System_EventType  event
+    )
+{
+  if (event >= SYSTEM_NUM_EVENTS)
+  {
+    return;
+  }
+
+  if (system_pendingEvents[event] == TRUE)
+  {
+    system_numLostEvents++;
+  }
+
+  system_pendingEvents[event] = TRUE;
+}
+
+unsigned int
+ServicePendingEvents()
+{
+  unsigned int numServiced = 0;
+
+  if (system_interruptsEnabled == FALSE)
+  {
+    return 0;
+  }
+
+  unsigned int eventIdx;
+  for(
+      eventIdx = 0;
+      eventIdx < SYSTEM_NUM_EVENTS;
+      eventIdx++
+     )
+  {
+    if (
+        (system_pendingEvents[eventIdx] == FALSE) ||
+        (system_events[eventIdx] == FALSE)
+       )
+    {
+      continue;
+    }
+
+    system_pendingEvents[eventIdx] = FALSE;
+
+    // Interrupts are held off while in the service routine
+    system_interruptsEnabled = FALSE;
+    PostTimerEvent(eventIdx);
+    system_interruptsEnabled = TRUE;
+
+    numServiced++;
+  }
+
+  return numServiced;
+}
+
+unsigned int
+Simulate(
+    unsigned long long int  endTime,
+    unsigned int            serviceInterrupts,
+    unsigned int            stopOnInterrupt
+    )
+{
+  unsigned int numServiced = 0;
+
+  for (;;)
+  {
+    ApplyInputEdges();
+
+    if (serviceInterrupts == TRUE)
+    {
+      unsigned int numNewlyServiced = ServicePendingEvents();
+      numServiced += numNewlyServiced;
+
+      if (
+          (stopOnInterrupt == TRUE) &&
+          (numServiced > 0)
+         )
+      {
+        return numServiced;
+      }
+
+      // The main loop handles what the service routines posted
+      if (numNewlyServiced > 0)
+      {
+        ProcessTimerEvents();
+      }
+    }
+
+    // Time may have been consumed by a service routine
+    if (system_time >= endTime)
+    {
+      return numServiced;
+    }
+
+    unsigned long long int numCyclesToMatch = ULLONG_MAX;
+
+    unsigned int timerIdx;
+    for(
+        timerIdx = 0;
+        timerIdx < SYSTEM_NUM_TIMERS;
+        timerIdx++
+       )
+    {
+      unsigned long long int numCycles = GetCyclesToCompareMatch(timerIdx);
+
+      if (numCycles < numCyclesToMatch)
+      {
+        numCyclesToMatch = numCycles;
+      }
+
+      unsigned int outputIdx;
+      for(
+          outputIdx = SYSTEM_TIMER_OUTPUT_B;
+          outputIdx < SYSTEM_NUM_TIMER_OUTPUTS;
+          outputIdx++
+         )
+      {
+        numCycles = GetCyclesToChannelMatch(timerIdx, outputIdx);
+
+        if (numCycles < numCyclesToMatch)
+        {
+          numCyclesToMatch = numCycles;
+        }
+      }
+    }
+
+    unsigned long long int numCyclesToEdge = GetCyclesToInputEdge();
+
+    if (numCyclesToEdge < numCyclesToMatch)
+    {
+      numCyclesToMatch = numCyclesToEdge;
+    }
+
+    // Nothing left to wake up to
+    if (
+        (numCyclesToMatch == ULLONG_MAX) &&
+        (endTime == ULLONG_MAX)
+       )
+    {
+      return numServiced;
+    }
+
+    if (numCyclesToMatch > (endTime - system_time))
+    {
+      AdvanceTimers(endTime - system_time);
+      system_time = endTime;
+      ApplyInputEdges();
+      return numServiced;
+    }
+
+    AdvanceTimers(numCyclesToMatch);
+    system_time += numCyclesToMatch;
+  }
 }
@@ -4,6 +4,11 @@
 #define TRUE 1
 #define FALSE 0
 
+/**
+ * Attribute placing a constant table where System_ReadTableValue() reads it
+ */
+#define SYSTEM_TABLE_MEMORY
+
 /**
  * \file TargetSystem.h
  *
@@ -42,11 +47,17 @@ typedef enum System_TimerClockSource_enum
 } System_TimerClockSource;
 
 /**
- * Enumeration of timer compare output pins
+ * Enumeration of timer compare channels and their output pins
+ *
+ * The first channel matches at the timer's compare match value, ending each
+ * period. The others match at their own compare values within the period.
  */
 typedef enum System_TimerCompareOutput_enum
 {
-  SYSTEM_TIMER_OUTPUT_A
+  SYSTEM_TIMER_OUTPUT_A,
+  SYSTEM_TIMER_OUTPUT_B,
+  SYSTEM_TIMER_OUTPUT_C,
+  SYSTEM_NUM_TIMER_OUTPUTS
 } System_TimerCompareOutput;
 
 /**
@@ -57,7 +68,8 @@ typedef enum System_TimerCompareOutputMode_enum
   SYSTEM_TIMER_OUTPUT_MODE_NONE,   /**< Outputs disconnected */
   SYSTEM_TIMER_OUTPUT_MODE_SET,
   SYSTEM_TIMER_OUTPUT_MODE_CLEAR,
-  SYSTEM_TIMER_OUTPUT_MODE_TOGGLE
+  SYSTEM_TIMER_OUTPUT_MODE_TOGGLE,
+  SYSTEM_NUM_TIMER_OUTPUT_MODES
 } System_TimerCompareOutputMode;
 
 /**
@@ -65,9 +77,22 @@ typedef enum System_TimerCompareOutputMode_enum
  */
 typedef enum System_TimerWaveGenMode_enum
 {
-  SYSTEM_TIMER_WAVEGEN_MODE_CTC /**< Clear timer on compare-match */
+  SYSTEM_TIMER_WAVEGEN_MODE_CTC,               /**< Clear timer on compare-match */
+  SYSTEM_TIMER_WAVEGEN_MODE_FAST_PWM,          /**< Count up to the compare-match value, with the PWM output high below the PWM compare value */
+  SYSTEM_TIMER_WAVEGEN_MODE_PHASE_CORRECT_PWM  /**< Count up to the compare-match value and back down, with the PWM output high below the PWM compare value */
 } System_TimerWaveGenMode;
 
+/**
+ * Enumeration of timer input capture edges
+ */
+typedef enum System_TimerCaptureEdge_enum
+{
+  SYSTEM_TIMER_CAPTURE_NONE,    /**< Input capture disabled */
+  SYSTEM_TIMER_CAPTURE_RISING,
+  SYSTEM_TIMER_CAPTURE_FALLING,
+  SYSTEM_TIMER_CAPTURE_BOTH
+} System_TimerCaptureEdge;
+
 /**
  * Enumeration of all system events (interrupts)
  */
@@ -76,6 +101,15 @@ typedef enum System_EventType_enum
   SYSTEM_EVENT_TIMER0_COMPAREMATCH,
   SYSTEM_EVENT_TIMER1_COMPAREMATCH,
   SYSTEM_EVENT_TIMER2_COMPAREMATCH,
+  SYSTEM_EVENT_TIMER0_CAPTURE,
+  SYSTEM_EVENT_TIMER1_CAPTURE,
+  SYSTEM_EVENT_TIMER2_CAPTURE,
+  SYSTEM_EVENT_TIMER0_COMPAREMATCH_B,
+  SYSTEM_EVENT_TIMER1_COMPAREMATCH_B,
+  SYSTEM_EVENT_TIMER2_COMPAREMATCH_B,
+  SYSTEM_EVENT_TIMER0_COMPAREMATCH_C,
+  SYSTEM_EVENT_TIMER1_COMPAREMATCH_C,
+  SYSTEM_EVENT_TIMER2_COMPAREMATCH_C,
   SYSTEM_NUM_EVENTS,
   SYSTEM_EVENT_INVALID
 } System_EventType;
@@ -119,6 +153,12 @@ System_TimerSetClockSource(
 /**
  * Sets the timer compare match value
  *
+ * The value is the number of ticks from one compare match to the next. The
+ * counter counts up from zero and matches as it reaches the value, so a timer
+ * whose counter clears on the tick after it matches its compare register
+ * takes one less in that register. In phase-correct PWM mode the counter
+ * turns back down at the value instead, so each period is twice the value.
+ *
  * \return Nonzero if configuration was successful, zero otherwise
  */
 unsigned int
@@ -128,12 +168,114 @@ System_TimerSetCompareMatch(
     );
 
 /**
- * Sets the timer compare output mode
+ * Sets the value one of a timer's other compare channels matches at, in
+ * ticks from the start of each period
+ *
+ * \note The first channel's value is set by System_TimerSetCompareMatch()
+ *
+ * \return Nonzero if configuration was successful, zero otherwise
+ */
+unsigned int
+System_TimerSetChannelCompareMatch(
+    System_TimerID,
+    System_TimerCompareOutput,
+    unsigned int
+    );
+
+/**
+ * Provides the current counter value of a timer
+ *
+ * \return Number of clock source ticks since the timer last matched or was
+ * started
+ */
+unsigned int
+System_TimerGetCount(
+    System_TimerID
+    );
+
+/**
+ * Provides whether a timer's compare match interrupt is waiting to be serviced
+ *
+ * \return Nonzero if the timer has matched since its interrupt was last
+ * serviced, zero otherwise
+ */
+unsigned int
+System_TimerGetCompareMatchPending(
+    System_TimerID
+    );
+
+/**
+ * Clears a timer's counter, the clock source ticks counted toward its next
+ * tick and any compare match pending from before
+ *
+ * \return Nonzero if the counter was cleared, zero otherwise
+ */
+unsigned int
+System_TimerClearCount(
+    System_TimerID
+    );
+
+/**
+ * Reads a value from a constant table declared with SYSTEM_TABLE_MEMORY
+ *
+ * \return Value at the given address
+ */
+unsigned int
+System_ReadTableValue(
+    const unsigned int*
+    );
+
+/**
+ * Holds every timer's prescaler, stopping all timers counting, or releases
+ * them from the start of a tick
+ *
+ * While held, timers can be cleared and have their clock sources set, so that
+ * they all start counting together once released.
+ *
+ * \return Nonzero if the target can hold its prescalers, zero otherwise
+ */
+unsigned int
+System_TimersHoldPrescalers(
+    unsigned int  isHeld
+    );
+
+/**
+ * Sets which edges of a timer's input capture the counter
+ *
+ * \return Nonzero if the configuration was successful, zero otherwise
+ */
+unsigned int
+System_TimerSetCaptureEdge(
+    System_TimerID,
+    System_TimerCaptureEdge
+    );
+
+/**
+ * Provides the counter value a timer captured on its last input edge
+ */
+unsigned int
+System_TimerGetCaptureValue(
+    System_TimerID
+    );
+
+/**
+ * Provides the level of a timer's input just after its last captured edge
+ *
+ * \return Nonzero if the input was high, zero otherwise
+ */
+unsigned int
+System_TimerGetCaptureLevel(
+    System_TimerID
+    );
+
+/**
+ * Sets the compare output mode of one of a timer's compare channels
  *
  * \return Nonzero if the configuration was successful, zero otherwise
  */
 unsigned int System_TimerSetCompareOutputMode(
     System_TimerID,
+    System_TimerCompareOutput,
     System_TimerCompareOutputMode
     );
 
@@ -148,6 +290,48 @@ System_TimerSetWaveGenMode(
     System_TimerWaveGenMode
     );
 
+/**
+ * Sets the value a timer's PWM output changes level at
+ *
+ * \return Nonzero if configuration was successful, zero otherwise
+ */
+unsigned int
+System_TimerSetPwmCompareMatch(
+    System_TimerID,
+    unsigned int
+    );
+
+/**
+ * HAL functions of one kind of timer, each taking the ID of the timer to act on
+ *
+ * \note Only called through when the driver is built with TIMER_HAL_OPS
+ */
+typedef struct System_TimerOps_struct
+{
+  unsigned long int (*getMaxValue)(System_TimerID);                                                           /**< See System_TimerGetMaxValue() */
+  unsigned int      (*setClockSource)(System_TimerID, System_TimerClockSource);                               /**< See System_TimerSetClockSource() */
+  unsigned int      (*setCompareMatch)(System_TimerID, unsigned int);                                         /**< See System_TimerSetCompareMatch() */
+  unsigned int      (*setChannelCompareMatch)(System_TimerID, System_TimerCompareOutput, unsigned int);       /**< See System_TimerSetChannelCompareMatch() */
+  unsigned int      (*getCount)(System_TimerID);                                                              /**< See System_TimerGetCount() */
+  unsigned int      (*getCompareMatchPending)(System_TimerID);                                                /**< See System_TimerGetCompareMatchPending() */
+  unsigned int      (*clearCount)(System_TimerID);                                                            /**< See System_TimerClearCount() */
+  unsigned int      (*setCaptureEdge)(System_TimerID, System_TimerCaptureEdge);                               /**< See System_TimerSetCaptureEdge() */
+  unsigned int      (*getCaptureValue)(System_TimerID);                                                       /**< See System_TimerGetCaptureValue() */
+  unsigned int      (*getCaptureLevel)(System_TimerID);                                                       /**< See System_TimerGetCaptureLevel() */
+  unsigned int      (*setCompareOutputMode)(System_TimerID, System_TimerCompareOutput, System_TimerCompareOutputMode); /**< See System_TimerSetCompareOutputMode() */
+  unsigned int      (*setWaveGenMode)(System_TimerID, System_TimerWaveGenMode);                               /**< See System_TimerSetWaveGenMode() */
+  unsigned int      (*setPwmCompareMatch)(System_TimerID, unsigned int);                                      /**< See System_TimerSetPwmCompareMatch() */
+} System_TimerOps;
+
+/**
+ * HAL functions of each timer, indexed by timer
+ *
+ * Every timer starts out with the simulated timer's functions, and gets them
+ * back on System_ResetSimulation(). An entry can be replaced to stand in a
+ * different kind of timer.
+ */
+extern const System_TimerOps* system_timerOps [SYSTEM_NUM_TIMERS];
+
 /**
  * Registers a callback function to call when a given event occurs
  */
@@ -189,6 +373,52 @@ System_GetTimerCallbackEvent(
     System_TimerID  timerID
     );
 
+/**
+ * Provides the input capture event type for the given timer
+ */
+System_EventType
+System_GetTimerCaptureEvent(
+    System_TimerID  timerID
+    );
+
+/**
+ * Provides the compare match event type for one of the given timer's compare
+ * channels
+ *
+ * \return Event type, which for the first channel is the timer's callback
+ * event, or SYSTEM_EVENT_INVALID if the timer has no such channel
+ */
+System_EventType
+System_GetTimerChannelEvent(
+    System_TimerID            timerID,
+    System_TimerCompareOutput output
+    );
+
+/**
+ * Disables all interrupts
+ */
+void
+System_DisableInterrupts();
+
+/**
+ * Enables all interrupts
+ */
+void
+System_EnableInterrupts();
+
+/**
+ * Idles the processor until an interrupt has been serviced
+ *
+ * This is called with interrupts disabled. They must be enabled together with
+ * entering the idle state, so that an interrupt already pending wakes the
+ * processor instead of being serviced beforehand, and disabled again before
+ * returning.
+ */
+void
+System_WaitForEvent(
+    System_EventType  event /**< Type of event being waited for */
+    );
+
 /**
  * Records that the specified event occurred
  */
@@ -217,7 +447,14 @@ System_TimerGetCompareValue(
 
 System_TimerCompareOutputMode
 System_TimerGetCompareOutputMode(
-    System_TimerID
+    System_TimerID,
+    System_TimerCompareOutput
+    );
+
+unsigned int
+System_TimerGetChannelCompareValue(
+    System_TimerID,
+    System_TimerCompareOutput
     );
 
 System_TimerWaveGenMode
@@ -225,6 +462,16 @@ System_TimerGetWaveGenMode(
     System_TimerID
     );
 
+System_TimerCaptureEdge
+System_TimerGetCaptureEdge(
+    System_TimerID
+    );
+
+unsigned int
+System_TimerGetPwmCompareValue(
+    System_TimerID
+    );
+
 unsigned int
 System_GetEvent(
     System_EventType
@@ -235,16 +482,26 @@ System_GetEventCallback(
     System_EventType
     );
 
-void
-System_TimerWaitCheck(
-    System_TimerID
-    );
+unsigned int
+System_GetInterruptsEnabled();
 
 unsigned int
-System_GetNumTimerWaitChecks(
+System_GetNumSleeps();
+
+unsigned long int
+System_GetNumSourceFrequencyQueries();
+
+unsigned long long int
+System_GetTime();
+
+unsigned long int
+System_GetNumTimerCompareMatches(
     System_TimerID
     );
 
+unsigned long int
+System_GetNumLostEvents();
+
 // Test manipulators (not for production use)
 
 void
@@ -258,9 +515,70 @@ System_SetMaxTimerValue(
     unsigned int
     );
 
+/**
+ * Sets whether System_TimersHoldPrescalers() can hold the prescalers
+ */
 void
-System_ClearNumTimerWaitChecks(
-    System_TimerID
+System_SetPrescalerHoldSupported(
+    unsigned int
     );
 
+void
+System_ClearNumSleeps();
+
+void
+System_ClearNumSourceFrequencyQueries();
+
+/**
+ * Simulates the given number of core clock cycles, servicing interrupts as
+ * they occur
+ */
+void
+System_AdvanceTime(
+    unsigned long long int
+    );
+
+/**
+ * Simulates the given number of milliseconds at the current core clock
+ * frequency, servicing interrupts as they occur
+ */
+void
+System_AdvanceTimeMilliSec(
+    unsigned long int
+    );
+
+/**
+ * Simulates the given number of core clock cycles spent in the current
+ * context, leaving interrupts that occur pending
+ *
+ * This stands in for the run time of an interrupt service routine.
+ */
+void
+System_ConsumeTime(
+    unsigned long long int
+    );
+
+/**
+ * Schedules edges on a timer's input
+ *
+ * The input starts low and toggles at each of the given times, in core clock
+ * cycles since the simulation was reset, which must be in increasing order.
+ * Edges selected by System_TimerSetCaptureEdge() capture the counter and
+ * raise the timer's capture event as they are simulated.
+ *
+ * \note The array of times must stay valid until the last edge is simulated
+ */
+void
+System_InjectTimerInputEdges(
+    System_TimerID,
+    const unsigned long long int*,
+    unsigned int
+    );
+
+/**
+ * Resets simulated time, timer counters, pending events and input edges
+ */
+void
+System_ResetSimulation();
+
 #endif /* TARGET_SYSTEM */
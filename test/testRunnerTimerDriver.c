@@ -7,6 +7,7 @@ TEST_GROUP_RUNNER(TimerDriver)
   RUN_TEST_CASE(TimerDriver, CreateTimer);
   RUN_TEST_CASE(TimerDriver, DestroyTimer);
   RUN_TEST_CASE(TimerDriver, DestroyAllTimers);
+  RUN_TEST_CASE(TimerDriver, DestroyAllTimersStopsClockAndCapture);
   RUN_TEST_CASE(TimerDriver, NotEnoughHardware);
   RUN_TEST_CASE(TimerDriver, TrackNumOfTimers);
   RUN_TEST_CASE(TimerDriver, NullTimerStatus);
@@ -22,24 +23,87 @@ TEST_GROUP_RUNNER(TimerDriver)
   RUN_TEST_CASE(TimerDriver, ClockSourceSelection);
   RUN_TEST_CASE(TimerDriver, SetCycleTimeSec);
   RUN_TEST_CASE(TimerDriver, CycleTimeOverflow);
+  RUN_TEST_CASE(TimerDriver, CompareValueIsTicksPerMatch);
+  RUN_TEST_CASE(TimerDriver, HalOpsPerTimer);
   RUN_TEST_CASE(TimerDriver, HiFreqAccuracy);
+  RUN_TEST_CASE(TimerDriver, FinalSubCycleCompareMatch);
+  RUN_TEST_CASE(TimerDriver, BestFitCycleTime);
   RUN_TEST_CASE(TimerDriver, FastClock);
   RUN_TEST_CASE(TimerDriver, MaxTimerValue);
+  RUN_TEST_CASE(TimerDriver, FastClockMicroSec);
+  RUN_TEST_CASE(TimerDriver, MaxTimerValueMicroSec);
+  RUN_TEST_CASE(TimerDriver, SetCycleTimeTicks);
   RUN_TEST_CASE(TimerDriver, EnableCompareMatchEvents);
   RUN_TEST_CASE(TimerDriver, CountUpOnCompareMatch);
   RUN_TEST_CASE(TimerDriver, CompareMatchMultiTimers);
+  RUN_TEST_CASE(TimerDriver, CompareMatchInvalidEvent);
   RUN_TEST_CASE(TimerDriver, CompareOutputMode);
   RUN_TEST_CASE(TimerDriver, CustomCycleHandler);
+  RUN_TEST_CASE(TimerDriver, CustomCycleHandlerEx);
+  RUN_TEST_CASE(TimerDriver, ImmediateHandlerMode);
   RUN_TEST_CASE(TimerDriver, SingleShot);
   RUN_TEST_CASE(TimerDriver, SingleShotAutoStart);
   RUN_TEST_CASE(TimerDriver, NoSingleShotWithoutConfig);
   RUN_TEST_CASE(TimerDriver, StopAfterSingleShot);
   RUN_TEST_CASE(TimerDriver, ResetOnNextSingleShot);
+  RUN_TEST_CASE(TimerDriver, VirtualTimerFallback);
+  RUN_TEST_CASE(TimerDriver, VirtualTimerMultiplexing);
+  RUN_TEST_CASE(TimerDriver, VirtualTimerStop);
+  RUN_TEST_CASE(TimerDriver, VirtualSingleShot);
+  RUN_TEST_CASE(TimerDriver, SimulatedCycleTime);
+  RUN_TEST_CASE(TimerDriver, SimulatedNoDrift);
+  RUN_TEST_CASE(TimerDriver, SimulatedVirtualTimers);
+  RUN_TEST_CASE(TimerDriver, SimulatedOverload);
+  RUN_TEST_CASE(TimerDriver, SimulatedWaitForTimer);
+  RUN_TEST_CASE(TimerDriver, SimulatedWaitForTimerDeferred);
+  RUN_TEST_CASE(TimerDriver, LatencyStatsOnTime);
+  RUN_TEST_CASE(TimerDriver, LatencyStatsLateHandler);
+  RUN_TEST_CASE(TimerDriver, LatencyStatsVirtualTimer);
+  RUN_TEST_CASE(TimerDriver, CatchUpPolicy);
+  RUN_TEST_CASE(TimerDriver, CatchUpSkip);
+  RUN_TEST_CASE(TimerDriver, CatchUpReplay);
+  RUN_TEST_CASE(TimerDriver, CatchUpCoalesce);
+  RUN_TEST_CASE(TimerDriver, CatchUpWithinCycle);
+  RUN_TEST_CASE(TimerDriver, CatchUpFullQueue);
+  RUN_TEST_CASE(TimerDriver, CaptureStartStop);
+  RUN_TEST_CASE(TimerDriver, CaptureBothEdges);
+  RUN_TEST_CASE(TimerDriver, CaptureRisingEdges);
+  RUN_TEST_CASE(TimerDriver, CaptureBufferFull);
+  RUN_TEST_CASE(TimerDriver, CaptureBeforePendingWrap);
+  RUN_TEST_CASE(TimerDriver, PwmModes);
+  RUN_TEST_CASE(TimerDriver, PwmDutyCycle);
+  RUN_TEST_CASE(TimerDriver, ClockStartStop);
+  RUN_TEST_CASE(TimerDriver, ClockPendingWrap);
+  RUN_TEST_CASE(TimerDriver, ClockWrapsAtMaxValue);
+  RUN_TEST_CASE(TimerDriver, ClockWideRange);
+  RUN_TEST_CASE(TimerDriver, DeadlinesStartStop);
+  RUN_TEST_CASE(TimerDriver, DeadlinesAfterDestroyAllTimers);
+  RUN_TEST_CASE(TimerDriver, DeadlinesInOrder);
+  RUN_TEST_CASE(TimerDriver, DeadlineBeyondCounter);
+  RUN_TEST_CASE(TimerDriver, DeadlineEarlierWhileRunning);
+  RUN_TEST_CASE(TimerDriver, DeadlineAddedWhileMatchPending);
+  RUN_TEST_CASE(TimerDriver, DeadlineAfterSlowHandler);
+  RUN_TEST_CASE(TimerDriver, DeadlineCancel);
+  RUN_TEST_CASE(TimerDriver, DeadlineAddedByHandler);
+  RUN_TEST_CASE(TimerDriver, GroupMembership);
+  RUN_TEST_CASE(TimerDriver, GroupStartInPhase);
+  RUN_TEST_CASE(TimerDriver, GroupStartWithoutPrescalerHold);
+  RUN_TEST_CASE(TimerDriver, GroupStopAndReset);
+  RUN_TEST_CASE(TimerDriver, CycleTimeChangeWhileRunning);
+  RUN_TEST_CASE(TimerDriver, CycleTimeSweep);
+  RUN_TEST_CASE(TimerDriver, PwmFrequencyChangeWhileRunning);
+  RUN_TEST_CASE(TimerDriver, ChannelCompareMatch);
+  RUN_TEST_CASE(TimerDriver, ChannelHandlers);
+  RUN_TEST_CASE(TimerDriver, SequenceStart);
+  RUN_TEST_CASE(TimerDriver, SequenceSteps);
+  RUN_TEST_CASE(TimerDriver, SequenceLooping);
 }
 
 static void RunAllTests()
 {
   RUN_TEST_GROUP(TimerDriver);
+  RUN_TEST_GROUP(TimerEvents);
+  RUN_TEST_GROUP(TimerScheduler);
 }
 
 int main(
@@ -0,0 +1,18 @@
+#include "unity_fixture.h"
+
+TEST_GROUP_RUNNER(TimerEvents)
+{
+  RUN_TEST_CASE(TimerEvents, EmptyOnInit);
+  RUN_TEST_CASE(TimerEvents, DispatchInOrder);
+  RUN_TEST_CASE(TimerEvents, RepeatedEventsKept);
+  RUN_TEST_CASE(TimerEvents, FullQueueLosesEvents);
+  RUN_TEST_CASE(TimerEvents, IndexWrapAround);
+  RUN_TEST_CASE(TimerEvents, PostedWhileDispatching);
+  RUN_TEST_CASE(TimerEvents, UnregisteredEvent);
+  RUN_TEST_CASE(TimerEvents, NothingToProcess);
+  RUN_TEST_CASE(TimerEvents, PendingEventsCoalesce);
+  RUN_TEST_CASE(TimerEvents, PendingEventsInOrder);
+  RUN_TEST_CASE(TimerEvents, ProcessPendingAndQueued);
+  RUN_TEST_CASE(TimerEvents, ImmediateEvent);
+  RUN_TEST_CASE(TimerEvents, MissedEventsCounted);
+}
@@ -0,0 +1,12 @@
+#include "unity_fixture.h"
+
+TEST_GROUP_RUNNER(TimerScheduler)
+{
+  RUN_TEST_CASE(TimerScheduler, StartStop);
+  RUN_TEST_CASE(TimerScheduler, PeriodAndPhase);
+  RUN_TEST_CASE(TimerScheduler, PriorityOrder);
+  RUN_TEST_CASE(TimerScheduler, SkipsMissedPeriods);
+  RUN_TEST_CASE(TimerScheduler, AddAndRemove);
+  RUN_TEST_CASE(TimerScheduler, RemoveWhileRunning);
+  RUN_TEST_CASE(TimerScheduler, RunTimes);
+}
@@ -3,6 +3,7 @@
 
 #include "unity_fixture.h"
 #include "TimerDriver.h"
+#include "TimerEvents.h"
 #include "TargetSystem.h"
 
 TEST_GROUP(TimerDriver);
@@ -17,6 +18,193 @@ CustomTimerCycleCounter()
   numCustomTimerCycles++;
 }
 
+static TimerInstance* lastContextTimer = NULL;
+
+static unsigned long long int lastCycleTime = 0;
+
+static void
+RecordCycleTime()
+{
+  lastCycleTime = System_GetTime();
+  numCustomTimerCycles++;
+}
+
+static unsigned long long int overloadCycles = 0;
+
+static unsigned int lastMissedCycles = 0;
+
+static void
+RecordMissedCycles(
+    TimerInstance*  instance,
+    void*           context
+    )
+{
+  lastMissedCycles = GetTimerLastMissedCycles(instance);
+  numCustomTimerCycles++;
+}
+
+static void testMissCompareMatches(
+    System_TimerID  timer,
+    unsigned int    numMissed
+    )
+{
+  System_EventType event = System_GetTimerCallbackEvent(timer);
+
+  // Flagging an event again while it is pending merges the two
+  unsigned int matchIdx;
+  for(
+      matchIdx = 0;
+      matchIdx <= numMissed;
+      matchIdx++
+     )
+  {
+    SetTimerEventPending(event);
+  }
+
+  ProcessTimerEvents();
+}
+
+#define TEST_MAX_RECORDED_DEADLINES 8
+
+static unsigned int recordedDeadlines [TEST_MAX_RECORDED_DEADLINES];
+static unsigned long long int recordedDeadlineTimes [TEST_MAX_RECORDED_DEADLINES];
+static unsigned int numRecordedDeadlines = 0;
+
+static void
+RecordDeadline(
+    void* context
+    )
+{
+  if (numRecordedDeadlines < TEST_MAX_RECORDED_DEADLINES)
+  {
+    recordedDeadlines[numRecordedDeadlines] = *((unsigned int*)context);
+    recordedDeadlineTimes[numRecordedDeadlines] = System_GetTime();
+  }
+
+  numRecordedDeadlines++;
+}
+
+static void
+RecordAndRepeatDeadline(
+    void* context
+    )
+{
+  RecordDeadline(context);
+
+  if (numRecordedDeadlines < 3)
+  {
+    AddTimerDeadline(RecordAndRepeatDeadline, context, 500);
+  }
+}
+
+static void
+RecordDeadlineSlowly(
+    void* context
+    )
+{
+  RecordDeadline(context);
+  System_ConsumeTime(300);
+}
+
+#define TEST_NUM_SWEEP_CYCLES 4
+
+static unsigned long long int sweepCycleTimes [TEST_NUM_SWEEP_CYCLES];
+static unsigned int numSweepCycles = 0;
+
+static void
+SweepCycleTime(
+    TimerInstance*  instance,
+    void*           context
+    )
+{
+  if (numSweepCycles < TEST_NUM_SWEEP_CYCLES)
+  {
+    sweepCycleTimes[numSweepCycles] = System_GetTime();
+  }
+
+  numSweepCycles++;
+
+  // Double the cycle time for each cycle to come
+  SetTimerCycleTimeMicroSec(instance, 200UL << numSweepCycles);
+}
+
+#define TEST_MAX_CHANNEL_MATCHES 4
+
+static unsigned long long int channelMatchTimes [TEST_MAX_CHANNEL_MATCHES];
+static unsigned int numChannelMatches = 0;
+
+static void
+RecordChannelMatch(
+    TimerInstance*  instance,
+    unsigned int    output,
+    void*           context
+    )
+{
+  if (numChannelMatches < TEST_MAX_CHANNEL_MATCHES)
+  {
+    channelMatchTimes[numChannelMatches] = System_GetTime();
+  }
+
+  numChannelMatches++;
+  *((unsigned int*)context) = output;
+}
+
+static unsigned int numSequenceEnds = 0;
+static unsigned long long int lastSequenceEndTime = 0;
+
+static void
+RecordSequenceEnd(
+    TimerInstance*  instance,
+    void*           context
+    )
+{
+  lastSequenceEndTime = System_GetTime();
+  numSequenceEnds++;
+  lastContextTimer = instance;
+}
+
+static unsigned int numCountedOpsCalls = 0;
+static System_TimerID lastCountedOpsTimer = SYSTEM_NUM_TIMERS;
+
+static unsigned int
+CountedSetClockSource(
+    System_TimerID          timer,
+    System_TimerClockSource clockSource
+    )
+{
+  numCountedOpsCalls++;
+  lastCountedOpsTimer = timer;
+  return System_TimerSetClockSource(timer, clockSource);
+}
+
+static unsigned int
+CountedSetCompareMatch(
+    System_TimerID  timer,
+    unsigned int    value
+    )
+{
+  numCountedOpsCalls++;
+  lastCountedOpsTimer = timer;
+  return System_TimerSetCompareMatch(timer, value);
+}
+
+static void
+OverloadingCycleHandler()
+{
+  numCustomTimerCycles++;
+  System_ConsumeTime(overloadCycles);
+}
+
+static void
+ContextTimerCycleCounter(
+    TimerInstance*  instance,
+    void*           context
+    )
+{
+  lastContextTimer = instance;
+  (*((unsigned int*)context))++;
+}
+
 static void testCreateAllTimers()
 {
   InitTimers();
@@ -33,6 +221,28 @@ static void testCreateAllTimers()
   }
 }
 
+static void testCreateRemainingVirtualTimers()
+{
+  // One virtual timer was already created in place of the reserved hardware timer
+  unsigned int timerIdx;
+  for(
+      timerIdx = 1;
+      timerIdx < TIMER_NUM_VIRTUAL_TIMERS;
+      timerIdx++
+     )
+  {
+    TEST_ASSERT_NOT_NULL(CreateTimer());
+  }
+}
+
+static void testFireCompareMatch(
+    System_TimerID  timer
+    )
+{
+  System_EventType event = System_GetTimerCallbackEvent(timer);
+  (*(System_GetEventCallback(event)))(event);
+}
+
 static void testDestroyAllTimers()
 {
   if (timers == NULL)
@@ -58,6 +268,17 @@ TEST_SETUP(TimerDriver)
 {
   timers = NULL;
   numCustomTimerCycles = 0;
+  lastContextTimer = NULL;
+  lastCycleTime = 0;
+  overloadCycles = 0;
+  lastMissedCycles = 0;
+  numRecordedDeadlines = 0;
+  numSweepCycles = 0;
+  numChannelMatches = 0;
+  numSequenceEnds = 0;
+  lastSequenceEndTime = 0;
+  numCountedOpsCalls = 0;
+  lastCountedOpsTimer = SYSTEM_NUM_TIMERS;
   System_SetCoreClockFrequency(1000000);
 
   unsigned int timerIdx;
@@ -71,10 +292,10 @@ TEST_SETUP(TimerDriver)
         timerIdx,
         256 // 8-bit timer
         );
-    System_ClearNumTimerWaitChecks(
-        timerIdx
-        );
   }
+
+  System_ClearNumSleeps();
+  System_ResetSimulation();
 }
 
 TEST_TEAR_DOWN(TimerDriver)
@@ -95,6 +316,7 @@ TEST(TimerDriver, NoTimersBeforeInit)
 TEST(TimerDriver, MultiInit)
 {
   testCreateAllTimers();
+  testCreateRemainingVirtualTimers();
   InitTimers();
 
   TEST_ASSERT_NULL(CreateTimer());
@@ -124,7 +346,7 @@ TEST(TimerDriver, CreateTimer)
 
     TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_OFF, System_TimerGetClockSource(timerIdx));
     TEST_ASSERT_EQUAL(0, System_TimerGetCompareValue(timerIdx));
-    TEST_ASSERT_EQUAL(SYSTEM_TIMER_OUTPUT_MODE_NONE, System_TimerGetCompareOutputMode(timerIdx));
+    TEST_ASSERT_EQUAL(SYSTEM_TIMER_OUTPUT_MODE_NONE, System_TimerGetCompareOutputMode(timerIdx, SYSTEM_TIMER_OUTPUT_A));
     TEST_ASSERT_EQUAL(SYSTEM_TIMER_WAVEGEN_MODE_CTC, System_TimerGetWaveGenMode(timerIdx));
   }
 
@@ -165,9 +387,33 @@ TEST(TimerDriver, DestroyAllTimers)
   }
 }
 
+TEST(TimerDriver, DestroyAllTimersStopsClockAndCapture)
+{
+  testCreateAllTimers();
+  TEST_ASSERT(StartTimerClock(timers[0]));
+  TEST_ASSERT(StartTimerCapture(timers[1], SYSTEM_TIMER_CAPTURE_RISING));
+  System_AdvanceTime(1000);
+
+  DestroyAllTimers();
+  TEST_ASSERT_EQUAL(0, GetTimerTicks64());
+  TEST_ASSERT_EQUAL(0, GetTimerMicroSec64());
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_OFF, System_TimerGetClockSource(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CAPTURE_NONE, System_TimerGetCaptureEdge(SYSTEM_TIMER1));
+  TEST_ASSERT_FALSE(System_GetEvent(SYSTEM_EVENT_TIMER1_CAPTURE));
+
+  // The timers taking their place are plain timers
+  testCreateAllTimers();
+  TEST_ASSERT(SetTimerCycleTimeTicks(timers[0], 100));
+  TEST_ASSERT(StartTimer(timers[0]));
+  System_AdvanceTime(1000);
+  TEST_ASSERT_EQUAL(0, GetTimerTicks64());
+  TEST_ASSERT_EQUAL(0, GetNumTimerCaptures(timers[1]));
+}
+
 TEST(TimerDriver, NotEnoughHardware)
 {
   testCreateAllTimers();
+  testCreateRemainingVirtualTimers();
 
   TEST_ASSERT_NULL(CreateTimer());
 }
@@ -300,11 +546,20 @@ TEST(TimerDriver, SetCycleTimeMilliSec)
   TEST_ASSERT_EQUAL(255, GetTimerCompareMatch(timers[0]));
   TEST_ASSERT_EQUAL(1, GetTimerCompareMatchesPerCycle(timers[0]));
 
+  // Truncates to 256 ticks, which still fits without software divider
   TEST_ASSERT_TRUE(SetTimerCycleTimeMilliSec(timers[0], 263));
   TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, System_TimerGetClockSource(GetTimerSystemID(timers[0])));
-  TEST_ASSERT_EQUAL(127, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(256, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(256, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(1, GetTimerCompareMatchesPerCycle(timers[0]));
+
+  TEST_ASSERT_TRUE(SetTimerCycleTimeMilliSec(timers[0], 264));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, System_TimerGetClockSource(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(128, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
   TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, GetTimerClockSource(timers[0]));
-  TEST_ASSERT_EQUAL(127, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(128, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(129, GetTimerFinalCompareMatch(timers[0]));
   TEST_ASSERT_EQUAL(2, GetTimerCompareMatchesPerCycle(timers[0]));
 
   TEST_ASSERT_TRUE(SetTimerCycleTimeMilliSec(timers[0], 500));
@@ -334,9 +589,10 @@ TEST(TimerDriver, SetCycleTimeMilliSec)
 
   TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 500));
   TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, System_TimerGetClockSource(GetTimerSystemID(timers[0])));
-  TEST_ASSERT_EQUAL(242, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(244, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
   TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, GetTimerClockSource(timers[0]));
-  TEST_ASSERT_EQUAL(242, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(244, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(246, GetTimerFinalCompareMatch(timers[0]));
   TEST_ASSERT_EQUAL(16, GetTimerCompareMatchesPerCycle(timers[0]));
 }
 
@@ -352,9 +608,9 @@ TEST(TimerDriver, ClockSourceSelection)
   StartTimer(timer);
   
   TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, System_TimerGetClockSource(GetTimerSystemID(timer)));
-  TEST_ASSERT_EQUAL(242, System_TimerGetCompareValue(GetTimerSystemID(timer)));
+  TEST_ASSERT_EQUAL(244, System_TimerGetCompareValue(GetTimerSystemID(timer)));
   TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, GetTimerClockSource(timer));
-  TEST_ASSERT_EQUAL(242, GetTimerCompareMatch(timer));
+  TEST_ASSERT_EQUAL(244, GetTimerCompareMatch(timer));
   TEST_ASSERT_EQUAL(16, GetTimerCompareMatchesPerCycle(timer));
 
   DestroyTimer(&timer);
@@ -430,10 +686,156 @@ TEST(TimerDriver, MaxTimerValue)
   TEST_ASSERT_EQUAL(1, GetTimerCompareMatchesPerCycle(timers[0]));
 }
 
-TEST(TimerDriver, HiFreqAccuracy)
+TEST(TimerDriver, FastClockMicroSec)
+{
+  testCreateAllTimers();
+
+  unsigned long int MAX_IDEAL_FREQ_MS_COUNTER = System_TimerGetMaxValue(GetTimerSystemID(timers[0])) * 1000;
+  unsigned long int MAX_CORE_CLOCK_FREQ = ((MAX_IDEAL_FREQ_MS_COUNTER + 1) * 1024) - 1;
+
+  // Sub-cycles shorter than 1 ms are allowed at microsecond resolution
+  System_SetCoreClockFrequency(MAX_CORE_CLOCK_FREQ + 1);
+  TEST_ASSERT(SetTimerCycleTimeMicroSec(timers[0], 1000000));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(1001, GetTimerCompareMatchesPerCycle(timers[0]));
+
+  // Slowest clock that can count a single microsecond
+  System_SetCoreClockFrequency(1000000);
+  TEST_ASSERT(SetTimerCycleTimeMicroSec(timers[0], 1));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT, System_TimerGetClockSource(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(1, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
+
+  System_SetCoreClockFrequency(999999);
+  TEST_ASSERT_FALSE(SetTimerCycleTimeMicroSec(timers[0], 1));
+  TEST_ASSERT_FALSE(SetTimerCycleTimeMicroSec(timers[0], 0));
+
+  // 50 us control loop at 8MHz
+  System_SetCoreClockFrequency(8000000);
+  TEST_ASSERT(SetTimerCycleTimeMicroSec(timers[0], 50));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE8, System_TimerGetClockSource(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(50, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(1, GetTimerCompareMatchesPerCycle(timers[0]));
+
+  // Same solution as the equivalent number of milliseconds
+  TEST_ASSERT(SetTimerCycleTimeMicroSec(timers[0], 500000));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(244, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(246, GetTimerFinalCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(16, GetTimerCompareMatchesPerCycle(timers[0]));
+}
+
+TEST(TimerDriver, MaxTimerValueMicroSec)
+{
+  testCreateAllTimers();
+
+  System_SetMaxTimerValue(
+      GetTimerSystemID(timers[0]),
+      65536 // 16-bit timer
+      );
+
+  TEST_ASSERT(SetTimerCycleTimeMicroSec(timers[0], 100000));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE8, System_TimerGetClockSource(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(12500, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(1, GetTimerCompareMatchesPerCycle(timers[0]));
+
+  // Longest cycle that fits the undivided clock
+  TEST_ASSERT(SetTimerCycleTimeMicroSec(timers[0], 65536));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT, System_TimerGetClockSource(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(65536, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(1, GetTimerCompareMatchesPerCycle(timers[0]));
+
+  TEST_ASSERT(SetTimerCycleTimeMicroSec(timers[0], 65537));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE8, System_TimerGetClockSource(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(8192, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(1, GetTimerCompareMatchesPerCycle(timers[0]));
+
+  // Would overflow 32-bit intermediate products at 16MHz
+  System_SetCoreClockFrequency(16000000);
+  TEST_ASSERT(SetTimerCycleTimeMicroSec(timers[0], 4000000000UL));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(954, GetTimerCompareMatchesPerCycle(timers[0]));
+  TEST_ASSERT_EQUAL(62500000, GetTimerCycleTicks(timers[0]) / 1024);
+}
+
+TEST(TimerDriver, SetCycleTimeTicks)
+{
+  testCreateAllTimers();
+
+  TEST_ASSERT(SetTimerCycleTimeTicks(timers[0], 1000));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE8, System_TimerGetClockSource(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(125, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(1000, GetTimerCycleTicks(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetTimerCycleErrorTicks(timers[0]));
+
+  // Truncated to whole ticks of the slower clock source
+  TEST_ASSERT(SetTimerCycleTimeTicks(timers[0], 1001));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE8, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(-1, GetTimerCycleErrorTicks(timers[0]));
+
+  TEST_ASSERT(SetTimerSolverMode(timers[0], TIMER_SOLVER_BEST_FIT));
+  TEST_ASSERT(SetTimerCycleTimeTicks(timers[0], 1001));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(250, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(251, GetTimerFinalCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(4, GetTimerCompareMatchesPerCycle(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetTimerCycleErrorTicks(timers[0]));
+
+  TEST_ASSERT_FALSE(SetTimerCycleTimeTicks(timers[0], 0));
+}
+
+TEST(TimerDriver, CompareValueIsTicksPerMatch)
+{
+  testCreateAllTimers();
+
+  System_TimerID id = GetTimerSystemID(timers[0]);
+
+  // The compare value is the whole period, not one less
+  TEST_ASSERT(SetTimerCycleTimeTicks(timers[0], 200));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(200, System_TimerGetCompareValue(id));
+  StartTimer(timers[0]);
+
+  System_AdvanceTime(199);
+  TEST_ASSERT_EQUAL(0, System_GetNumTimerCompareMatches(id));
+  TEST_ASSERT_EQUAL(199, System_TimerGetCount(id));
+  System_AdvanceTime(1);
+  TEST_ASSERT_EQUAL(1, System_GetNumTimerCompareMatches(id));
+  TEST_ASSERT_EQUAL(0, System_TimerGetCount(id));
+
+  System_AdvanceTime(200UL * 99);
+  TEST_ASSERT_EQUAL(100, System_GetNumTimerCompareMatches(id));
+  TEST_ASSERT_EQUAL(100, GetNumTimerCycles(timers[0]));
+}
+
+TEST(TimerDriver, HalOpsPerTimer)
 {
-  TEST_IGNORE_MESSAGE("Accuracy for long timers with high clock frequency not yet implemented.");
+  // Stand in a different kind of timer for the second one
+  static System_TimerOps countedOps;
+  countedOps = *system_timerOps[SYSTEM_TIMER1];
+  countedOps.setClockSource = CountedSetClockSource;
+  countedOps.setCompareMatch = CountedSetCompareMatch;
+  system_timerOps[SYSTEM_TIMER1] = &countedOps;
+
+  testCreateAllTimers();
+  numCountedOpsCalls = 0;
+
+  TEST_ASSERT(SetTimerCycleTimeTicks(timers[0], 200));
+  StartTimer(timers[0]);
+  TEST_ASSERT_EQUAL(0, numCountedOpsCalls);
+
+  // Only the second timer is driven through its own ops
+  TEST_ASSERT(SetTimerCycleTimeTicks(timers[1], 300));
+  StartTimer(timers[1]);
+  TEST_ASSERT(numCountedOpsCalls > 0);
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER1, lastCountedOpsTimer);
+
+  System_AdvanceTime(600);
+  TEST_ASSERT_EQUAL(3, System_GetNumTimerCompareMatches(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(2, System_GetNumTimerCompareMatches(SYSTEM_TIMER1));
+}
 
+TEST(TimerDriver, HiFreqAccuracy)
+{
   testCreateAllTimers();
 
   // Change clock to 8MHz
@@ -444,9 +846,78 @@ TEST(TimerDriver, HiFreqAccuracy)
   TEST_ASSERT_EQUAL(252, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
   TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, GetTimerClockSource(timers[0]));
   TEST_ASSERT_EQUAL(252, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(252, GetTimerFinalCompareMatch(timers[0]));
   TEST_ASSERT_EQUAL(31, GetTimerCompareMatchesPerCycle(timers[0]));
 }
 
+TEST(TimerDriver, FinalSubCycleCompareMatch)
+{
+  testCreateAllTimers();
+
+  // Change clock to 8MHz
+  System_SetCoreClockFrequency(8000000);
+
+  // 3906 ticks split into 15 sub-cycles of 244 and a final one of 246
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 500));
+  StartTimer(timers[0]);
+  TEST_ASSERT_EQUAL(244, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
+
+  unsigned int matchIdx;
+  for(
+      matchIdx = 0;
+      matchIdx < 14;
+      matchIdx++
+     )
+  {
+    (*(System_GetEventCallback(SYSTEM_EVENT_TIMER0_COMPAREMATCH)))(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+    TEST_ASSERT_EQUAL(244, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
+  }
+
+  (*(System_GetEventCallback(SYSTEM_EVENT_TIMER0_COMPAREMATCH)))(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  TEST_ASSERT_EQUAL(15, GetNumTimerCompareMatches(timers[0]));
+  TEST_ASSERT_EQUAL(246, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
+
+  (*(System_GetEventCallback(SYSTEM_EVENT_TIMER0_COMPAREMATCH)))(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(244, System_TimerGetCompareValue(GetTimerSystemID(timers[0])));
+}
+
+TEST(TimerDriver, BestFitCycleTime)
+{
+  testCreateAllTimers();
+
+  TEST_ASSERT_EQUAL(TIMER_SOLVER_FIRST_FIT, GetTimerSolverMode(timers[0]));
+
+  // First fit settles for 97 ticks at 1MHz/1024
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 100));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(97, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(99328, GetTimerCycleTicks(timers[0]));
+  TEST_ASSERT_EQUAL(-672, GetTimerCycleErrorTicks(timers[0]));
+
+  // Best fit finds the exact 12500 ticks at 1MHz/8
+  TEST_ASSERT(SetTimerSolverMode(timers[0], TIMER_SOLVER_BEST_FIT));
+  TEST_ASSERT_EQUAL(TIMER_SOLVER_BEST_FIT, GetTimerSolverMode(timers[0]));
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 100));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE8, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE8, System_TimerGetClockSource(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(256, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(212, GetTimerFinalCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(49, GetTimerCompareMatchesPerCycle(timers[0]));
+  TEST_ASSERT_EQUAL(100000, GetTimerCycleTicks(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetTimerCycleErrorTicks(timers[0]));
+
+  // Exact at several clock sources, so the fewest compare matches wins
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 8));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE64, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(125, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(1, GetTimerCompareMatchesPerCycle(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetTimerCycleErrorTicks(timers[0]));
+
+  TEST_ASSERT_FALSE(SetTimerSolverMode(timers[0], (TimerSolverMode)42));
+  TEST_ASSERT_EQUAL(TIMER_SOLVER_BEST_FIT, GetTimerSolverMode(timers[0]));
+}
+
 TEST(TimerDriver, EnableCompareMatchEvents)
 {
   testCreateAllTimers();
@@ -538,6 +1009,21 @@ TEST(TimerDriver, CompareMatchMultiTimers)
   TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[1]));
 }
 
+TEST(TimerDriver, CompareMatchInvalidEvent)
+{
+  testCreateAllTimers();
+
+  SetTimerCycleTimeMilliSec(timers[0], 250);
+  StartTimer(timers[0]);
+
+  (*(System_GetEventCallback(SYSTEM_EVENT_TIMER0_COMPAREMATCH)))(SYSTEM_EVENT_INVALID);
+  TEST_ASSERT_EQUAL(0, GetNumTimerCompareMatches(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetNumTimerCycles(timers[0]));
+
+  (*(System_GetEventCallback(SYSTEM_EVENT_TIMER0_COMPAREMATCH)))(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
+}
+
 TEST(TimerDriver, CompareOutputMode)
 {
   testCreateAllTimers();
@@ -550,12 +1036,12 @@ TEST(TimerDriver, CompareOutputMode)
      )
   {
     TEST_ASSERT_EQUAL(SYSTEM_TIMER_OUTPUT_MODE_NONE, GetTimerCompareOutputMode(timers[timerIdx], SYSTEM_TIMER_OUTPUT_A));
-    TEST_ASSERT_EQUAL(SYSTEM_TIMER_OUTPUT_MODE_NONE, System_TimerGetCompareOutputMode(timerIdx));
+    TEST_ASSERT_EQUAL(SYSTEM_TIMER_OUTPUT_MODE_NONE, System_TimerGetCompareOutputMode(timerIdx, SYSTEM_TIMER_OUTPUT_A));
   }
 
   TEST_ASSERT(SetTimerCompareOutputMode(timers[0], SYSTEM_TIMER_OUTPUT_A, SYSTEM_TIMER_OUTPUT_MODE_SET));
   TEST_ASSERT_EQUAL(SYSTEM_TIMER_OUTPUT_MODE_SET, GetTimerCompareOutputMode(timers[0], SYSTEM_TIMER_OUTPUT_A));
-  TEST_ASSERT_EQUAL(SYSTEM_TIMER_OUTPUT_MODE_SET, System_TimerGetCompareOutputMode(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_OUTPUT_MODE_SET, System_TimerGetCompareOutputMode(GetTimerSystemID(timers[0]), SYSTEM_TIMER_OUTPUT_A));
 }
 
 TEST(TimerDriver, CustomCycleHandler)
@@ -575,32 +1061,122 @@ TEST(TimerDriver, CustomCycleHandler)
   TEST_ASSERT_EQUAL(1, numCustomTimerCycles);
 }
 
-TEST(TimerDriver, SingleShot)
+TEST(TimerDriver, CustomCycleHandlerEx)
 {
   testCreateAllTimers();
 
-  SetTimerCycleTimeMilliSec(timers[0], 500);
-  StartTimer(timers[0]);
-  
-  TEST_ASSERT_EQUAL(0, GetNumTimerCycles(timers[0]));
-  TEST_ASSERT(WaitForTimer(timers[0]));
-  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
-  TEST_ASSERT_EQUAL(0, GetNumTimerCompareMatches(timers[0]));
-  TEST_ASSERT_EQUAL(2, System_GetNumTimerWaitChecks(GetTimerSystemID(timers[0])));
-}
+  unsigned int numCycles [2] = { 0, 0 };
 
-TEST(TimerDriver, SingleShotAutoStart)
-{
-  testCreateAllTimers();
+  TEST_ASSERT_NULL(GetTimerCycleHandlerEx(timers[0]));
+  TEST_ASSERT_NULL(GetTimerCycleHandlerContext(timers[0]));
 
-  SetTimerCycleTimeMilliSec(timers[0], 500);
-  
-  TEST_ASSERT_EQUAL(0, GetNumTimerCycles(timers[0]));
-  TEST_ASSERT(WaitForTimer(timers[0]));
-  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
-  TEST_ASSERT_EQUAL(0, GetNumTimerCompareMatches(timers[0]));
-  TEST_ASSERT_EQUAL(2, System_GetNumTimerWaitChecks(GetTimerSystemID(timers[0])));
-}
+  // One handler serving two timers
+  TEST_ASSERT(SetTimerCycleHandlerEx(timers[0], ContextTimerCycleCounter, &numCycles[0]));
+  TEST_ASSERT(SetTimerCycleHandlerEx(timers[1], ContextTimerCycleCounter, &numCycles[1]));
+  TEST_ASSERT_EQUAL_HEX(ContextTimerCycleCounter, GetTimerCycleHandlerEx(timers[0]));
+  TEST_ASSERT_EQUAL_PTR(&numCycles[1], GetTimerCycleHandlerContext(timers[1]));
+
+  SetTimerCycleTimeMilliSec(timers[0], 250);
+  SetTimerCycleTimeMilliSec(timers[1], 250);
+  StartTimer(timers[0]);
+  StartTimer(timers[1]);
+
+  testFireCompareMatch(GetTimerSystemID(timers[1]));
+  TEST_ASSERT_EQUAL_PTR(timers[1], lastContextTimer);
+  TEST_ASSERT_EQUAL(0, numCycles[0]);
+  TEST_ASSERT_EQUAL(1, numCycles[1]);
+
+  testFireCompareMatch(GetTimerSystemID(timers[0]));
+  TEST_ASSERT_EQUAL_PTR(timers[0], lastContextTimer);
+  TEST_ASSERT_EQUAL(1, numCycles[0]);
+
+  // Setting a plain handler replaces the one taking a context
+  TEST_ASSERT(SetTimerCycleHandler(timers[0], CustomTimerCycleCounter));
+  TEST_ASSERT_NULL(GetTimerCycleHandlerEx(timers[0]));
+  testFireCompareMatch(GetTimerSystemID(timers[0]));
+  TEST_ASSERT_EQUAL(1, numCycles[0]);
+  TEST_ASSERT_EQUAL(1, numCustomTimerCycles);
+
+  TEST_ASSERT(SetTimerCycleHandlerEx(timers[0], ContextTimerCycleCounter, &numCycles[0]));
+  TEST_ASSERT_NULL(GetTimerCycleHandler(timers[0]));
+}
+
+TEST(TimerDriver, ImmediateHandlerMode)
+{
+  testCreateAllTimers();
+  InitTimerEvents();
+
+  System_EventType immediateEvent = System_GetTimerCallbackEvent(GetTimerSystemID(timers[0]));
+  System_EventType deferredEvent = System_GetTimerCallbackEvent(GetTimerSystemID(timers[1]));
+
+  TEST_ASSERT_EQUAL(TIMER_HANDLER_DEFERRED, GetTimerHandlerMode(timers[0]));
+  TEST_ASSERT(SetTimerHandlerMode(timers[0], TIMER_HANDLER_IMMEDIATE));
+  TEST_ASSERT_EQUAL(TIMER_HANDLER_IMMEDIATE, GetTimerHandlerMode(timers[0]));
+  TEST_ASSERT(GetTimerEventImmediate(immediateEvent));
+  TEST_ASSERT_FALSE(SetTimerHandlerMode(timers[0], (TimerHandlerMode)42));
+
+  SetTimerCycleTimeMilliSec(timers[0], 8);
+  SetTimerCycleHandler(timers[0], CustomTimerCycleCounter);
+  StartTimer(timers[0]);
+  SetTimerCycleTimeMilliSec(timers[1], 8);
+  SetTimerCycleHandler(timers[1], CustomTimerCycleCounter);
+  StartTimer(timers[1]);
+
+  // Handled as the interrupt posts it
+  TEST_ASSERT(PostTimerEvent(immediateEvent));
+  TEST_ASSERT_EQUAL(1, numCustomTimerCycles);
+  TEST_ASSERT_EQUAL(0, GetNumQueuedTimerEvents());
+
+  // Handled once the main loop gets to it
+  TEST_ASSERT(PostTimerEvent(deferredEvent));
+  TEST_ASSERT_EQUAL(1, numCustomTimerCycles);
+  TEST_ASSERT_EQUAL(1, ProcessTimerEvents());
+  TEST_ASSERT_EQUAL(2, numCustomTimerCycles);
+
+  // Switching back while running leaves the interrupt enabled
+  TEST_ASSERT(SetTimerHandlerMode(timers[0], TIMER_HANDLER_DEFERRED));
+  TEST_ASSERT_FALSE(GetTimerEventImmediate(immediateEvent));
+  TEST_ASSERT(System_GetEvent(immediateEvent));
+
+  // Virtual timers share the base interrupt
+  TimerInstance* virtualTimer = CreateTimer();
+  TEST_ASSERT_FALSE(SetTimerHandlerMode(virtualTimer, TIMER_HANDLER_IMMEDIATE));
+  TEST_ASSERT_EQUAL(TIMER_HANDLER_DEFERRED, GetTimerHandlerMode(virtualTimer));
+
+  // Reset when the timer is handed out again
+  SetTimerHandlerMode(timers[0], TIMER_HANDLER_IMMEDIATE);
+  DestroyAllTimers();
+  TEST_ASSERT_FALSE(GetTimerEventImmediate(immediateEvent));
+}
+
+TEST(TimerDriver, SingleShot)
+{
+  testCreateAllTimers();
+
+  SetTimerCycleTimeMilliSec(timers[0], 500);
+  StartTimer(timers[0]);
+  
+  TEST_ASSERT_EQUAL(0, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT(WaitForTimer(timers[0]));
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetNumTimerCompareMatches(timers[0]));
+  TEST_ASSERT_EQUAL(2, System_GetNumSleeps());
+  TEST_ASSERT(System_GetInterruptsEnabled());
+}
+
+TEST(TimerDriver, SingleShotAutoStart)
+{
+  testCreateAllTimers();
+
+  SetTimerCycleTimeMilliSec(timers[0], 500);
+  
+  TEST_ASSERT_EQUAL(0, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT(WaitForTimer(timers[0]));
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetNumTimerCompareMatches(timers[0]));
+  TEST_ASSERT_EQUAL(2, System_GetNumSleeps());
+  TEST_ASSERT(System_GetInterruptsEnabled());
+}
 
 TEST(TimerDriver, NoSingleShotWithoutConfig)
 {
@@ -630,10 +1206,1415 @@ TEST(TimerDriver, ResetOnNextSingleShot)
   
   TEST_ASSERT_EQUAL(0, GetNumTimerCycles(timers[0]));
   TEST_ASSERT(WaitForTimer(timers[0]));
-  TEST_ASSERT_EQUAL(2, System_GetNumTimerWaitChecks(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(2, System_GetNumSleeps());
   TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
   
   TEST_ASSERT(WaitForTimer(timers[0]));
-  TEST_ASSERT_EQUAL(4, System_GetNumTimerWaitChecks(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(4, System_GetNumSleeps());
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
+}
+
+TEST(TimerDriver, VirtualTimerFallback)
+{
+  testCreateAllTimers();
+
+  System_TimerID baseTimer = SYSTEM_NUM_TIMERS - 1;
+  TimerInstance* extraTimer = CreateTimer();
+
+  TEST_ASSERT_NOT_NULL(timers[baseTimer]);
+  TEST_ASSERT_NOT_NULL(extraTimer);
+  TEST_ASSERT_EQUAL(baseTimer, GetTimerSystemID(timers[baseTimer]));
+  TEST_ASSERT_EQUAL(baseTimer, GetTimerSystemID(extraTimer));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_STOPPED, GetTimerStatus(extraTimer));
+  TEST_ASSERT_FALSE(SetTimerCompareOutputMode(extraTimer, SYSTEM_TIMER_OUTPUT_A, SYSTEM_TIMER_OUTPUT_MODE_SET));
+
+  DestroyTimer(&extraTimer);
+  TEST_ASSERT_NULL(extraTimer);
+}
+
+TEST(TimerDriver, VirtualTimerMultiplexing)
+{
+  testCreateAllTimers();
+
+  System_TimerID baseTimer = SYSTEM_NUM_TIMERS - 1;
+  TimerInstance* fastTimer = timers[baseTimer];
+  TimerInstance* slowTimer = CreateTimer();
+
+  // Virtual timers run off the 1MHz / 256 clock source
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(fastTimer, 10));
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(slowTimer, 25));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE256, GetTimerClockSource(fastTimer));
+  TEST_ASSERT_EQUAL(39, GetTimerCompareMatch(fastTimer));
+  TEST_ASSERT_EQUAL(97, GetTimerCompareMatch(slowTimer));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_OFF, System_TimerGetClockSource(baseTimer));
+
+  TEST_ASSERT(StartTimer(fastTimer));
+  TEST_ASSERT(StartTimer(slowTimer));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_RUNNING, GetTimerStatus(slowTimer));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE256, System_TimerGetClockSource(baseTimer));
+  TEST_ASSERT(System_GetEvent(System_GetTimerCallbackEvent(baseTimer)));
+  TEST_ASSERT_EQUAL(39, System_TimerGetCompareValue(baseTimer));
+
+  // Slow timer was started while the base was running, so it counts from tick 39
+  testFireCompareMatch(baseTimer);
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(fastTimer));
+  TEST_ASSERT_EQUAL(39, System_TimerGetCompareValue(baseTimer));
+
+  testFireCompareMatch(baseTimer);
+  TEST_ASSERT_EQUAL(2, GetNumTimerCycles(fastTimer));
+  TEST_ASSERT_EQUAL(39, System_TimerGetCompareValue(baseTimer));
+
+  testFireCompareMatch(baseTimer);
+  TEST_ASSERT_EQUAL(3, GetNumTimerCycles(fastTimer));
+  TEST_ASSERT_EQUAL(0, GetNumTimerCycles(slowTimer));
+  TEST_ASSERT_EQUAL(19, System_TimerGetCompareValue(baseTimer));
+
+  testFireCompareMatch(baseTimer);
+  TEST_ASSERT_EQUAL(3, GetNumTimerCycles(fastTimer));
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(slowTimer));
+  TEST_ASSERT_EQUAL(20, System_TimerGetCompareValue(baseTimer));
+
+  testFireCompareMatch(baseTimer);
+  TEST_ASSERT_EQUAL(4, GetNumTimerCycles(fastTimer));
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(slowTimer));
+  TEST_ASSERT_EQUAL(39, System_TimerGetCompareValue(baseTimer));
+
+  DestroyTimer(&slowTimer);
+}
+
+TEST(TimerDriver, VirtualTimerStop)
+{
+  testCreateAllTimers();
+
+  System_TimerID baseTimer = SYSTEM_NUM_TIMERS - 1;
+  TimerInstance* firstTimer = timers[baseTimer];
+  TimerInstance* secondTimer = CreateTimer();
+
+  SetTimerCycleTimeMilliSec(firstTimer, 10);
+  SetTimerCycleTimeMilliSec(secondTimer, 20);
+  StartTimer(firstTimer);
+  StartTimer(secondTimer);
+
+  StopTimer(firstTimer);
+  TEST_ASSERT_EQUAL(TIMER_STATUS_STOPPED, GetTimerStatus(firstTimer));
+  TEST_ASSERT(System_GetEvent(System_GetTimerCallbackEvent(baseTimer)));
+
+  // Second timer's first match is still due on the tick programmed into the base
+  testFireCompareMatch(baseTimer);
+  TEST_ASSERT_EQUAL(0, GetNumTimerCycles(firstTimer));
+  TEST_ASSERT_EQUAL(0, GetNumTimerCycles(secondTimer));
+  TEST_ASSERT_EQUAL(78, System_TimerGetCompareValue(baseTimer));
+
+  testFireCompareMatch(baseTimer);
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(secondTimer));
+
+  StopTimer(secondTimer);
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_OFF, System_TimerGetClockSource(baseTimer));
+  TEST_ASSERT_FALSE(System_GetEvent(System_GetTimerCallbackEvent(baseTimer)));
+
+  DestroyTimer(&secondTimer);
+}
+
+TEST(TimerDriver, VirtualSingleShot)
+{
+  testCreateAllTimers();
+
+  System_TimerID baseTimer = SYSTEM_NUM_TIMERS - 1;
+
+  SetTimerCycleTimeMilliSec(timers[baseTimer], 500);
+
+  TEST_ASSERT(WaitForTimer(timers[baseTimer]));
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[baseTimer]));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_STOPPED, GetTimerStatus(timers[baseTimer]));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_OFF, System_TimerGetClockSource(baseTimer));
+}
+
+TEST(TimerDriver, SimulatedCycleTime)
+{
+  testCreateAllTimers();
+
+  SetTimerCycleTimeMilliSec(timers[0], 500);
+  SetTimerCycleHandler(timers[0], RecordCycleTime);
+  StartTimer(timers[0]);
+
+  // The fastest clock source is the core clock
+  unsigned long long int cycleLength = GetTimerCycleTicks(timers[0]);
+
+  System_AdvanceTime(cycleLength - 1);
+  TEST_ASSERT_EQUAL(0, GetNumTimerCycles(timers[0]));
+  System_AdvanceTime(1);
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(cycleLength, lastCycleTime);
+
+  // First fit runs short, so it drifts ahead over an hour
+  System_AdvanceTimeMilliSec(3600000UL - 500);
+  unsigned long int expectedCycles = (unsigned long int)(3600000000ULL / cycleLength);
+  TEST_ASSERT_EQUAL(expectedCycles, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(expectedCycles, numCustomTimerCycles);
+  TEST_ASSERT(expectedCycles > 7200);
+  TEST_ASSERT_EQUAL(expectedCycles * cycleLength, lastCycleTime);
+}
+
+TEST(TimerDriver, SimulatedNoDrift)
+{
+  testCreateAllTimers();
+
+  TEST_ASSERT(SetTimerSolverMode(timers[0], TIMER_SOLVER_BEST_FIT));
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 500));
+  TEST_ASSERT_EQUAL(0, GetTimerCycleErrorTicks(timers[0]));
+  SetTimerCycleHandler(timers[0], RecordCycleTime);
+  StartTimer(timers[0]);
+
+  // Ten hours, with every sub-cycle of every cycle simulated
+  System_AdvanceTimeMilliSec(36000000UL);
+  TEST_ASSERT_EQUAL(72000, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(36000000000ULL, lastCycleTime);
+  TEST_ASSERT_EQUAL(72000UL * GetTimerCompareMatchesPerCycle(timers[0]), System_GetNumTimerCompareMatches(GetTimerSystemID(timers[0])));
+  TEST_ASSERT_EQUAL(0, System_GetNumLostEvents());
+  TEST_ASSERT_EQUAL(0, GetTimerNumOverruns(timers[0]));
+}
+
+TEST(TimerDriver, SimulatedVirtualTimers)
+{
+  testCreateAllTimers();
+
+  System_TimerID baseTimer = SYSTEM_NUM_TIMERS - 1;
+  TimerInstance* otherTimer = CreateTimer();
+
+  SetTimerCycleTimeMilliSec(timers[baseTimer], 10);
+  SetTimerCycleTimeMilliSec(otherTimer, 15);
+  StartTimer(timers[baseTimer]);
+  StartTimer(otherTimer);
+
+  System_AdvanceTimeMilliSec(3000);
+
+  // The second timer starts counting at the base's first match
+  TEST_ASSERT_EQUAL(3000000ULL / GetTimerCycleTicks(timers[baseTimer]), GetNumTimerCycles(timers[baseTimer]));
+  TEST_ASSERT_UINT_WITHIN(1, 3000000ULL / GetTimerCycleTicks(otherTimer), GetNumTimerCycles(otherTimer));
+  TEST_ASSERT_EQUAL(0, System_GetNumLostEvents());
+}
+
+TEST(TimerDriver, SimulatedOverload)
+{
+  testCreateAllTimers();
+
+  // Handler runs for two and a half cycles
+  SetTimerCycleTimeMilliSec(timers[0], 2);
+  TEST_ASSERT_EQUAL(1, GetTimerCompareMatchesPerCycle(timers[0]));
+  overloadCycles = (GetTimerCycleTicks(timers[0]) * 5) / 2;
+  SetTimerCycleHandler(timers[0], OverloadingCycleHandler);
+  StartTimer(timers[0]);
+
+  System_AdvanceTimeMilliSec(1000);
+
+  unsigned long int numCompareMatches = System_GetNumTimerCompareMatches(GetTimerSystemID(timers[0]));
+  // The last handler may run on past the end of the requested time
+  TEST_ASSERT(System_GetTime() >= 1000000ULL);
+  TEST_ASSERT_EQUAL(System_GetTime() / GetTimerCycleTicks(timers[0]), numCompareMatches);
+  TEST_ASSERT(GetNumTimerCycles(timers[0]) < numCompareMatches);
+  TEST_ASSERT(System_GetNumLostEvents() > 0);
+  TEST_ASSERT(GetTimerNumOverruns(timers[0]) > 0);
+  TEST_ASSERT_UINT_WITHIN(1, numCompareMatches, GetNumTimerCycles(timers[0]) + System_GetNumLostEvents());
+}
+
+TEST(TimerDriver, SimulatedWaitForTimer)
+{
+  testCreateAllTimers();
+
+  SetTimerCycleTimeMilliSec(timers[0], 500);
+
+  TEST_ASSERT(WaitForTimer(timers[0]));
+  TEST_ASSERT_EQUAL(GetTimerCycleTicks(timers[0]), System_GetTime());
+  TEST_ASSERT_EQUAL(GetTimerCompareMatchesPerCycle(timers[0]), System_GetNumSleeps());
+}
+
+TEST(TimerDriver, SimulatedWaitForTimerDeferred)
+{
+  testCreateAllTimers();
+
+  // Each compare match is only counted once the main loop processes it
+  TEST_ASSERT_EQUAL(TIMER_HANDLER_DEFERRED, GetTimerHandlerMode(timers[0]));
+  SetTimerCycleTimeMilliSec(timers[0], 2);
+  TEST_ASSERT_EQUAL(1, GetTimerCompareMatchesPerCycle(timers[0]));
+  SetTimerCycleHandler(timers[0], RecordCycleTime);
+
+  TEST_ASSERT(WaitForTimer(timers[0]));
+  TEST_ASSERT_EQUAL(1, numCustomTimerCycles);
+  TEST_ASSERT_EQUAL(GetTimerCycleTicks(timers[0]), lastCycleTime);
+  TEST_ASSERT_EQUAL(GetTimerCycleTicks(timers[0]), System_GetTime());
+  TEST_ASSERT_EQUAL(0, GetNumQueuedTimerEvents());
+  TEST_ASSERT(System_GetInterruptsEnabled());
+
+  // Immediate handlers complete the cycle from the interrupt alone
+  SetTimerCycleTimeMilliSec(timers[1], 2);
+  SetTimerCycleHandler(timers[1], RecordCycleTime);
+  TEST_ASSERT(SetTimerHandlerMode(timers[1], TIMER_HANDLER_IMMEDIATE));
+  TEST_ASSERT(WaitForTimer(timers[1]));
+  TEST_ASSERT_EQUAL(2, numCustomTimerCycles);
+  TEST_ASSERT_EQUAL(2 * GetTimerCycleTicks(timers[1]), System_GetTime());
+}
+
+TEST(TimerDriver, LatencyStatsOnTime)
+{
+  testCreateAllTimers();
+
+  TimerLatencyStats stats;
+  TEST_ASSERT(GetTimerLatencyStats(timers[0], &stats));
+  TEST_ASSERT_EQUAL(0, stats.numSamples);
+
+  SetTimerCycleTimeMilliSec(timers[0], 500);
+  StartTimer(timers[0]);
+  System_AdvanceTimeMilliSec(2000);
+
+  TEST_ASSERT(GetTimerLatencyStats(timers[0], &stats));
+  TEST_ASSERT_EQUAL(GetNumTimerCycles(timers[0]), stats.numSamples);
+  TEST_ASSERT(stats.numSamples > 0);
+  TEST_ASSERT_EQUAL(0, stats.minTicks);
+  TEST_ASSERT_EQUAL(0, stats.maxTicks);
+  TEST_ASSERT_EQUAL(stats.numSamples, stats.buckets[0]);
+  TEST_ASSERT(System_GetInterruptsEnabled());
+}
+
+TEST(TimerDriver, LatencyStatsLateHandler)
+{
+  testCreateAllTimers();
+
+  // One tick of the core clock per compare match tick
+  TEST_ASSERT(SetTimerCycleTimeTicks(timers[0], 100));
+  TEST_ASSERT_EQUAL(1, GetTimerCompareMatchesPerCycle(timers[0]));
+  StartTimer(timers[0]);
+
+  System_AdvanceTime(100);
+
+  // Hold off the interrupt for five ticks past the match
+  System_DisableInterrupts();
+  System_AdvanceTime(105);
+  System_EnableInterrupts();
+  System_AdvanceTime(0);
+
+  // And for a long stall, past the last bucket
+  System_DisableInterrupts();
+  System_AdvanceTime(190);
+  System_EnableInterrupts();
+  System_AdvanceTime(0);
+
+  TimerLatencyStats stats;
+  TEST_ASSERT(GetTimerLatencyStats(timers[0], &stats));
+  TEST_ASSERT_EQUAL(3, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(3, stats.numSamples);
+  TEST_ASSERT_EQUAL(0, stats.minTicks);
+  TEST_ASSERT_EQUAL(95, stats.maxTicks);
+  TEST_ASSERT_EQUAL(1, stats.buckets[0]);
+  TEST_ASSERT_EQUAL(1, stats.buckets[3]);
+  TEST_ASSERT_EQUAL(1, stats.buckets[TIMER_LATENCY_NUM_BUCKETS - 1]);
+
+  ResetTimerLatencyStats(timers[0]);
+  TEST_ASSERT(GetTimerLatencyStats(timers[0], &stats));
+  TEST_ASSERT_EQUAL(0, stats.numSamples);
+  TEST_ASSERT_EQUAL(UINT_MAX, stats.minTicks);
+  TEST_ASSERT_EQUAL(0, stats.maxTicks);
+  TEST_ASSERT_EQUAL(0, stats.buckets[3]);
+}
+
+TEST(TimerDriver, LatencyStatsVirtualTimer)
+{
+  testCreateAllTimers();
+
+  TimerInstance* virtualTimer = CreateTimer();
+  SetTimerCycleTimeMilliSec(virtualTimer, 10);
+  StartTimer(virtualTimer);
+  System_AdvanceTimeMilliSec(100);
+
+  TimerLatencyStats stats;
+  TEST_ASSERT(GetTimerLatencyStats(virtualTimer, &stats));
+  TEST_ASSERT_EQUAL(GetNumTimerCycles(virtualTimer), stats.numSamples);
+  TEST_ASSERT_EQUAL(0, stats.maxTicks);
+
+  TEST_ASSERT_FALSE(GetTimerLatencyStats(NULL, &stats));
+  TEST_ASSERT_FALSE(GetTimerLatencyStats(virtualTimer, NULL));
+}
+
+TEST(TimerDriver, CatchUpPolicy)
+{
+  testCreateAllTimers();
+
+  TEST_ASSERT_EQUAL(TIMER_CATCHUP_SKIP, GetTimerCatchUpPolicy(timers[0]));
+  TEST_ASSERT(SetTimerCatchUpPolicy(timers[0], TIMER_CATCHUP_REPLAY));
+  TEST_ASSERT_EQUAL(TIMER_CATCHUP_REPLAY, GetTimerCatchUpPolicy(timers[0]));
+  TEST_ASSERT_FALSE(SetTimerCatchUpPolicy(timers[0], (TimerCatchUpPolicy)(TIMER_CATCHUP_COALESCE + 1)));
+  TEST_ASSERT_EQUAL(TIMER_CATCHUP_REPLAY, GetTimerCatchUpPolicy(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetTimerNumMissedCycles(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetTimerNumOverruns(timers[0]));
+}
+
+TEST(TimerDriver, CatchUpSkip)
+{
+  testCreateAllTimers();
+
+  SetTimerCycleTimeTicks(timers[0], 100);
+  SetTimerCycleHandler(timers[0], CustomTimerCycleCounter);
+  StartTimer(timers[0]);
+
+  testMissCompareMatches(SYSTEM_TIMER0, 2);
+
+  TEST_ASSERT_EQUAL(3, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(1, numCustomTimerCycles);
+  TEST_ASSERT_EQUAL(2, GetTimerNumMissedCycles(timers[0]));
+  TEST_ASSERT_EQUAL(2, GetTimerLastMissedCycles(timers[0]));
+
+  testFireCompareMatch(SYSTEM_TIMER0);
+  TEST_ASSERT_EQUAL(4, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(2, numCustomTimerCycles);
+  TEST_ASSERT_EQUAL(2, GetTimerNumMissedCycles(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetTimerLastMissedCycles(timers[0]));
+}
+
+TEST(TimerDriver, CatchUpReplay)
+{
+  testCreateAllTimers();
+
+  SetTimerCycleTimeTicks(timers[0], 100);
+  SetTimerCycleHandler(timers[0], CustomTimerCycleCounter);
+  SetTimerCatchUpPolicy(timers[0], TIMER_CATCHUP_REPLAY);
+  StartTimer(timers[0]);
+
+  testMissCompareMatches(SYSTEM_TIMER0, 2);
+
+  TEST_ASSERT_EQUAL(3, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(3, numCustomTimerCycles);
+  TEST_ASSERT_EQUAL(2, GetTimerNumMissedCycles(timers[0]));
+}
+
+TEST(TimerDriver, CatchUpCoalesce)
+{
+  testCreateAllTimers();
+
+  SetTimerCycleTimeTicks(timers[0], 100);
+  SetTimerCycleHandlerEx(timers[0], RecordMissedCycles, NULL);
+  SetTimerCatchUpPolicy(timers[0], TIMER_CATCHUP_COALESCE);
+  StartTimer(timers[0]);
+
+  testMissCompareMatches(SYSTEM_TIMER0, 4);
+
+  TEST_ASSERT_EQUAL(5, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(1, numCustomTimerCycles);
+  TEST_ASSERT_EQUAL(4, lastMissedCycles);
+  TEST_ASSERT_EQUAL(4, GetTimerNumMissedCycles(timers[0]));
+}
+
+TEST(TimerDriver, CatchUpWithinCycle)
+{
+  testCreateAllTimers();
+
+  // Four sub-cycles per cycle
+  SetTimerCycleTimeMilliSec(timers[0], 1000);
+  TEST_ASSERT_EQUAL(4, GetTimerCompareMatchesPerCycle(timers[0]));
+  SetTimerCycleHandler(timers[0], CustomTimerCycleCounter);
+  StartTimer(timers[0]);
+
+  // Missed matches that do not finish a cycle miss nothing
+  testMissCompareMatches(SYSTEM_TIMER0, 1);
+  TEST_ASSERT_EQUAL(2, GetNumTimerCompareMatches(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetTimerNumMissedCycles(timers[0]));
+
+  // The cycle completes on a missed match, so its handler is skipped
+  testMissCompareMatches(SYSTEM_TIMER0, 2);
+  TEST_ASSERT_EQUAL(1, GetNumTimerCompareMatches(timers[0]));
   TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(0, numCustomTimerCycles);
+  TEST_ASSERT_EQUAL(1, GetTimerNumMissedCycles(timers[0]));
+}
+
+TEST(TimerDriver, CatchUpFullQueue)
+{
+  testCreateAllTimers();
+  InitTimerEvents();
+
+  SetTimerCycleTimeTicks(timers[0], 100);
+  SetTimerCycleHandler(timers[0], CustomTimerCycleCounter);
+  StartTimer(timers[0]);
+
+  unsigned int eventIdx;
+  for(
+      eventIdx = 0;
+      eventIdx < TIMER_EVENT_QUEUE_SIZE + 2;
+      eventIdx++
+     )
+  {
+    PostTimerEvent(System_GetTimerCallbackEvent(SYSTEM_TIMER0));
+  }
+
+  TEST_ASSERT_EQUAL(TIMER_EVENT_QUEUE_SIZE, DispatchTimerEvents());
+  TEST_ASSERT_EQUAL(TIMER_EVENT_QUEUE_SIZE + 2, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(TIMER_EVENT_QUEUE_SIZE, numCustomTimerCycles);
+  TEST_ASSERT_EQUAL(2, GetTimerNumMissedCycles(timers[0]));
+
+  InitTimerEvents();
+}
+
+TEST(TimerDriver, CaptureStartStop)
+{
+  testCreateAllTimers();
+
+  TimerInstance* virtualTimer = CreateTimer();
+  TEST_ASSERT_FALSE(StartTimerCapture(virtualTimer, SYSTEM_TIMER_CAPTURE_RISING));
+  TEST_ASSERT_FALSE(StartTimerCapture(timers[0], SYSTEM_TIMER_CAPTURE_NONE));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_STOPPED, GetTimerStatus(timers[0]));
+
+  TEST_ASSERT(StartTimerCapture(timers[0], SYSTEM_TIMER_CAPTURE_RISING));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_RUNNING, GetTimerStatus(timers[0]));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CAPTURE_RISING, System_TimerGetCaptureEdge(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT, System_TimerGetClockSource(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(256, System_TimerGetCompareValue(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(TIMER_HANDLER_IMMEDIATE, GetTimerHandlerMode(timers[0]));
+  TEST_ASSERT(System_GetEvent(SYSTEM_EVENT_TIMER0_CAPTURE));
+  TEST_ASSERT_EQUAL(0, GetNumTimerCaptures(timers[0]));
+
+  StopTimer(timers[0]);
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CAPTURE_NONE, System_TimerGetCaptureEdge(SYSTEM_TIMER0));
+  TEST_ASSERT_FALSE(System_GetEvent(SYSTEM_EVENT_TIMER0_CAPTURE));
+}
+
+TEST(TimerDriver, CaptureBothEdges)
+{
+  testCreateAllTimers();
+
+  // Edges both within and many wraps of the counter apart
+  static const unsigned long long int edgeTimes [] = { 1000, 1300, 2000, 2450, 100000, 100001 };
+  System_InjectTimerInputEdges(SYSTEM_TIMER0, edgeTimes, 6);
+
+  TEST_ASSERT(StartTimerCapture(timers[0], SYSTEM_TIMER_CAPTURE_BOTH));
+  System_AdvanceTime(200000);
+
+  TEST_ASSERT_EQUAL(6, GetNumTimerCaptures(timers[0]));
+
+  TimerCapture captures [8];
+  TEST_ASSERT_EQUAL(6, ReadTimerCaptures(timers[0], captures, 8));
+  TEST_ASSERT_EQUAL(0, GetNumTimerCaptures(timers[0]));
+
+  unsigned int captureIdx;
+  for(
+      captureIdx = 0;
+      captureIdx < 6;
+      captureIdx++
+     )
+  {
+    TEST_ASSERT_EQUAL(edgeTimes[captureIdx], captures[captureIdx].timestamp);
+    TEST_ASSERT_EQUAL(((captureIdx % 2) == 0) ? TRUE : FALSE, captures[captureIdx].isRising);
+  }
+
+  // Pulse width and period
+  TEST_ASSERT_EQUAL(300, captures[1].timestamp - captures[0].timestamp);
+  TEST_ASSERT_EQUAL(1000, captures[2].timestamp - captures[0].timestamp);
+  TEST_ASSERT_EQUAL(0, GetNumLostTimerCaptures(timers[0]));
+}
+
+TEST(TimerDriver, CaptureRisingEdges)
+{
+  testCreateAllTimers();
+
+  static const unsigned long long int edgeTimes [] = { 10, 20, 30, 40, 50 };
+  System_InjectTimerInputEdges(SYSTEM_TIMER1, edgeTimes, 5);
+
+  TEST_ASSERT(StartTimerCapture(timers[1], SYSTEM_TIMER_CAPTURE_RISING));
+  System_AdvanceTime(100);
+
+  // Read in more than one go
+  TimerCapture captures [2];
+  TEST_ASSERT_EQUAL(2, ReadTimerCaptures(timers[1], captures, 2));
+  TEST_ASSERT_EQUAL(10, captures[0].timestamp);
+  TEST_ASSERT_EQUAL(30, captures[1].timestamp);
+  TEST_ASSERT(captures[0].isRising);
+
+  TEST_ASSERT_EQUAL(1, ReadTimerCaptures(timers[1], captures, 2));
+  TEST_ASSERT_EQUAL(50, captures[0].timestamp);
+  TEST_ASSERT_EQUAL(0, ReadTimerCaptures(timers[1], captures, 2));
+}
+
+TEST(TimerDriver, CaptureBufferFull)
+{
+  testCreateAllTimers();
+
+  static const unsigned long long int edgeTimes [] =
+  {
+    100, 200, 300, 400, 500, 600, 700, 800, 900, 1000
+  };
+  System_InjectTimerInputEdges(SYSTEM_TIMER0, edgeTimes, 10);
+
+  TEST_ASSERT(StartTimerCapture(timers[0], SYSTEM_TIMER_CAPTURE_BOTH));
+  System_AdvanceTime(2000);
+
+  TEST_ASSERT_EQUAL(TIMER_CAPTURE_BUFFER_SIZE, GetNumTimerCaptures(timers[0]));
+  TEST_ASSERT_EQUAL(10 - TIMER_CAPTURE_BUFFER_SIZE, GetNumLostTimerCaptures(timers[0]));
+
+  // The oldest are kept
+  TimerCapture captures [TIMER_CAPTURE_BUFFER_SIZE];
+  TEST_ASSERT_EQUAL(TIMER_CAPTURE_BUFFER_SIZE, ReadTimerCaptures(timers[0], captures, TIMER_CAPTURE_BUFFER_SIZE));
+  TEST_ASSERT_EQUAL(100, captures[0].timestamp);
+
+  // Restarting discards what is left
+  System_AdvanceTime(100);
+  TEST_ASSERT(StartTimerCapture(timers[0], SYSTEM_TIMER_CAPTURE_BOTH));
+  TEST_ASSERT_EQUAL(0, GetNumTimerCaptures(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetNumLostTimerCaptures(timers[0]));
+}
+
+TEST(TimerDriver, CaptureBeforePendingWrap)
+{
+  testCreateAllTimers();
+
+  // Captured just after the counter wraps at 1024
+  static const unsigned long long int edgeTimes [] = { 1029 };
+  System_InjectTimerInputEdges(SYSTEM_TIMER0, edgeTimes, 1);
+
+  TEST_ASSERT(StartTimerCapture(timers[0], SYSTEM_TIMER_CAPTURE_RISING));
+  System_AdvanceTime(1000);
+
+  // Hold off the wrap's interrupt until after the capture's
+  System_DisableEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  System_AdvanceTime(100);
+  TEST_ASSERT(System_TimerGetCompareMatchPending(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(1, GetNumTimerCaptures(timers[0]));
+  System_EnableEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  System_AdvanceTime(0);
+
+  TimerCapture capture;
+  TEST_ASSERT_EQUAL(1, ReadTimerCaptures(timers[0], &capture, 1));
+  TEST_ASSERT_EQUAL(1029, capture.timestamp);
+  TEST_ASSERT_EQUAL(4, GetNumTimerCycles(timers[0]));
+}
+
+TEST(TimerDriver, PwmModes)
+{
+  testCreateAllTimers();
+
+  TimerInstance* virtualTimer = CreateTimer();
+  TEST_ASSERT_FALSE(SetTimerPwmMode(virtualTimer, TIMER_PWM_FAST));
+  TEST_ASSERT_FALSE(SetTimerPwmMode(timers[0], (TimerPwmMode)3));
+  TEST_ASSERT_FALSE(SetTimerPwmFrequency(timers[0], 5000));
+  TEST_ASSERT_EQUAL(TIMER_PWM_NONE, GetTimerPwmMode(timers[0]));
+
+  TEST_ASSERT(SetTimerPwmMode(timers[0], TIMER_PWM_FAST));
+  TEST_ASSERT_EQUAL(TIMER_PWM_FAST, GetTimerPwmMode(timers[0]));
+  TEST_ASSERT_EQUAL(TIMER_HANDLER_IMMEDIATE, GetTimerHandlerMode(timers[0]));
+
+  // Each period fits in a single compare match
+  TEST_ASSERT(SetTimerPwmFrequency(timers[0], 5000));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(200, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(1, GetTimerCompareMatchesPerCycle(timers[0]));
+  TEST_ASSERT_EQUAL(200, GetTimerCycleTicks(timers[0]));
+  TEST_ASSERT_FALSE(SetTimerPwmFrequency(timers[0], 1));
+
+  TEST_ASSERT(StartTimer(timers[0]));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_WAVEGEN_MODE_FAST_PWM, System_TimerGetWaveGenMode(SYSTEM_TIMER0));
+  TEST_ASSERT_FALSE(SetTimerPwmMode(timers[0], TIMER_PWM_PHASE_CORRECT));
+  StopTimer(timers[0]);
+
+  // Changing mode needs the frequency setting again
+  TEST_ASSERT(SetTimerPwmMode(timers[0], TIMER_PWM_PHASE_CORRECT));
+  TEST_ASSERT_FALSE(StartTimer(timers[0]));
+
+  // Counting up and back down takes twice the ticks of the compare match
+  TEST_ASSERT(SetTimerPwmFrequency(timers[0], 5000));
+  TEST_ASSERT_EQUAL(100, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(200, GetTimerCycleTicks(timers[0]));
+
+  TEST_ASSERT(StartTimer(timers[0]));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_WAVEGEN_MODE_PHASE_CORRECT_PWM, System_TimerGetWaveGenMode(SYSTEM_TIMER0));
+
+  // Nothing needs the compare match interrupt until a handler is set
+  TEST_ASSERT_FALSE(System_GetEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  SetTimerCycleHandler(timers[0], CustomTimerCycleCounter);
+  TEST_ASSERT(System_GetEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+
+  numCustomTimerCycles = 0;
+  System_AdvanceTime(1000);
+  TEST_ASSERT_EQUAL(5, numCustomTimerCycles);
+  StopTimer(timers[0]);
+
+  TEST_ASSERT(SetTimerPwmMode(timers[0], TIMER_PWM_NONE));
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 1));
+  TEST_ASSERT(StartTimer(timers[0]));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_WAVEGEN_MODE_CTC, System_TimerGetWaveGenMode(SYSTEM_TIMER0));
+}
+
+TEST(TimerDriver, PwmDutyCycle)
+{
+  testCreateAllTimers();
+
+  TEST_ASSERT_FALSE(SetTimerPwmDutyCycle(timers[0], 5000));
+  TEST_ASSERT(SetTimerPwmMode(timers[0], TIMER_PWM_FAST));
+  TEST_ASSERT(SetTimerPwmFrequency(timers[0], 5000));
+
+  // A stopped timer takes the duty cycle straight away
+  TEST_ASSERT(SetTimerPwmDutyCycle(timers[0], 2500));
+  TEST_ASSERT_EQUAL(2500, GetTimerPwmDutyCycle(timers[0]));
+  TEST_ASSERT_EQUAL(50, System_TimerGetPwmCompareValue(SYSTEM_TIMER0));
+  TEST_ASSERT_FALSE(SetTimerPwmDutyCycle(timers[0], TIMER_PWM_DUTY_CYCLE_MAX + 1));
+  TEST_ASSERT_EQUAL(2500, GetTimerPwmDutyCycle(timers[0]));
+
+  // The duty cycle is kept across frequencies
+  TEST_ASSERT(SetTimerPwmFrequency(timers[0], 10000));
+  TEST_ASSERT_EQUAL(25, System_TimerGetPwmCompareValue(SYSTEM_TIMER0));
+  TEST_ASSERT(SetTimerPwmDutyCycle(timers[0], TIMER_PWM_DUTY_CYCLE_MAX));
+  TEST_ASSERT_EQUAL(100, System_TimerGetPwmCompareValue(SYSTEM_TIMER0));
+
+  TEST_ASSERT(StartTimer(timers[0]));
+  TEST_ASSERT_FALSE(System_GetEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  System_AdvanceTime(50);
+
+  // A running timer waits for the end of the period
+  TEST_ASSERT(SetTimerPwmDutyCycle(timers[0], 7500));
+  TEST_ASSERT_EQUAL(100, System_TimerGetPwmCompareValue(SYSTEM_TIMER0));
+  TEST_ASSERT(System_GetEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+
+  System_AdvanceTime(49);
+  TEST_ASSERT_EQUAL(100, System_TimerGetPwmCompareValue(SYSTEM_TIMER0));
+
+  System_AdvanceTime(1);
+  TEST_ASSERT_EQUAL(75, System_TimerGetPwmCompareValue(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_FALSE(System_GetEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+
+  System_AdvanceTime(1000);
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(7500, GetTimerPwmDutyCycle(timers[0]));
+}
+
+TEST(TimerDriver, ClockStartStop)
+{
+  testCreateAllTimers();
+
+  TimerInstance* virtualTimer = CreateTimer();
+  TEST_ASSERT_FALSE(StartTimerClock(virtualTimer));
+  TEST_ASSERT_EQUAL(0, GetTimerTicks64());
+  TEST_ASSERT_EQUAL(0, GetTimerMicroSec64());
+
+  TEST_ASSERT(StartTimerClock(timers[0]));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_RUNNING, GetTimerStatus(timers[0]));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(256, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(TIMER_HANDLER_IMMEDIATE, GetTimerHandlerMode(timers[0]));
+
+  System_AdvanceTime(1000);
+  TEST_ASSERT_EQUAL(1000, GetTimerTicks64());
+  TEST_ASSERT_EQUAL(1000, GetTimerMicroSec64());
+
+  System_AdvanceTimeMilliSec(1000);
+  TEST_ASSERT_EQUAL(1001000, GetTimerTicks64());
+  TEST_ASSERT_EQUAL(1001000, GetTimerMicroSec64());
+
+  StopTimer(timers[0]);
+  TEST_ASSERT_EQUAL(0, GetTimerTicks64());
+
+  // Restarting starts again from zero
+  TEST_ASSERT(StartTimerClock(timers[1]));
+  System_AdvanceTime(300);
+  TEST_ASSERT_EQUAL(300, GetTimerTicks64());
+}
+
+TEST(TimerDriver, ClockPendingWrap)
+{
+  testCreateAllTimers();
+
+  TEST_ASSERT(StartTimerClock(timers[0]));
+  System_AdvanceTime(250);
+
+  // The counter wraps before the interrupt can count it
+  System_DisableInterrupts();
+  System_AdvanceTime(10);
+  TEST_ASSERT(System_TimerGetCompareMatchPending(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(4, System_TimerGetCount(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(260, GetTimerTicks64());
+
+  System_EnableInterrupts();
+  System_AdvanceTime(1);
+  TEST_ASSERT_FALSE(System_TimerGetCompareMatchPending(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(261, GetTimerTicks64());
+}
+
+TEST(TimerDriver, ClockWrapsAtMaxValue)
+{
+  testCreateAllTimers();
+
+  // The HAL is given the whole range as a number of ticks per wrap
+  TEST_ASSERT(StartTimerClock(timers[0]));
+  TEST_ASSERT_EQUAL(256, System_TimerGetCompareValue(SYSTEM_TIMER0));
+
+  System_AdvanceTime(255);
+  TEST_ASSERT_EQUAL(0, System_GetNumTimerCompareMatches(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(255, GetTimerTicks64());
+
+  System_AdvanceTime(1);
+  TEST_ASSERT_EQUAL(1, System_GetNumTimerCompareMatches(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(0, System_TimerGetCount(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(256, GetTimerTicks64());
+
+  // Each wrap adds exactly the ticks it took, with no drift
+  System_AdvanceTime((256ULL * 9999) + 17);
+  TEST_ASSERT_EQUAL(10000, System_GetNumTimerCompareMatches(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL((256ULL * 10000) + 17, GetTimerTicks64());
+  TEST_ASSERT_EQUAL(System_GetTime(), GetTimerTicks64());
+}
+
+TEST(TimerDriver, ClockWideRange)
+{
+  System_SetCoreClockFrequency(8000000);
+  System_SetMaxTimerValue(SYSTEM_TIMER0, 65535);
+  testCreateAllTimers();
+
+  // The slowest clock source resolving a microsecond wraps least often
+  TEST_ASSERT(StartTimerClock(timers[0]));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE8, GetTimerClockSource(timers[0]));
+
+  // Beyond the range of 32 bits of fastest clock source ticks
+  System_AdvanceTime(5000000000ULL);
+  TEST_ASSERT_EQUAL(5000000000ULL, GetTimerTicks64());
+  TEST_ASSERT_EQUAL(625000000ULL, GetTimerMicroSec64());
+
+  System_AdvanceTime(7);
+  TEST_ASSERT_EQUAL(5000000000ULL, GetTimerTicks64());
+  System_AdvanceTime(1);
+  TEST_ASSERT_EQUAL(5000000008ULL, GetTimerTicks64());
+  TEST_ASSERT_EQUAL(625000001ULL, GetTimerMicroSec64());
+}
+
+TEST(TimerDriver, DeadlinesStartStop)
+{
+  static unsigned int id = 0;
+
+  testCreateAllTimers();
+
+  TimerInstance* virtualTimer = CreateTimer();
+  TEST_ASSERT_FALSE(StartTimerDeadlines(virtualTimer));
+  TEST_ASSERT_EQUAL(TIMER_DEADLINE_INVALID, AddTimerDeadline(RecordDeadline, &id, 1000));
+
+  // Nothing runs until there is a deadline
+  TEST_ASSERT(StartTimerDeadlines(timers[0]));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_RUNNING, GetTimerStatus(timers[0]));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_OFF, System_TimerGetClockSource(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(TIMER_DEADLINE_INVALID, AddTimerDeadline(NULL, &id, 1000));
+
+  // The fastest clock source that reaches the deadline in one interval
+  TEST_ASSERT_EQUAL(0, AddTimerDeadline(RecordDeadline, &id, 1000));
+  TEST_ASSERT_EQUAL(1, GetNumTimerDeadlines());
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE8, System_TimerGetClockSource(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(125, System_TimerGetCompareValue(SYSTEM_TIMER0));
+
+  System_AdvanceTime(999);
+  TEST_ASSERT_EQUAL(0, numRecordedDeadlines);
+  System_AdvanceTime(1);
+  TEST_ASSERT_EQUAL(1, numRecordedDeadlines);
+  TEST_ASSERT_EQUAL(0, GetNumTimerDeadlines());
+  TEST_ASSERT_EQUAL(1, System_GetNumTimerCompareMatches(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_OFF, System_TimerGetClockSource(SYSTEM_TIMER0));
+
+  // Stopping drops pending deadlines
+  TEST_ASSERT(AddTimerDeadline(RecordDeadline, &id, 1000) != TIMER_DEADLINE_INVALID);
+  StopTimer(timers[0]);
+  TEST_ASSERT_EQUAL(0, GetNumTimerDeadlines());
+  TEST_ASSERT_EQUAL(TIMER_DEADLINE_INVALID, AddTimerDeadline(RecordDeadline, &id, 1000));
+  System_AdvanceTime(10000);
+  TEST_ASSERT_EQUAL(1, numRecordedDeadlines);
+}
+
+TEST(TimerDriver, DeadlinesAfterDestroyAllTimers)
+{
+  static unsigned int id = 0;
+
+  testCreateAllTimers();
+  TEST_ASSERT(StartTimerDeadlines(timers[0]));
+  TEST_ASSERT(AddTimerDeadline(RecordDeadline, &id, 1000) != TIMER_DEADLINE_INVALID);
+  TEST_ASSERT(AddTimerDeadline(RecordDeadline, &id, 2000) != TIMER_DEADLINE_INVALID);
+
+  // Pending deadlines go with the timer keeping them
+  DestroyAllTimers();
+  TEST_ASSERT_EQUAL(0, GetNumTimerDeadlines());
+  TEST_ASSERT_EQUAL(TIMER_DEADLINE_INVALID, AddTimerDeadline(RecordDeadline, &id, 1000));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_OFF, System_TimerGetClockSource(SYSTEM_TIMER0));
+  System_AdvanceTime(10000);
+  TEST_ASSERT_EQUAL(0, numRecordedDeadlines);
+
+  // A timer taking its place keeps deadlines from scratch
+  testCreateAllTimers();
+  TEST_ASSERT(StartTimerDeadlines(timers[0]));
+  TEST_ASSERT_EQUAL(0, AddTimerDeadline(RecordDeadline, &id, 1000));
+  TEST_ASSERT_EQUAL(1, GetNumTimerDeadlines());
+  System_AdvanceTime(1000);
+  TEST_ASSERT_EQUAL(1, numRecordedDeadlines);
+}
+
+TEST(TimerDriver, DeadlinesInOrder)
+{
+  static unsigned int ids [] = { 5, 1, 3, 2 };
+
+  testCreateAllTimers();
+  TEST_ASSERT(StartTimerDeadlines(timers[0]));
+
+  unsigned int deadlineIdx;
+  for(
+      deadlineIdx = 0;
+      deadlineIdx < 4;
+      deadlineIdx++
+     )
+  {
+    AddTimerDeadline(RecordDeadline, &ids[deadlineIdx], ids[deadlineIdx] * 1000);
+  }
+
+  System_AdvanceTimeMilliSec(10);
+  TEST_ASSERT_EQUAL(4, numRecordedDeadlines);
+
+  unsigned int expectedIds [] = { 1, 2, 3, 5 };
+  for(
+      deadlineIdx = 0;
+      deadlineIdx < 4;
+      deadlineIdx++
+     )
+  {
+    TEST_ASSERT_EQUAL(expectedIds[deadlineIdx], recordedDeadlines[deadlineIdx]);
+    TEST_ASSERT_EQUAL(expectedIds[deadlineIdx] * 1000, recordedDeadlineTimes[deadlineIdx]);
+  }
+
+  // Only woken when something was due, bar one short interval to land the
+  // first deadline after it was added under a slower clock source
+  TEST_ASSERT_EQUAL(5, System_GetNumTimerCompareMatches(SYSTEM_TIMER0));
+}
+
+TEST(TimerDriver, DeadlineBeyondCounter)
+{
+  static unsigned int id = 0;
+
+  testCreateAllTimers();
+  TEST_ASSERT(StartTimerDeadlines(timers[0]));
+
+  // Full intervals of the slowest clock source, then a finer one to land
+  // exactly on the deadline
+  AddTimerDeadline(RecordDeadline, &id, 1000000);
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE1024, System_TimerGetClockSource(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(256, System_TimerGetCompareValue(SYSTEM_TIMER0));
+
+  System_AdvanceTimeMilliSec(2000);
+  TEST_ASSERT_EQUAL(1, numRecordedDeadlines);
+  TEST_ASSERT_EQUAL(1000000, recordedDeadlineTimes[0]);
+  TEST_ASSERT(System_GetNumTimerCompareMatches(SYSTEM_TIMER0) <= 8);
+}
+
+TEST(TimerDriver, DeadlineEarlierWhileRunning)
+{
+  static unsigned int ids [] = { 0, 1 };
+
+  testCreateAllTimers();
+  TEST_ASSERT(StartTimerDeadlines(timers[0]));
+
+  AddTimerDeadline(RecordDeadline, &ids[0], 10000);
+  System_AdvanceTime(2000);
+
+  // The interval under way ends early for the new deadline
+  AddTimerDeadline(RecordDeadline, &ids[1], 1000);
+  System_AdvanceTimeMilliSec(20);
+
+  TEST_ASSERT_EQUAL(2, numRecordedDeadlines);
+  TEST_ASSERT_EQUAL(1, recordedDeadlines[0]);
+  TEST_ASSERT_EQUAL(0, recordedDeadlines[1]);
+  TEST_ASSERT_EQUAL(10000, recordedDeadlineTimes[1]);
+
+  // Late by no more than a tick of the clock source running when added
+  TEST_ASSERT(recordedDeadlineTimes[0] >= 3000);
+  TEST_ASSERT(recordedDeadlineTimes[0] < 3064);
+}
+
+TEST(TimerDriver, DeadlineAddedWhileMatchPending)
+{
+  static unsigned int ids [] = { 0, 1 };
+
+  testCreateAllTimers();
+  TEST_ASSERT(StartTimerDeadlines(timers[0]));
+  AddTimerDeadline(RecordDeadline, &ids[0], 1000);
+
+  // The interval ends before the interrupt can move the deadline time on
+  System_DisableInterrupts();
+  System_AdvanceTime(1500);
+  TEST_ASSERT(System_TimerGetCompareMatchPending(SYSTEM_TIMER0));
+  AddTimerDeadline(RecordDeadline, &ids[1], 1000);
+  System_EnableInterrupts();
+
+  System_AdvanceTimeMilliSec(5);
+  TEST_ASSERT_EQUAL(2, numRecordedDeadlines);
+  TEST_ASSERT_EQUAL(0, recordedDeadlines[0]);
+  TEST_ASSERT_EQUAL(1, recordedDeadlines[1]);
+
+  // Never early, and late by no more than a tick of the clock source
+  TEST_ASSERT(recordedDeadlineTimes[1] >= 2500);
+  TEST_ASSERT(recordedDeadlineTimes[1] < 2516);
+}
+
+TEST(TimerDriver, DeadlineAfterSlowHandler)
+{
+  static unsigned int ids [] = { 0, 1 };
+
+  testCreateAllTimers();
+  TEST_ASSERT(StartTimerDeadlines(timers[0]));
+  AddTimerDeadline(RecordDeadlineSlowly, &ids[0], 1000);
+  AddTimerDeadline(RecordDeadline, &ids[1], 5000);
+
+  // The time spent in the handler still counts toward the next deadline,
+  // although the next interval runs off a slower clock source
+  System_AdvanceTimeMilliSec(10);
+  TEST_ASSERT_EQUAL(2, numRecordedDeadlines);
+  TEST_ASSERT_EQUAL(1000, recordedDeadlineTimes[0]);
+  TEST_ASSERT(recordedDeadlineTimes[1] >= 5000);
+  TEST_ASSERT(recordedDeadlineTimes[1] < 5064);
+}
+
+TEST(TimerDriver, DeadlineCancel)
+{
+  static unsigned int ids [] = { 0, 1, 2 };
+
+  testCreateAllTimers();
+  TEST_ASSERT(StartTimerDeadlines(timers[0]));
+
+  unsigned int first = AddTimerDeadline(RecordDeadline, &ids[0], 1000);
+  unsigned int second = AddTimerDeadline(RecordDeadline, &ids[1], 2000);
+  unsigned int third = AddTimerDeadline(RecordDeadline, &ids[2], 3000);
+
+  TEST_ASSERT(CancelTimerDeadline(first));
+  TEST_ASSERT(CancelTimerDeadline(third));
+  TEST_ASSERT_FALSE(CancelTimerDeadline(third));
+  TEST_ASSERT_FALSE(CancelTimerDeadline(TIMER_DEADLINE_INVALID));
+  TEST_ASSERT_EQUAL(1, GetNumTimerDeadlines());
+
+  System_AdvanceTimeMilliSec(5);
+  TEST_ASSERT_EQUAL(1, numRecordedDeadlines);
+  TEST_ASSERT_EQUAL(1, recordedDeadlines[0]);
+  TEST_ASSERT_EQUAL(2000, recordedDeadlineTimes[0]);
+  TEST_ASSERT_FALSE(CancelTimerDeadline(second));
+}
+
+TEST(TimerDriver, DeadlineAddedByHandler)
+{
+  static unsigned int id = 0;
+
+  testCreateAllTimers();
+  TEST_ASSERT(StartTimerDeadlines(timers[0]));
+
+  AddTimerDeadline(RecordAndRepeatDeadline, &id, 500);
+  System_AdvanceTimeMilliSec(5);
+
+  TEST_ASSERT_EQUAL(3, numRecordedDeadlines);
+  TEST_ASSERT_EQUAL(500, recordedDeadlineTimes[0]);
+  TEST_ASSERT_EQUAL(1000, recordedDeadlineTimes[1]);
+  TEST_ASSERT_EQUAL(1500, recordedDeadlineTimes[2]);
+  TEST_ASSERT_EQUAL(0, GetNumTimerDeadlines());
+}
+
+static void testGroupStartAligned(
+    TimerGroup* group
+    )
+{
+  SetTimerCycleTimeMilliSec(timers[0], 1);
+  SetTimerCycleTimeMilliSec(timers[1], 2);
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE8, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE8, GetTimerClockSource(timers[1]));
+
+  InitTimerGroup(group);
+  TEST_ASSERT(AddTimerToGroup(group, timers[0]));
+  TEST_ASSERT(AddTimerToGroup(group, timers[1]));
+
+  // Leave the counters and prescalers partway through a tick
+  System_AdvanceTime(1003);
+
+  TEST_ASSERT(StartTimerGroup(group));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_RUNNING, GetTimerStatus(timers[0]));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_RUNNING, GetTimerStatus(timers[1]));
+  TEST_ASSERT_EQUAL(0, System_TimerGetCount(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(0, System_TimerGetCount(SYSTEM_TIMER1));
+
+  // Both cycles end on the same core clock cycle
+  System_AdvanceTime(1999);
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetNumTimerCycles(timers[1]));
+  TEST_ASSERT_EQUAL(124, System_TimerGetCount(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(249, System_TimerGetCount(SYSTEM_TIMER1));
+
+  System_AdvanceTime(1);
+  TEST_ASSERT_EQUAL(2, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[1]));
+}
+
+TEST(TimerDriver, GroupMembership)
+{
+  testCreateAllTimers();
+
+  TimerGroup group;
+  InitTimerGroup(&group);
+  TEST_ASSERT_FALSE(AddTimerToGroup(NULL, timers[0]));
+  TEST_ASSERT_FALSE(AddTimerToGroup(&group, NULL));
+  TEST_ASSERT_FALSE(StartTimerGroup(&group));
+
+  // Virtual timers share the virtual timer base, so cannot be grouped
+  TEST_ASSERT_FALSE(AddTimerToGroup(&group, timers[2]));
+
+  TEST_ASSERT(AddTimerToGroup(&group, timers[0]));
+  TEST_ASSERT_FALSE(AddTimerToGroup(&group, timers[0]));
+  TEST_ASSERT(AddTimerToGroup(&group, timers[1]));
+  TEST_ASSERT_EQUAL(2, group.numTimers);
+
+  // No timer starts unless all of them can
+  SetTimerCycleTimeMilliSec(timers[0], 1);
+  TEST_ASSERT_FALSE(StartTimerGroup(&group));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_STOPPED, GetTimerStatus(timers[0]));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_STOPPED, GetTimerStatus(timers[1]));
+
+  InitTimerGroup(&group);
+  TEST_ASSERT_EQUAL(0, group.numTimers);
+}
+
+TEST(TimerDriver, GroupStartInPhase)
+{
+  testCreateAllTimers();
+
+  TimerGroup group;
+  testGroupStartAligned(&group);
+}
+
+TEST(TimerDriver, GroupStartWithoutPrescalerHold)
+{
+  System_SetPrescalerHoldSupported(FALSE);
+  testCreateAllTimers();
+
+  TimerGroup group;
+  testGroupStartAligned(&group);
+}
+
+TEST(TimerDriver, GroupStopAndReset)
+{
+  testCreateAllTimers();
+
+  TimerGroup group;
+  testGroupStartAligned(&group);
+
+  // Resetting cuts the current cycles short and starts both over together
+  System_AdvanceTime(700);
+  ResetTimerGroup(&group);
+  TEST_ASSERT_EQUAL(0, System_TimerGetCount(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(0, System_TimerGetCount(SYSTEM_TIMER1));
+  TEST_ASSERT_EQUAL(0, GetNumTimerCompareMatches(timers[1]));
+
+  System_AdvanceTime(2000);
+  TEST_ASSERT_EQUAL(4, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(2, GetNumTimerCycles(timers[1]));
+
+  System_AdvanceTime(500);
+  StopTimerGroup(&group);
+  TEST_ASSERT_EQUAL(TIMER_STATUS_STOPPED, GetTimerStatus(timers[0]));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_STOPPED, GetTimerStatus(timers[1]));
+
+  System_AdvanceTime(5000);
+  TEST_ASSERT_EQUAL(62, System_TimerGetCount(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(62, System_TimerGetCount(SYSTEM_TIMER1));
+  TEST_ASSERT_EQUAL(4, GetNumTimerCycles(timers[0]));
+
+  // Stopped timers are left alone by a reset
+  ResetTimerGroup(&group);
+  TEST_ASSERT_EQUAL(TIMER_STATUS_STOPPED, GetTimerStatus(timers[0]));
+  TEST_ASSERT_EQUAL(62, System_TimerGetCount(SYSTEM_TIMER0));
+}
+
+TEST(TimerDriver, CycleTimeChangeWhileRunning)
+{
+  testCreateAllTimers();
+
+  // A stopped timer takes the cycle time straight away
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 1));
+  TEST_ASSERT_FALSE(IsTimerCycleUpdatePending(timers[0]));
+  TEST_ASSERT_EQUAL(125, GetTimerCompareMatch(timers[0]));
+
+  TEST_ASSERT(StartTimer(timers[0]));
+  System_AdvanceTime(400);
+
+  // A running timer finishes its current cycle first
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 2));
+  TEST_ASSERT(IsTimerCycleUpdatePending(timers[0]));
+  TEST_ASSERT_EQUAL(2000, GetTimerCycleTicks(timers[0]));
+  TEST_ASSERT_EQUAL(125, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(125, System_TimerGetCompareValue(SYSTEM_TIMER0));
+
+  System_AdvanceTime(599);
+  TEST_ASSERT_EQUAL(0, GetNumTimerCycles(timers[0]));
+
+  System_AdvanceTime(1);
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_FALSE(IsTimerCycleUpdatePending(timers[0]));
+  TEST_ASSERT_EQUAL(250, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(250, System_TimerGetCompareValue(SYSTEM_TIMER0));
+
+  System_AdvanceTime(1999);
+  TEST_ASSERT_EQUAL(1, GetNumTimerCycles(timers[0]));
+  System_AdvanceTime(1);
+  TEST_ASSERT_EQUAL(2, GetNumTimerCycles(timers[0]));
+
+  // Switching clock source also waits for the cycle to end
+  System_AdvanceTime(1000);
+  TEST_ASSERT(SetTimerCycleTimeMicroSec(timers[0], 100));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE8, System_TimerGetClockSource(SYSTEM_TIMER0));
+
+  System_AdvanceTime(1000);
+  TEST_ASSERT_EQUAL(3, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT, System_TimerGetClockSource(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(100, GetTimerCompareMatch(timers[0]));
+
+  System_AdvanceTime(100);
+  TEST_ASSERT_EQUAL(4, GetNumTimerCycles(timers[0]));
+
+  // Stopping keeps a cycle time still waiting for the next start
+  System_AdvanceTime(50);
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 1));
+  StopTimer(timers[0]);
+  TEST_ASSERT_FALSE(IsTimerCycleUpdatePending(timers[0]));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE8, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(125, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_OFF, System_TimerGetClockSource(SYSTEM_TIMER0));
+}
+
+TEST(TimerDriver, CycleTimeSweep)
+{
+  testCreateAllTimers();
+
+  TEST_ASSERT(SetTimerCycleTimeMicroSec(timers[0], 200));
+  TEST_ASSERT(SetTimerHandlerMode(timers[0], TIMER_HANDLER_IMMEDIATE));
+  SetTimerCycleHandlerEx(timers[0], SweepCycleTime, NULL);
+  TEST_ASSERT(StartTimer(timers[0]));
+
+  // Each new cycle time set from the cycle handler runs from the cycle
+  // starting straight after, moving from the fastest clock source to a slower
+  // one along the way
+  System_AdvanceTime(3000);
+  TEST_ASSERT_EQUAL(TEST_NUM_SWEEP_CYCLES, numSweepCycles);
+  TEST_ASSERT_EQUAL(200, sweepCycleTimes[0]);
+  TEST_ASSERT_EQUAL(600, sweepCycleTimes[1]);
+  TEST_ASSERT_EQUAL(1400, sweepCycleTimes[2]);
+  TEST_ASSERT_EQUAL(3000, sweepCycleTimes[3]);
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_CLKSOURCE_INT_PRE64, GetTimerClockSource(timers[0]));
+  TEST_ASSERT_EQUAL(50, GetTimerCompareMatch(timers[0]));
+  TEST_ASSERT_EQUAL(0, GetTimerNumMissedCycles(timers[0]));
+}
+
+TEST(TimerDriver, PwmFrequencyChangeWhileRunning)
+{
+  testCreateAllTimers();
+
+  TEST_ASSERT(SetTimerPwmMode(timers[0], TIMER_PWM_FAST));
+  TEST_ASSERT(SetTimerPwmFrequency(timers[0], 10000));
+  TEST_ASSERT(SetTimerPwmDutyCycle(timers[0], 2500));
+  TEST_ASSERT(StartTimer(timers[0]));
+  System_AdvanceTime(30);
+
+  // The period and duty cycle both change as the current period ends
+  TEST_ASSERT(SetTimerPwmFrequency(timers[0], 5000));
+  TEST_ASSERT_EQUAL(100, System_TimerGetCompareValue(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(25, System_TimerGetPwmCompareValue(SYSTEM_TIMER0));
+
+  System_AdvanceTime(70);
+  TEST_ASSERT_EQUAL(200, System_TimerGetCompareValue(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(50, System_TimerGetPwmCompareValue(SYSTEM_TIMER0));
+  TEST_ASSERT_FALSE(System_GetEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+}
+
+TEST(TimerDriver, ChannelCompareMatch)
+{
+  testCreateAllTimers();
+
+  // Channels match within each compare match period, so need one set first
+  TEST_ASSERT_FALSE(SetTimerChannelCompareMatch(timers[0], SYSTEM_TIMER_OUTPUT_B, 50));
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 1));
+
+  TEST_ASSERT_FALSE(SetTimerChannelCompareMatch(timers[0], SYSTEM_TIMER_OUTPUT_A, 50));
+  TEST_ASSERT_FALSE(SetTimerChannelCompareMatch(timers[0], SYSTEM_NUM_TIMER_OUTPUTS, 50));
+  TEST_ASSERT_FALSE(SetTimerChannelCompareMatch(timers[0], SYSTEM_TIMER_OUTPUT_B, 125));
+  TEST_ASSERT(SetTimerChannelCompareMatch(timers[0], SYSTEM_TIMER_OUTPUT_B, 50));
+  TEST_ASSERT(SetTimerChannelCompareMatch(timers[0], SYSTEM_TIMER_OUTPUT_C, 100));
+  TEST_ASSERT_EQUAL(50, GetTimerChannelCompareMatch(timers[0], SYSTEM_TIMER_OUTPUT_B));
+  TEST_ASSERT_EQUAL(100, GetTimerChannelCompareMatch(timers[0], SYSTEM_TIMER_OUTPUT_C));
+  TEST_ASSERT_EQUAL(50, System_TimerGetChannelCompareValue(SYSTEM_TIMER0, SYSTEM_TIMER_OUTPUT_B));
+  TEST_ASSERT_EQUAL(100, System_TimerGetChannelCompareValue(SYSTEM_TIMER0, SYSTEM_TIMER_OUTPUT_C));
+
+  // Each output has its own mode
+  TEST_ASSERT(SetTimerCompareOutputMode(timers[0], SYSTEM_TIMER_OUTPUT_B, SYSTEM_TIMER_OUTPUT_MODE_TOGGLE));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_OUTPUT_MODE_TOGGLE, GetTimerCompareOutputMode(timers[0], SYSTEM_TIMER_OUTPUT_B));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_OUTPUT_MODE_NONE, GetTimerCompareOutputMode(timers[0], SYSTEM_TIMER_OUTPUT_A));
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_OUTPUT_MODE_TOGGLE, System_TimerGetCompareOutputMode(SYSTEM_TIMER0, SYSTEM_TIMER_OUTPUT_B));
+
+  // PWM modes take over the other channels
+  TEST_ASSERT_FALSE(SetTimerPwmMode(timers[0], TIMER_PWM_FAST));
+  TEST_ASSERT(SetTimerChannelCompareMatch(timers[0], SYSTEM_TIMER_OUTPUT_B, 0));
+  TEST_ASSERT(SetTimerChannelCompareMatch(timers[0], SYSTEM_TIMER_OUTPUT_C, 0));
+  TEST_ASSERT(SetTimerPwmMode(timers[0], TIMER_PWM_FAST));
+  TEST_ASSERT_FALSE(SetTimerChannelCompareMatch(timers[0], SYSTEM_TIMER_OUTPUT_B, 50));
+  TEST_ASSERT_FALSE(SetTimerCompareOutputMode(timers[0], SYSTEM_TIMER_OUTPUT_B, SYSTEM_TIMER_OUTPUT_MODE_SET));
+
+  // Virtual timers have no channels
+  TimerInstance* extraTimer = CreateTimer();
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(extraTimer, 1));
+  TEST_ASSERT_FALSE(SetTimerChannelCompareMatch(extraTimer, SYSTEM_TIMER_OUTPUT_B, 1));
+  TEST_ASSERT_FALSE(SetTimerChannelHandler(extraTimer, SYSTEM_TIMER_OUTPUT_B, RecordChannelMatch, NULL));
+  DestroyTimer(&extraTimer);
+}
+
+TEST(TimerDriver, ChannelHandlers)
+{
+  testCreateAllTimers();
+
+  unsigned int lastOutput = 0;
+
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 1));
+  TEST_ASSERT(SetTimerChannelCompareMatch(timers[0], SYSTEM_TIMER_OUTPUT_B, 50));
+  TEST_ASSERT(SetTimerChannelHandler(timers[0], SYSTEM_TIMER_OUTPUT_B, RecordChannelMatch, &lastOutput));
+  TEST_ASSERT_EQUAL_PTR(RecordChannelMatch, GetTimerChannelHandler(timers[0], SYSTEM_TIMER_OUTPUT_B));
+  TEST_ASSERT_EQUAL_PTR(&lastOutput, GetTimerChannelHandlerContext(timers[0], SYSTEM_TIMER_OUTPUT_B));
+  TEST_ASSERT_FALSE(System_GetEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH_B));
+
+  // The channel matches 400us into each cycle, off the same counter
+  TEST_ASSERT(StartTimer(timers[0]));
+  TEST_ASSERT(System_GetEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH_B));
+  System_AdvanceTime(2500);
+  TEST_ASSERT_EQUAL(2, GetNumTimerCycles(timers[0]));
+  TEST_ASSERT_EQUAL(3, numChannelMatches);
+  TEST_ASSERT_EQUAL(400, channelMatchTimes[0]);
+  TEST_ASSERT_EQUAL(1400, channelMatchTimes[1]);
+  TEST_ASSERT_EQUAL(2400, channelMatchTimes[2]);
+  TEST_ASSERT_EQUAL(SYSTEM_TIMER_OUTPUT_B, lastOutput);
+
+  // Channel handlers follow the timer's handler mode
+  TEST_ASSERT_FALSE(GetTimerEventImmediate(SYSTEM_EVENT_TIMER0_COMPAREMATCH_B));
+  TEST_ASSERT(SetTimerHandlerMode(timers[0], TIMER_HANDLER_IMMEDIATE));
+  TEST_ASSERT(GetTimerEventImmediate(SYSTEM_EVENT_TIMER0_COMPAREMATCH_B));
+
+  StopTimer(timers[0]);
+  TEST_ASSERT_FALSE(System_GetEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH_B));
+  System_AdvanceTime(2000);
+  TEST_ASSERT_EQUAL(3, numChannelMatches);
+
+  // Removing the handler stops the channel's interrupts
+  TEST_ASSERT(StartTimer(timers[0]));
+  TEST_ASSERT(SetTimerChannelHandler(timers[0], SYSTEM_TIMER_OUTPUT_B, NULL, NULL));
+  TEST_ASSERT_FALSE(System_GetEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH_B));
+  System_AdvanceTime(2000);
+  TEST_ASSERT_EQUAL(3, numChannelMatches);
+}
+
+TEST(TimerDriver, SequenceStart)
+{
+  static const unsigned int steps [] SYSTEM_TABLE_MEMORY = { 100, 50, 200 };
+  static const unsigned int badSteps [] SYSTEM_TABLE_MEMORY = { 100, 0, 257 };
+  TimerSequence sequence;
+
+  testCreateAllTimers();
+
+  InitTimerSequence(&sequence, steps, 0, SYSTEM_TIMER_CLKSOURCE_INT_PRE8, FALSE, RecordSequenceEnd, NULL);
+  TEST_ASSERT_FALSE(StartTimerSequence(timers[0], &sequence));
+  InitTimerSequence(&sequence, steps, 3, SYSTEM_TIMER_CLKSOURCE_OFF, FALSE, RecordSequenceEnd, NULL);
+  TEST_ASSERT_FALSE(StartTimerSequence(timers[0], &sequence));
+
+  // Every step must fit in the counter
+  InitTimerSequence(&sequence, badSteps, 1, SYSTEM_TIMER_CLKSOURCE_INT_PRE8, FALSE, RecordSequenceEnd, NULL);
+  TEST_ASSERT(StartTimerSequence(timers[0], &sequence));
+  StopTimer(timers[0]);
+  InitTimerSequence(&sequence, badSteps, 2, SYSTEM_TIMER_CLKSOURCE_INT_PRE8, FALSE, RecordSequenceEnd, NULL);
+  TEST_ASSERT_FALSE(StartTimerSequence(timers[0], &sequence));
+  TEST_ASSERT_NULL(GetTimerSequence(timers[0]));
+
+  // Virtual timers and PWM timers have no compare match of their own to step
+  InitTimerSequence(&sequence, steps, 3, SYSTEM_TIMER_CLKSOURCE_INT_PRE8, FALSE, RecordSequenceEnd, NULL);
+  TimerInstance* extraTimer = CreateTimer();
+  TEST_ASSERT_FALSE(StartTimerSequence(extraTimer, &sequence));
+  DestroyTimer(&extraTimer);
+
+  TEST_ASSERT(SetTimerPwmMode(timers[1], TIMER_PWM_FAST));
+  TEST_ASSERT_FALSE(StartTimerSequence(timers[1], &sequence));
+
+  TEST_ASSERT(StartTimerSequence(timers[0], &sequence));
+  TEST_ASSERT_EQUAL_PTR(&sequence, GetTimerSequence(timers[0]));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_RUNNING, GetTimerStatus(timers[0]));
+  TEST_ASSERT(GetTimerEventImmediate(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+
+  // The timer must leave the sequence before running its own cycle time
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 1));
+  TEST_ASSERT_FALSE(StartTimer(timers[0]));
+}
+
+TEST(TimerDriver, SequenceSteps)
+{
+  static const unsigned int steps [] SYSTEM_TABLE_MEMORY = { 100, 50, 200 };
+  TimerSequence sequence;
+
+  testCreateAllTimers();
+
+  InitTimerSequence(&sequence, steps, 3, SYSTEM_TIMER_CLKSOURCE_INT_PRE8, FALSE, RecordSequenceEnd, NULL);
+  TEST_ASSERT(StartTimerSequence(timers[0], &sequence));
+
+  // Steps of 800us, 400us and 1600us
+  System_AdvanceTime(799);
+  TEST_ASSERT_EQUAL(0, sequence.step);
+  System_AdvanceTime(1);
+  TEST_ASSERT_EQUAL(1, sequence.step);
+  TEST_ASSERT_EQUAL(50, System_TimerGetCompareValue(SYSTEM_TIMER0));
+
+  System_AdvanceTime(400);
+  TEST_ASSERT_EQUAL(2, sequence.step);
+  TEST_ASSERT_EQUAL(200, System_TimerGetCompareValue(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(0, numSequenceEnds);
+
+  // The last step ends the sequence and stops the timer
+  System_AdvanceTime(1600);
+  TEST_ASSERT_EQUAL(1, numSequenceEnds);
+  TEST_ASSERT_EQUAL(2800, lastSequenceEndTime);
+  TEST_ASSERT_EQUAL_PTR(timers[0], lastContextTimer);
+  TEST_ASSERT_EQUAL(1, sequence.numPasses);
+  TEST_ASSERT_EQUAL(TIMER_STATUS_STOPPED, GetTimerStatus(timers[0]));
+  TEST_ASSERT_NULL(GetTimerSequence(timers[0]));
+  TEST_ASSERT_EQUAL(3, System_GetNumTimerCompareMatches(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(0, GetNumTimerCycles(timers[0]));
+
+  System_AdvanceTime(5000);
+  TEST_ASSERT_EQUAL(1, numSequenceEnds);
+  TEST_ASSERT_EQUAL(3, System_GetNumTimerCompareMatches(SYSTEM_TIMER0));
+}
+
+TEST(TimerDriver, SequenceLooping)
+{
+  static const unsigned int steps [] SYSTEM_TABLE_MEMORY = { 10, 20 };
+  TimerSequence sequence;
+
+  testCreateAllTimers();
+
+  TEST_ASSERT(SetTimerCycleTimeMilliSec(timers[0], 1));
+  SetTimerCycleHandler(timers[0], CustomTimerCycleCounter);
+
+  InitTimerSequence(&sequence, steps, 2, SYSTEM_TIMER_CLKSOURCE_INT, TRUE, RecordSequenceEnd, NULL);
+  TEST_ASSERT(StartTimerSequence(timers[0], &sequence));
+
+  // Passes end at 30us, 60us and 90us
+  System_AdvanceTime(95);
+  TEST_ASSERT_EQUAL(6, System_GetNumTimerCompareMatches(SYSTEM_TIMER0));
+  TEST_ASSERT_EQUAL(3, numSequenceEnds);
+  TEST_ASSERT_EQUAL(90, lastSequenceEndTime);
+  TEST_ASSERT_EQUAL(3, sequence.numPasses);
+  TEST_ASSERT_EQUAL(0, sequence.step);
+  TEST_ASSERT_EQUAL(TIMER_STATUS_RUNNING, GetTimerStatus(timers[0]));
+  TEST_ASSERT_EQUAL(0, numCustomTimerCycles);
+
+  // Stopping gives the timer back its own cycle time
+  StopTimer(timers[0]);
+  TEST_ASSERT_NULL(GetTimerSequence(timers[0]));
+  TEST_ASSERT_FALSE(GetTimerEventImmediate(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  TEST_ASSERT_EQUAL(125, System_TimerGetCompareValue(SYSTEM_TIMER0));
+
+  TEST_ASSERT(StartTimer(timers[0]));
+  System_AdvanceTime(999);
+  TEST_ASSERT_EQUAL(0, numCustomTimerCycles);
+  System_AdvanceTime(1);
+  TEST_ASSERT_EQUAL(1, numCustomTimerCycles);
+  TEST_ASSERT_EQUAL(3, numSequenceEnds);
 }
@@ -0,0 +1,246 @@
+#include <stdlib.h>
+
+#include "unity_fixture.h"
+#include "TimerEvents.h"
+#include "TargetSystem.h"
+
+TEST_GROUP(TimerEvents);
+
+#define TEST_MAX_RECORDED_EVENTS 16
+
+static System_EventType recordedEvents [TEST_MAX_RECORDED_EVENTS];
+static unsigned int numRecordedEvents = 0;
+
+static void
+RecordEvent(
+    System_EventType  event
+    )
+{
+  if (numRecordedEvents < TEST_MAX_RECORDED_EVENTS)
+  {
+    recordedEvents[numRecordedEvents] = event;
+  }
+
+  numRecordedEvents++;
+}
+
+static void
+RecordAndRepostEvent(
+    System_EventType  event
+    )
+{
+  RecordEvent(event);
+  PostTimerEvent(event);
+}
+
+TEST_SETUP(TimerEvents)
+{
+  InitTimerEvents();
+  numRecordedEvents = 0;
+
+  System_RegisterCallback(RecordEvent, SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  System_RegisterCallback(RecordEvent, SYSTEM_EVENT_TIMER1_COMPAREMATCH);
+}
+
+TEST_TEAR_DOWN(TimerEvents)
+{
+  System_RegisterCallback(NULL, SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  System_RegisterCallback(NULL, SYSTEM_EVENT_TIMER1_COMPAREMATCH);
+  System_RegisterCallback(NULL, SYSTEM_EVENT_TIMER2_COMPAREMATCH);
+  SetTimerEventImmediate(SYSTEM_EVENT_TIMER0_COMPAREMATCH, FALSE);
+}
+
+TEST(TimerEvents, EmptyOnInit)
+{
+  TEST_ASSERT_EQUAL(0, GetNumQueuedTimerEvents());
+  TEST_ASSERT_EQUAL(0, GetMaxQueuedTimerEvents());
+  TEST_ASSERT_EQUAL(0, GetNumLostTimerEvents());
+  TEST_ASSERT_EQUAL(0, DispatchTimerEvents());
+  TEST_ASSERT_EQUAL(0, numRecordedEvents);
+}
+
+TEST(TimerEvents, DispatchInOrder)
+{
+  TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER1_COMPAREMATCH));
+  TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER1_COMPAREMATCH));
+  TEST_ASSERT_EQUAL(3, GetNumQueuedTimerEvents());
+
+  TEST_ASSERT_EQUAL(3, DispatchTimerEvents());
+  TEST_ASSERT_EQUAL(0, GetNumQueuedTimerEvents());
+  TEST_ASSERT_EQUAL(3, numRecordedEvents);
+  TEST_ASSERT_EQUAL(SYSTEM_EVENT_TIMER1_COMPAREMATCH, recordedEvents[0]);
+  TEST_ASSERT_EQUAL(SYSTEM_EVENT_TIMER0_COMPAREMATCH, recordedEvents[1]);
+  TEST_ASSERT_EQUAL(SYSTEM_EVENT_TIMER1_COMPAREMATCH, recordedEvents[2]);
+}
+
+TEST(TimerEvents, RepeatedEventsKept)
+{
+  TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+
+  TEST_ASSERT_EQUAL(3, DispatchTimerEvents());
+  TEST_ASSERT_EQUAL(3, numRecordedEvents);
+  TEST_ASSERT_EQUAL(3, GetMaxQueuedTimerEvents());
+}
+
+TEST(TimerEvents, FullQueueLosesEvents)
+{
+  unsigned int eventIdx;
+  for(
+      eventIdx = 0;
+      eventIdx < TIMER_EVENT_QUEUE_SIZE;
+      eventIdx++
+     )
+  {
+    TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  }
+
+  TEST_ASSERT_FALSE(PostTimerEvent(SYSTEM_EVENT_TIMER1_COMPAREMATCH));
+  TEST_ASSERT_FALSE(PostTimerEvent(SYSTEM_EVENT_TIMER1_COMPAREMATCH));
+  TEST_ASSERT_EQUAL(2, GetNumLostTimerEvents());
+  TEST_ASSERT_EQUAL(TIMER_EVENT_QUEUE_SIZE, GetNumQueuedTimerEvents());
+  TEST_ASSERT_EQUAL(TIMER_EVENT_QUEUE_SIZE, GetMaxQueuedTimerEvents());
+
+  TEST_ASSERT_EQUAL(TIMER_EVENT_QUEUE_SIZE, DispatchTimerEvents());
+  TEST_ASSERT_EQUAL(SYSTEM_EVENT_TIMER0_COMPAREMATCH, recordedEvents[TIMER_EVENT_QUEUE_SIZE - 1]);
+
+  // Room again once dispatched
+  TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER1_COMPAREMATCH));
+  TEST_ASSERT_EQUAL(2, GetNumLostTimerEvents());
+}
+
+TEST(TimerEvents, IndexWrapAround)
+{
+  unsigned int eventIdx;
+  for(
+      eventIdx = 0;
+      eventIdx < 300;
+      eventIdx++
+     )
+  {
+    TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+    TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER1_COMPAREMATCH));
+    TEST_ASSERT_EQUAL(2, GetNumQueuedTimerEvents());
+    TEST_ASSERT_EQUAL(2, DispatchTimerEvents());
+  }
+
+  TEST_ASSERT_EQUAL(600, numRecordedEvents);
+  TEST_ASSERT_EQUAL(0, GetNumLostTimerEvents());
+  TEST_ASSERT_EQUAL(2, GetMaxQueuedTimerEvents());
+}
+
+TEST(TimerEvents, PostedWhileDispatching)
+{
+  System_RegisterCallback(RecordAndRepostEvent, SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+
+  TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  TEST_ASSERT_EQUAL(1, DispatchTimerEvents());
+  TEST_ASSERT_EQUAL(1, GetNumQueuedTimerEvents());
+  TEST_ASSERT_EQUAL(1, DispatchTimerEvents());
+  TEST_ASSERT_EQUAL(2, numRecordedEvents);
+}
+
+TEST(TimerEvents, UnregisteredEvent)
+{
+  TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER2_COMPAREMATCH));
+  TEST_ASSERT_EQUAL(1, DispatchTimerEvents());
+  TEST_ASSERT_EQUAL(0, numRecordedEvents);
+  TEST_ASSERT_EQUAL(0, GetNumQueuedTimerEvents());
+}
+
+TEST(TimerEvents, NothingToProcess)
+{
+  TEST_ASSERT_EQUAL(0, ProcessTimerEvents());
+  TEST_ASSERT_EQUAL(0, numRecordedEvents);
+}
+
+TEST(TimerEvents, PendingEventsCoalesce)
+{
+  SetTimerEventPending(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  SetTimerEventPending(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+
+  TEST_ASSERT_EQUAL(1, ProcessTimerEvents());
+  TEST_ASSERT_EQUAL(1, numRecordedEvents);
+  TEST_ASSERT(System_GetInterruptsEnabled());
+
+  TEST_ASSERT_EQUAL(0, ProcessTimerEvents());
+}
+
+TEST(TimerEvents, PendingEventsInOrder)
+{
+  System_RegisterCallback(RecordEvent, SYSTEM_EVENT_TIMER2_COMPAREMATCH);
+
+  SetTimerEventPending(SYSTEM_EVENT_TIMER2_COMPAREMATCH);
+  SetTimerEventPending(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  SetTimerEventPending(SYSTEM_EVENT_INVALID);
+
+  TEST_ASSERT_EQUAL(2, ProcessTimerEvents());
+  TEST_ASSERT_EQUAL(2, numRecordedEvents);
+  TEST_ASSERT_EQUAL(SYSTEM_EVENT_TIMER0_COMPAREMATCH, recordedEvents[0]);
+  TEST_ASSERT_EQUAL(SYSTEM_EVENT_TIMER2_COMPAREMATCH, recordedEvents[1]);
+}
+
+TEST(TimerEvents, ProcessPendingAndQueued)
+{
+  TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  SetTimerEventPending(SYSTEM_EVENT_TIMER1_COMPAREMATCH);
+
+  TEST_ASSERT_EQUAL(3, ProcessTimerEvents());
+  TEST_ASSERT_EQUAL(SYSTEM_EVENT_TIMER1_COMPAREMATCH, recordedEvents[0]);
+  TEST_ASSERT_EQUAL(SYSTEM_EVENT_TIMER0_COMPAREMATCH, recordedEvents[1]);
+  TEST_ASSERT_EQUAL(SYSTEM_EVENT_TIMER0_COMPAREMATCH, recordedEvents[2]);
+  TEST_ASSERT_EQUAL(0, GetNumQueuedTimerEvents());
+}
+
+TEST(TimerEvents, ImmediateEvent)
+{
+  TEST_ASSERT_FALSE(GetTimerEventImmediate(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  SetTimerEventImmediate(SYSTEM_EVENT_TIMER0_COMPAREMATCH, TRUE);
+  TEST_ASSERT(GetTimerEventImmediate(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  TEST_ASSERT_FALSE(GetTimerEventImmediate(SYSTEM_EVENT_TIMER1_COMPAREMATCH));
+  TEST_ASSERT_FALSE(GetTimerEventImmediate(SYSTEM_EVENT_INVALID));
+
+  TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  TEST_ASSERT_EQUAL(1, numRecordedEvents);
+  TEST_ASSERT_EQUAL(0, GetNumQueuedTimerEvents());
+
+  SetTimerEventPending(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  TEST_ASSERT_EQUAL(2, numRecordedEvents);
+
+  // Other events are still deferred
+  TEST_ASSERT(PostTimerEvent(SYSTEM_EVENT_TIMER1_COMPAREMATCH));
+  TEST_ASSERT_EQUAL(2, numRecordedEvents);
+  TEST_ASSERT_EQUAL(1, ProcessTimerEvents());
+  TEST_ASSERT_EQUAL(3, numRecordedEvents);
+}
+
+TEST(TimerEvents, MissedEventsCounted)
+{
+  TEST_ASSERT_EQUAL(0, TakeNumMissedTimerEvents(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+
+  // Flagged again while pending
+  SetTimerEventPending(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  SetTimerEventPending(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  SetTimerEventPending(SYSTEM_EVENT_TIMER0_COMPAREMATCH);
+  TEST_ASSERT_EQUAL(1, ProcessTimerEvents());
+
+  // Dropped from a full queue
+  unsigned int eventIdx;
+  for(
+      eventIdx = 0;
+      eventIdx < TIMER_EVENT_QUEUE_SIZE;
+      eventIdx++
+     )
+  {
+    PostTimerEvent(SYSTEM_EVENT_TIMER1_COMPAREMATCH);
+  }
+  TEST_ASSERT_FALSE(PostTimerEvent(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+
+  TEST_ASSERT_EQUAL(3, TakeNumMissedTimerEvents(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  TEST_ASSERT_EQUAL(0, TakeNumMissedTimerEvents(SYSTEM_EVENT_TIMER0_COMPAREMATCH));
+  TEST_ASSERT_EQUAL(0, TakeNumMissedTimerEvents(SYSTEM_EVENT_TIMER1_COMPAREMATCH));
+  TEST_ASSERT_EQUAL(0, TakeNumMissedTimerEvents(SYSTEM_NUM_EVENTS));
+}
@@ -0,0 +1,272 @@
+#include <stdlib.h>
+
+#include "unity_fixture.h"
+#include "TimerScheduler.h"
+#include "TimerEvents.h"
+#include "TargetSystem.h"
+
+TEST_GROUP(TimerScheduler);
+
+#define TEST_MAX_RECORDED_RUNS 16
+
+static TimerInstance* tickTimer = NULL;
+
+static unsigned int recordedRuns [TEST_MAX_RECORDED_RUNS];
+static unsigned int numRecordedRuns = 0;
+
+static unsigned int removedTask = TIMER_TASK_INVALID;
+
+static void
+RecordRun(
+    void* context
+    )
+{
+  if (numRecordedRuns < TEST_MAX_RECORDED_RUNS)
+  {
+    recordedRuns[numRecordedRuns] = *((unsigned int*)context);
+  }
+
+  numRecordedRuns++;
+}
+
+static void
+RemoveRemovedTask(
+    void* context
+    )
+{
+  RecordRun(context);
+  RemoveTimerTask(removedTask);
+}
+
+static void
+RunForContextTime(
+    void* context
+    )
+{
+  // Tasks run from the main loop, so interrupts are serviced meanwhile
+  System_AdvanceTime(*((unsigned int*)context));
+}
+
+/**
+ * Runs the scheduler for the given number of ticks, one at a time
+ */
+static void
+testRunTicks(
+    unsigned int  numTicks
+    )
+{
+  unsigned int tickIdx;
+  for(
+      tickIdx = 0;
+      tickIdx < numTicks;
+      tickIdx++
+     )
+  {
+    System_AdvanceTimeMilliSec(1);
+    ProcessTimerEvents();
+    RunTimerTasks();
+  }
+}
+
+TEST_SETUP(TimerScheduler)
+{
+  System_SetCoreClockFrequency(1000000);
+  System_SetMaxTimerValue(SYSTEM_TIMER0, 256);
+  System_SetMaxTimerValue(SYSTEM_TIMER1, 256);
+  System_ResetSimulation();
+
+  InitTimers();
+  InitTimerEvents();
+  InitTimerScheduler();
+
+  tickTimer = CreateTimer();
+  SetTimerCycleTimeMilliSec(tickTimer, 1);
+
+  numRecordedRuns = 0;
+  removedTask = TIMER_TASK_INVALID;
+}
+
+TEST_TEAR_DOWN(TimerScheduler)
+{
+  InitTimerScheduler();
+  DestroyAllTimers();
+}
+
+TEST(TimerScheduler, StartStop)
+{
+  TEST_ASSERT_FALSE(StartTimerScheduler(NULL));
+  TEST_ASSERT_EQUAL(0, GetTimerSchedulerTicks());
+
+  TEST_ASSERT(StartTimerScheduler(tickTimer));
+  TEST_ASSERT_EQUAL(TIMER_STATUS_RUNNING, GetTimerStatus(tickTimer));
+  TEST_ASSERT_EQUAL(TIMER_HANDLER_DEFERRED, GetTimerHandlerMode(tickTimer));
+  TEST_ASSERT_EQUAL(TIMER_CATCHUP_REPLAY, GetTimerCatchUpPolicy(tickTimer));
+
+  testRunTicks(10);
+  TEST_ASSERT_EQUAL(10, GetTimerSchedulerTicks());
+
+  // Ticks missed by the main loop are still counted
+  System_AdvanceTimeMilliSec(3);
+  ProcessTimerEvents();
+  TEST_ASSERT_EQUAL(13, GetTimerSchedulerTicks());
+
+  StopTimerScheduler();
+  TEST_ASSERT_EQUAL(TIMER_STATUS_STOPPED, GetTimerStatus(tickTimer));
+  testRunTicks(10);
+  TEST_ASSERT_EQUAL(13, GetTimerSchedulerTicks());
+}
+
+TEST(TimerScheduler, PeriodAndPhase)
+{
+  static unsigned int ids [] = { 0, 1 };
+  TimerTaskStats stats;
+
+  unsigned int fastTask = AddTimerTask(RecordRun, &ids[0], 4, 0, 0);
+  unsigned int slowTask = AddTimerTask(RecordRun, &ids[1], 6, 3, 0);
+  TEST_ASSERT(fastTask != TIMER_TASK_INVALID);
+  TEST_ASSERT(slowTask != TIMER_TASK_INVALID);
+  TEST_ASSERT(StartTimerScheduler(tickTimer));
+
+  // Only the task with no phase offset is due straight away
+  TEST_ASSERT_EQUAL(1, RunTimerTasks());
+  TEST_ASSERT_EQUAL(0, RunTimerTasks());
+
+  // Ticks 0 to 12: fast on 0, 4, 8, 12 and slow on 3, 9
+  testRunTicks(12);
+  TEST_ASSERT_EQUAL(6, numRecordedRuns);
+  TEST_ASSERT_EQUAL(1, recordedRuns[1]);
+  TEST_ASSERT_EQUAL(1, recordedRuns[4]);
+
+  TEST_ASSERT(GetTimerTaskStats(fastTask, &stats));
+  TEST_ASSERT_EQUAL(4, stats.numRuns);
+  TEST_ASSERT_EQUAL(0, stats.numSkipped);
+  TEST_ASSERT(GetTimerTaskStats(slowTask, &stats));
+  TEST_ASSERT_EQUAL(2, stats.numRuns);
+}
+
+TEST(TimerScheduler, PriorityOrder)
+{
+  static unsigned int ids [] = { 0, 1, 2, 3 };
+
+  AddTimerTask(RecordRun, &ids[0], 1, 0, 1);
+  AddTimerTask(RecordRun, &ids[1], 1, 0, 5);
+  AddTimerTask(RecordRun, &ids[2], 1, 0, 5);
+  AddTimerTask(RecordRun, &ids[3], 1, 0, 3);
+
+  TEST_ASSERT_EQUAL(4, RunTimerTasks());
+  TEST_ASSERT_EQUAL(1, recordedRuns[0]);
+  TEST_ASSERT_EQUAL(2, recordedRuns[1]);
+  TEST_ASSERT_EQUAL(3, recordedRuns[2]);
+  TEST_ASSERT_EQUAL(0, recordedRuns[3]);
+}
+
+TEST(TimerScheduler, SkipsMissedPeriods)
+{
+  static unsigned int id = 0;
+  TimerTaskStats stats;
+
+  unsigned int task = AddTimerTask(RecordRun, &id, 2, 0, 0);
+  TEST_ASSERT(StartTimerScheduler(tickTimer));
+
+  // Falling behind by ten ticks runs the task once for all of them
+  System_AdvanceTimeMilliSec(10);
+  ProcessTimerEvents();
+  TEST_ASSERT_EQUAL(1, RunTimerTasks());
+  TEST_ASSERT_EQUAL(0, RunTimerTasks());
+
+  TEST_ASSERT(GetTimerTaskStats(task, &stats));
+  TEST_ASSERT_EQUAL(1, stats.numRuns);
+  TEST_ASSERT_EQUAL(5, stats.numSkipped);
+
+  // Then carries on from its place in the period
+  testRunTicks(2);
+  TEST_ASSERT_EQUAL(2, numRecordedRuns);
+}
+
+TEST(TimerScheduler, AddAndRemove)
+{
+  static unsigned int ids [] = { 0, 1 };
+  TimerTaskStats stats;
+
+  TEST_ASSERT_EQUAL(TIMER_TASK_INVALID, AddTimerTask(NULL, NULL, 1, 0, 0));
+  TEST_ASSERT_EQUAL(TIMER_TASK_INVALID, AddTimerTask(RecordRun, &ids[0], 0, 0, 0));
+  TEST_ASSERT_FALSE(RemoveTimerTask(0));
+  TEST_ASSERT_FALSE(RemoveTimerTask(TIMER_TASK_INVALID));
+  TEST_ASSERT_FALSE(GetTimerTaskStats(0, &stats));
+
+  unsigned int taskIdx;
+  for(
+      taskIdx = 0;
+      taskIdx < TIMER_SCHEDULER_MAX_TASKS;
+      taskIdx++
+     )
+  {
+    TEST_ASSERT_EQUAL(taskIdx, AddTimerTask(RecordRun, &ids[0], 1, 1, 0));
+  }
+
+  TEST_ASSERT_EQUAL(TIMER_TASK_INVALID, AddTimerTask(RecordRun, &ids[0], 1, 0, 0));
+
+  // A freed slot is handed out again
+  TEST_ASSERT(RemoveTimerTask(2));
+  TEST_ASSERT_FALSE(RemoveTimerTask(2));
+  TEST_ASSERT_EQUAL(2, AddTimerTask(RecordRun, &ids[1], 1, 1, 0));
+
+  TEST_ASSERT(StartTimerScheduler(tickTimer));
+  testRunTicks(1);
+  TEST_ASSERT_EQUAL(TIMER_SCHEDULER_MAX_TASKS, numRecordedRuns);
+}
+
+TEST(TimerScheduler, RemoveWhileRunning)
+{
+  static unsigned int ids [] = { 0, 1, 2 };
+
+  AddTimerTask(RecordRun, &ids[0], 1, 0, 3);
+  unsigned int selfRemoving = AddTimerTask(RemoveRemovedTask, &ids[1], 1, 0, 2);
+  AddTimerTask(RecordRun, &ids[2], 1, 0, 1);
+  removedTask = selfRemoving;
+
+  // Removing the running task leaves the rest to run in order
+  TEST_ASSERT_EQUAL(3, RunTimerTasks());
+  TEST_ASSERT_EQUAL(0, recordedRuns[0]);
+  TEST_ASSERT_EQUAL(1, recordedRuns[1]);
+  TEST_ASSERT_EQUAL(2, recordedRuns[2]);
+
+  TEST_ASSERT(StartTimerScheduler(tickTimer));
+  testRunTicks(1);
+  TEST_ASSERT_EQUAL(5, numRecordedRuns);
+}
+
+TEST(TimerScheduler, RunTimes)
+{
+  static unsigned int runTicks = 300;
+  TimerTaskStats stats;
+
+  unsigned int task = AddTimerTask(RunForContextTime, &runTicks, 1, 0, 0);
+
+  // Without the monotonic clock there is nothing to measure with
+  TEST_ASSERT_EQUAL(1, RunTimerTasks());
+  TEST_ASSERT(GetTimerTaskStats(task, &stats));
+  TEST_ASSERT(stats.maxRunTicks == TIMER_TASK_UNMEASURED);
+  TEST_ASSERT_EQUAL(1, stats.numRuns);
+
+  TimerInstance* clockTimer = CreateTimer();
+  TEST_ASSERT(StartTimerClock(clockTimer));
+  TEST_ASSERT(StartTimerScheduler(tickTimer));
+
+  testRunTicks(1);
+  TEST_ASSERT(GetTimerTaskStats(task, &stats));
+  TEST_ASSERT_EQUAL(300, stats.maxRunTicks);
+
+  runTicks = 100;
+  testRunTicks(1);
+  TEST_ASSERT(GetTimerTaskStats(task, &stats));
+  TEST_ASSERT_EQUAL(300, stats.maxRunTicks);
+  TEST_ASSERT_EQUAL(3, stats.numRuns);
+
+  // Runs while the clock is stopped are not measured
+  StopTimer(clockTimer);
+  runTicks = 1000;
+  testRunTicks(1);
+  TEST_ASSERT(GetTimerTaskStats(task, &stats));
+  TEST_ASSERT_EQUAL(300, stats.maxRunTicks);
+}